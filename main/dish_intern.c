@@ -0,0 +1,355 @@
+#include "dish_intern.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "sdkconfig.h"
+#include "esp_heap_caps.h"
+#include "order_log.h"
+
+static const char *TAG = "DishIntern";
+#else
+// 主机构建：不依赖ESP-IDF堆和日志
+#define heap_caps_calloc(n, size, caps)  calloc(n, size)
+#define heap_caps_free(p)                free(p)
+#define DLOGE(tag, fmt, ...)             ((void)0)
+#define DLOGI(tag, fmt, ...)             ((void)0)
+#define CONFIG_ORDER_DISH_INTERN_MAX     1024
+#define CONFIG_ORDER_DISH_ARENA_KB       32
+#endif
+
+#define GRANULE         16
+#define CLASS_MAX       ((DISH_NAME_MAX + 1) / GRANULE)
+#define LINK_END        0xFFFF
+#define CHUNK_END       0xFFFFFFFFu
+
+// 哈希槽：高16位为哈希标签，低16位为条目序号+1，0表示空槽
+#define SLOT_EMPTY          0
+#define SLOT_MAKE(hash, i)  (((hash) & 0xFFFF0000u) | ((uint32_t)(i) + 1))
+#define SLOT_INDEX(slot)    (((slot) & 0xFFFFu) - 1)
+#define SLOT_TAG(slot)      ((slot) & 0xFFFF0000u)
+
+typedef struct {
+    uint32_t hash;
+    uint32_t refs;
+    uint32_t text_off;       // 文本在文本区中的偏移
+    uint16_t len;
+    uint16_t prev;           // 零引用链表（按归零先后）；空闲条目用next串成空闲链表
+    uint16_t next;
+    uint8_t cls;             // 文本块大小（GRANULE的倍数），0表示空闲条目
+} dish_entry_t;
+
+typedef struct {
+    dish_entry_t *entries;
+    uint32_t *table;
+    uint32_t mask;
+    uint8_t *arena;
+    uint32_t arena_size;
+    uint32_t bump;                       // 文本区中从未分配过的起点
+    uint32_t free_chunk[CLASS_MAX + 1];  // 各大小的空闲块链表（块首4字节存下一块偏移）
+    uint16_t free_entry;
+    uint16_t lru_head;                   // 最早归零的条目，优先淘汰
+    uint16_t lru_tail;
+    dish_intern_stats_t stats;
+} dish_intern_t;
+
+static dish_intern_t s_intern;
+static bool s_ready;
+
+// FNV-1a
+static uint32_t name_hash(const char *name, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool intern_init(void)
+{
+    uint32_t count = CONFIG_ORDER_DISH_INTERN_MAX;
+    uint32_t slots = 16;
+    while (slots < count * 2) {
+        slots <<= 1;
+    }
+
+    s_intern.entries = heap_caps_calloc(count, sizeof(dish_entry_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_intern.table = heap_caps_calloc(slots, sizeof(uint32_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    s_intern.arena_size = (uint32_t)CONFIG_ORDER_DISH_ARENA_KB * 1024;
+    s_intern.arena = heap_caps_calloc(1, s_intern.arena_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_intern.entries || !s_intern.table || !s_intern.arena) {
+        DLOGE(TAG, "分配菜品名驻留表失败");
+        heap_caps_free(s_intern.entries);
+        heap_caps_free(s_intern.table);
+        heap_caps_free(s_intern.arena);
+        memset(&s_intern, 0, sizeof(s_intern));
+        return false;
+    }
+
+    s_intern.mask = slots - 1;
+    for (uint32_t i = 0; i < count; i++) {
+        s_intern.entries[i].next = (i + 1 < count) ? i + 1 : LINK_END;
+    }
+    s_intern.free_entry = 0;
+    for (int c = 0; c <= CLASS_MAX; c++) {
+        s_intern.free_chunk[c] = CHUNK_END;
+    }
+    s_intern.lru_head = LINK_END;
+    s_intern.lru_tail = LINK_END;
+    s_intern.stats.arena_size = s_intern.arena_size;
+    s_ready = true;
+    return true;
+}
+
+static void lru_unlink(uint16_t idx)
+{
+    dish_entry_t *e = &s_intern.entries[idx];
+    if (e->prev != LINK_END) {
+        s_intern.entries[e->prev].next = e->next;
+    } else {
+        s_intern.lru_head = e->next;
+    }
+    if (e->next != LINK_END) {
+        s_intern.entries[e->next].prev = e->prev;
+    } else {
+        s_intern.lru_tail = e->prev;
+    }
+}
+
+static void lru_append(uint16_t idx)
+{
+    dish_entry_t *e = &s_intern.entries[idx];
+    e->prev = s_intern.lru_tail;
+    e->next = LINK_END;
+    if (s_intern.lru_tail != LINK_END) {
+        s_intern.entries[s_intern.lru_tail].next = idx;
+    } else {
+        s_intern.lru_head = idx;
+    }
+    s_intern.lru_tail = idx;
+}
+
+// 查找菜品名所在槽位，不存在时返回应插入的空槽
+static uint32_t table_probe(const char *name, size_t len, uint32_t hash, bool *found)
+{
+    uint32_t pos = hash & s_intern.mask;
+    for (;;) {
+        uint32_t slot = s_intern.table[pos];
+        if (slot == SLOT_EMPTY) {
+            *found = false;
+            return pos;
+        }
+        if (SLOT_TAG(slot) == (hash & 0xFFFF0000u)) {
+            const dish_entry_t *e = &s_intern.entries[SLOT_INDEX(slot)];
+            if (e->len == len && memcmp(s_intern.arena + e->text_off, name, len) == 0) {
+                *found = true;
+                return pos;
+            }
+        }
+        pos = (pos + 1) & s_intern.mask;
+    }
+}
+
+// 回移删除槽位，不留墓碑
+static void table_delete(uint32_t pos)
+{
+    uint32_t hole = pos;
+    uint32_t next = pos;
+    for (;;) {
+        next = (next + 1) & s_intern.mask;
+        uint32_t slot = s_intern.table[next];
+        if (slot == SLOT_EMPTY) {
+            break;
+        }
+        uint32_t home = s_intern.entries[SLOT_INDEX(slot)].hash & s_intern.mask;
+        if (((next - home) & s_intern.mask) >= ((next - hole) & s_intern.mask)) {
+            s_intern.table[hole] = slot;
+            hole = next;
+        }
+    }
+    s_intern.table[hole] = SLOT_EMPTY;
+}
+
+static void chunk_free(uint32_t off, uint8_t cls)
+{
+    memcpy(s_intern.arena + off, &s_intern.free_chunk[cls], sizeof(uint32_t));
+    s_intern.free_chunk[cls] = off;
+}
+
+static bool chunk_alloc(uint8_t cls, uint32_t *off)
+{
+    if (s_intern.free_chunk[cls] != CHUNK_END) {
+        *off = s_intern.free_chunk[cls];
+        memcpy(&s_intern.free_chunk[cls], s_intern.arena + *off, sizeof(uint32_t));
+        return true;
+    }
+    uint32_t size = (uint32_t)cls * GRANULE;
+    if (s_intern.bump + size <= s_intern.arena_size) {
+        *off = s_intern.bump;
+        s_intern.bump += size;
+        return true;
+    }
+    // 文本区已用完时拆分更大的空闲块，剩余部分挂到对应大小的空闲链表
+    for (uint8_t big = cls + 1; big <= CLASS_MAX; big++) {
+        if (s_intern.free_chunk[big] != CHUNK_END) {
+            *off = s_intern.free_chunk[big];
+            memcpy(&s_intern.free_chunk[big], s_intern.arena + *off, sizeof(uint32_t));
+            chunk_free(*off + size, big - cls);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 淘汰最早归零的条目，归还其文本块和条目
+static bool evict_one(void)
+{
+    uint16_t idx = s_intern.lru_head;
+    if (idx == LINK_END) {
+        return false;
+    }
+
+    dish_entry_t *e = &s_intern.entries[idx];
+    bool found;
+    uint32_t pos = table_probe((const char *)s_intern.arena + e->text_off, e->len, e->hash, &found);
+    if (found) {
+        table_delete(pos);
+    }
+    lru_unlink(idx);
+
+    chunk_free(e->text_off, e->cls);
+    s_intern.stats.stored_bytes -= (uint32_t)e->cls * GRANULE;
+
+    e->cls = 0;
+    e->next = s_intern.free_entry;
+    s_intern.free_entry = idx;
+    s_intern.stats.cached--;
+    s_intern.stats.evictions++;
+    return true;
+}
+
+dish_id_t dish_intern_acquire(const char *name, size_t len)
+{
+    if (!name || (!s_ready && !intern_init())) {
+        return DISH_ID_NONE;
+    }
+
+    // 超长时退回到完整UTF-8字符处截断
+    if (len > DISH_NAME_MAX) {
+        len = DISH_NAME_MAX;
+        while (len > 0 && ((uint8_t)name[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+
+    s_intern.stats.lookups++;
+    uint32_t hash = name_hash(name, len);
+    bool found;
+    uint32_t pos = table_probe(name, len, hash, &found);
+    if (found) {
+        uint16_t idx = SLOT_INDEX(s_intern.table[pos]);
+        dish_entry_t *e = &s_intern.entries[idx];
+        if (e->refs++ == 0) {
+            lru_unlink(idx);
+            s_intern.stats.cached--;
+            s_intern.stats.live++;
+        }
+        s_intern.stats.hits++;
+        s_intern.stats.ref_bytes += len + 1;
+        return idx;
+    }
+
+    // 条目或文本块不足时淘汰零引用的菜品名
+    uint8_t cls = (uint8_t)((len + GRANULE) / GRANULE);
+    uint32_t off;
+    while (s_intern.free_entry == LINK_END || !chunk_alloc(cls, &off)) {
+        if (!evict_one()) {
+            s_intern.stats.failures++;
+            return DISH_ID_NONE;
+        }
+    }
+
+    uint16_t idx = s_intern.free_entry;
+    dish_entry_t *e = &s_intern.entries[idx];
+    s_intern.free_entry = e->next;
+
+    memcpy(s_intern.arena + off, name, len);
+    s_intern.arena[off + len] = '\0';
+    e->hash = hash;
+    e->refs = 1;
+    e->text_off = off;
+    e->len = (uint16_t)len;
+    e->cls = cls;
+    e->prev = LINK_END;
+    e->next = LINK_END;
+
+    // 淘汰可能移动过槽位，重新定位插入点
+    pos = table_probe(name, len, hash, &found);
+    s_intern.table[pos] = SLOT_MAKE(hash, idx);
+
+    s_intern.stats.live++;
+    s_intern.stats.ref_bytes += len + 1;
+    s_intern.stats.stored_bytes += (uint32_t)cls * GRANULE;
+    return idx;
+}
+
+void dish_intern_release(dish_id_t id)
+{
+    if (!s_ready || id >= CONFIG_ORDER_DISH_INTERN_MAX) return;
+
+    dish_entry_t *e = &s_intern.entries[id];
+    if (e->cls == 0 || e->refs == 0) return;
+
+    s_intern.stats.ref_bytes -= e->len + 1;
+    if (--e->refs == 0) {
+        lru_append(id);
+        s_intern.stats.live--;
+        s_intern.stats.cached++;
+    }
+}
+
+const char *dish_intern_str(dish_id_t id)
+{
+    if (!s_ready || id >= CONFIG_ORDER_DISH_INTERN_MAX || s_intern.entries[id].cls == 0) {
+        return "";
+    }
+    return (const char *)s_intern.arena + s_intern.entries[id].text_off;
+}
+
+uint16_t dish_intern_len(dish_id_t id)
+{
+    if (!s_ready || id >= CONFIG_ORDER_DISH_INTERN_MAX || s_intern.entries[id].cls == 0) {
+        return 0;
+    }
+    return s_intern.entries[id].len;
+}
+
+uint32_t dish_intern_hash(dish_id_t id)
+{
+    if (!s_ready || id >= CONFIG_ORDER_DISH_INTERN_MAX || s_intern.entries[id].cls == 0) {
+        return 0;
+    }
+    return s_intern.entries[id].hash;
+}
+
+void dish_intern_get_stats(dish_intern_stats_t *stats)
+{
+    if (!stats) return;
+    *stats = s_intern.stats;
+}
+
+void dish_intern_log_stats(void)
+{
+    dish_intern_stats_t stats;
+    dish_intern_get_stats(&stats);
+
+    uint32_t hit_rate = stats.lookups ? (uint32_t)((uint64_t)stats.hits * 100 / stats.lookups) : 0;
+    int32_t saved = (int32_t)stats.ref_bytes - (int32_t)stats.stored_bytes;
+    DLOGI(TAG, "菜品名: 引用中 %u, 缓存 %u, 命中率 %lu%% (%lu/%lu), 淘汰 %lu, 失败 %lu, "
+          "引用文本 %lu 字节, 实际占用 %lu/%lu 字节, 节省 %ld 字节",
+          stats.live, stats.cached, hit_rate, stats.hits, stats.lookups, stats.evictions, stats.failures,
+          stats.ref_bytes, stats.stored_bytes, stats.arena_size, saved);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file dish_intern.h
+ * @brief 菜品名驻留表
+ *
+ * 同一个菜品名在所有订单中只保存一份：
+ *   - 按UTF-8字节哈希（开放寻址），订单中只保存16位句柄；
+ *   - 文本存放在预分配的PSRAM区中，按16字节粒度分块，释放的块按大小挂回空闲链表；
+ *   - 引用计数归零的菜品名暂不删除，下次出现时直接复用；区满时按归零先后淘汰；
+ *   - 返回的文本在引用期间地址不变，菜品卡片可直接用lv_label_set_text_static引用。
+ * 驻留表不加锁，与订单存储一样由调用方保证串行访问。
+ */
+
+#ifndef DISH_INTERN_H
+#define DISH_INTERN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// 菜品名最大字节数（不含'\0'），超出部分按UTF-8字符边界截断
+#define DISH_NAME_MAX   127
+#define DISH_ID_NONE    0xFFFF
+
+typedef uint16_t dish_id_t;
+
+/**
+ * @brief 驻留表统计信息
+ */
+typedef struct {
+    uint32_t lookups;        // 驻留请求次数
+    uint32_t hits;           // 命中已有菜品名的次数
+    uint32_t evictions;      // 淘汰的零引用菜品名
+    uint32_t failures;       // 条目或文本区不足导致的失败
+    uint16_t live;           // 正被引用的菜品名数
+    uint16_t cached;         // 零引用但仍保留的菜品名数
+    uint32_t ref_bytes;      // 所有引用的文本合计（不驻留时各自拷贝所需的字节数）
+    uint32_t stored_bytes;   // 实际占用的文本区字节数
+    uint32_t arena_size;     // 文本区大小
+} dish_intern_stats_t;
+
+/**
+ * @brief 驻留菜品名并增加一次引用（首次调用时创建驻留表）
+ *
+ * @param name UTF-8菜品名（不要求以'\0'结尾）
+ * @param len 字节数
+ * @return dish_id_t 句柄，失败返回DISH_ID_NONE
+ */
+dish_id_t dish_intern_acquire(const char *name, size_t len);
+
+/**
+ * @brief 释放一次引用
+ */
+void dish_intern_release(dish_id_t id);
+
+/**
+ * @brief 以'\0'结尾的菜品名，引用期间地址不变
+ */
+const char *dish_intern_str(dish_id_t id);
+
+/**
+ * @brief 菜品名字节数（不含'\0'）
+ */
+uint16_t dish_intern_len(dish_id_t id);
+
+/**
+ * @brief 菜品名的哈希值（句柄被淘汰后复用时可据此识别为另一个菜品名）
+ */
+uint32_t dish_intern_hash(dish_id_t id);
+
+/**
+ * @brief 获取统计信息
+ */
+void dish_intern_get_stats(dish_intern_stats_t *stats);
+
+/**
+ * @brief 打印统计信息（节省的内存和命中率）
+ */
+void dish_intern_log_stats(void);
+
+#endif // DISH_INTERN_H
@@ -0,0 +1,347 @@
+/**
+ * @file glyph_cache.c
+ * @brief 菜品字体字形缓存实现
+ */
+
+#include "glyph_cache.h"
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "order_log.h"
+
+static const char *TAG = "GlyphCache";
+
+#define CACHE_BUCKETS       256          // 2的幂
+#define WARM_TASK_STACK     4096
+#define WARM_TASK_PRIO      1
+#define WARM_TEXT_MAX       256          // 单次预热的最大字节数
+
+// 缓存的字形：条目头后紧跟A8位图
+typedef struct glyph_entry {
+    uint32_t gid;                        // 原字体中的字形序号
+    uint16_t refs;                       // 正在绘制的次数，非0时不淘汰
+    struct glyph_entry *hnext;           // 哈希桶链表
+    struct glyph_entry *prev;            // LRU链表，头部最久未使用
+    struct glyph_entry *next;
+    uint32_t size;                       // 条目总字节数
+    lv_draw_buf_t buf;
+} glyph_entry_t;
+
+static const lv_font_t *s_base;
+static lv_font_t s_font;
+static SemaphoreHandle_t s_mutex;
+static RingbufHandle_t s_rb;
+static glyph_entry_t *s_buckets[CACHE_BUCKETS];
+static glyph_entry_t *s_lru_head;
+static glyph_entry_t *s_lru_tail;
+static glyph_cache_stats_t s_stats;
+
+static inline uint32_t bucket_of(uint32_t gid)
+{
+    return (gid * 2654435761u) >> 24 & (CACHE_BUCKETS - 1);
+}
+
+static glyph_entry_t *cache_find(uint32_t gid)
+{
+    for (glyph_entry_t *e = s_buckets[bucket_of(gid)]; e; e = e->hnext) {
+        if (e->gid == gid) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink(glyph_entry_t *e)
+{
+    if (e->prev) e->prev->next = e->next; else s_lru_head = e->next;
+    if (e->next) e->next->prev = e->prev; else s_lru_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_append(glyph_entry_t *e)
+{
+    e->prev = s_lru_tail;
+    e->next = NULL;
+    if (s_lru_tail) s_lru_tail->next = e; else s_lru_head = e;
+    s_lru_tail = e;
+}
+
+static void cache_remove(glyph_entry_t *e)
+{
+    glyph_entry_t **pp = &s_buckets[bucket_of(e->gid)];
+    while (*pp != e) {
+        pp = &(*pp)->hnext;
+    }
+    *pp = e->hnext;
+    lru_unlink(e);
+    s_stats.glyphs--;
+    s_stats.bytes -= e->size;
+    heap_caps_free(e);
+}
+
+// 腾出size字节，只淘汰未在绘制中的字形
+static bool cache_make_room(uint32_t size)
+{
+    glyph_entry_t *e = s_lru_head;
+    while (s_stats.bytes + size > s_stats.budget && e) {
+        glyph_entry_t *next = e->next;
+        if (e->refs == 0) {
+            cache_remove(e);
+            s_stats.evictions++;
+        }
+        e = next;
+    }
+    return s_stats.bytes + size <= s_stats.budget;
+}
+
+// 把字形解压到新条目中，g_dsc需已由原字体的get_glyph_dsc填充
+static glyph_entry_t *cache_insert(lv_font_glyph_dsc_t *g_dsc, bool evict)
+{
+    uint32_t stride = lv_draw_buf_width_to_stride(g_dsc->box_w, LV_COLOR_FORMAT_A8);
+    uint32_t data_size = stride * g_dsc->box_h;
+    uint32_t size = sizeof(glyph_entry_t) + data_size;
+
+    if (evict ? !cache_make_room(size) : s_stats.bytes + size > s_stats.budget) {
+        s_stats.over_budget++;
+        return NULL;
+    }
+    glyph_entry_t *e = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!e) {
+        s_stats.over_budget++;
+        return NULL;
+    }
+
+    memset(e, 0, sizeof(*e));
+    lv_draw_buf_init(&e->buf, g_dsc->box_w, g_dsc->box_h, LV_COLOR_FORMAT_A8, stride, e + 1, data_size);
+
+    // 由原字体解压，解压结果写入条目的位图
+    const lv_font_t *resolved = g_dsc->resolved_font;
+    g_dsc->resolved_font = s_base;
+    const void *bitmap = s_base->get_glyph_bitmap(g_dsc, &e->buf);
+    g_dsc->resolved_font = resolved;
+    if (!bitmap) {
+        heap_caps_free(e);
+        return NULL;
+    }
+
+    e->gid = g_dsc->gid.index;
+    e->size = size;
+    uint32_t b = bucket_of(e->gid);
+    e->hnext = s_buckets[b];
+    s_buckets[b] = e;
+    lru_append(e);
+    s_stats.glyphs++;
+    s_stats.bytes += size;
+    return e;
+}
+
+static bool cached_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    // 原字体的字形查找可能带有内部状态，与预热任务串行
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool found = s_base->get_glyph_dsc(s_base, dsc, letter, letter_next);
+    xSemaphoreGive(s_mutex);
+    return found;
+}
+
+static const void *cached_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+    if (g_dsc->box_w == 0 || g_dsc->box_h == 0) {
+        return NULL;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    glyph_entry_t *e = cache_find(g_dsc->gid.index);
+    if (e) {
+        s_stats.hits++;
+        lru_unlink(e);
+        lru_append(e);
+    } else {
+        s_stats.misses++;
+        e = cache_insert(g_dsc, true);
+    }
+
+    const void *bitmap;
+    if (e) {
+        // 绘制完成前不淘汰，entry作为句柄交给release_glyph
+        e->refs++;
+        g_dsc->entry = (lv_cache_entry_t *)e;
+        bitmap = &e->buf;
+    } else {
+        // 预算不足时直接解压到调用方的缓冲区
+        const lv_font_t *resolved = g_dsc->resolved_font;
+        g_dsc->resolved_font = s_base;
+        bitmap = s_base->get_glyph_bitmap(g_dsc, draw_buf);
+        g_dsc->resolved_font = resolved;
+    }
+    xSemaphoreGive(s_mutex);
+    return bitmap;
+}
+
+static void cached_release_glyph(const lv_font_t *font, lv_font_glyph_dsc_t *g_dsc)
+{
+    glyph_entry_t *e = (glyph_entry_t *)g_dsc->entry;
+    if (!e) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (e->refs) e->refs--;
+    xSemaphoreGive(s_mutex);
+    g_dsc->entry = NULL;
+}
+
+// 解码一个UTF-8字符，返回0表示结束或无效
+static uint32_t utf8_next(const char *text, size_t len, size_t *pos)
+{
+    const uint8_t *p = (const uint8_t *)text + *pos;
+    size_t left = len - *pos;
+    if (left == 0) return 0;
+
+    uint32_t cp;
+    size_t n;
+    if (p[0] < 0x80) {
+        cp = p[0];
+        n = 1;
+    } else if ((p[0] & 0xE0) == 0xC0) {
+        cp = p[0] & 0x1F;
+        n = 2;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        cp = p[0] & 0x0F;
+        n = 3;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        cp = p[0] & 0x07;
+        n = 4;
+    } else {
+        return 0;
+    }
+    if (n > left) return 0;
+    for (size_t i = 1; i < n; i++) {
+        if ((p[i] & 0xC0) != 0x80) return 0;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    *pos += n;
+    return cp;
+}
+
+// 预热一个字符：只使用剩余预算，不淘汰已有字形
+static void warm_letter(uint32_t letter)
+{
+    lv_font_glyph_dsc_t g_dsc;
+    memset(&g_dsc, 0, sizeof(g_dsc));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_base->get_glyph_dsc(s_base, &g_dsc, letter, 0) && !g_dsc.is_placeholder &&
+        g_dsc.box_w && g_dsc.box_h) {
+        g_dsc.resolved_font = &s_font;
+        if (cache_find(g_dsc.gid.index)) {
+            s_stats.warm_skipped++;
+        } else if (cache_insert(&g_dsc, false)) {
+            s_stats.warmed++;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+static void warm_task(void *arg)
+{
+    for (;;) {
+        size_t size;
+        char *text = xRingbufferReceive(s_rb, &size, portMAX_DELAY);
+        if (!text) continue;
+
+        size_t pos = 0;
+        uint32_t letter;
+        while ((letter = utf8_next(text, size, &pos)) != 0) {
+            if (letter > ' ') {
+                warm_letter(letter);
+            }
+            // 每个字形之间让出互斥锁，渲染线程不会长时间等待
+            taskYIELD();
+        }
+        vRingbufferReturnItem(s_rb, text);
+    }
+}
+
+lv_font_t *glyph_cache_create(const lv_font_t *base)
+{
+#if !CONFIG_ORDER_GLYPH_CACHE
+    return NULL;
+#else
+    if (!base || !base->get_glyph_dsc || !base->get_glyph_bitmap || s_base) {
+        return NULL;
+    }
+
+    s_mutex = xSemaphoreCreateMutex();
+    s_rb = xRingbufferCreate(CONFIG_ORDER_GLYPH_WARM_BUFFER, RINGBUF_TYPE_NOSPLIT);
+    if (!s_mutex || !s_rb ||
+        xTaskCreate(warm_task, "glyph_warm", WARM_TASK_STACK, NULL, WARM_TASK_PRIO, NULL) != pdPASS) {
+        DLOGE(TAG, "创建字形缓存失败");
+        if (s_rb) vRingbufferDelete(s_rb);
+        if (s_mutex) vSemaphoreDelete(s_mutex);
+        s_rb = NULL;
+        s_mutex = NULL;
+        return NULL;
+    }
+
+    // 包装字体沿用原字体的度量，字形查找和位图经由缓存
+    s_font = *base;
+    s_font.get_glyph_dsc = cached_get_glyph_dsc;
+    s_font.get_glyph_bitmap = cached_get_glyph_bitmap;
+    s_font.release_glyph = cached_release_glyph;
+    s_stats.budget = (uint32_t)CONFIG_ORDER_GLYPH_CACHE_KB * 1024;
+    s_base = base;
+
+    DLOGI(TAG, "字形缓存已启用，预算 %lu KB", s_stats.budget / 1024);
+    return &s_font;
+#endif
+}
+
+esp_err_t glyph_cache_warm(const char *text, size_t len)
+{
+    if (!s_rb) return ESP_ERR_INVALID_STATE;
+    if (!text || len == 0) return ESP_OK;
+
+    // 超长时在字符边界截断
+    if (len > WARM_TEXT_MAX) {
+        len = WARM_TEXT_MAX;
+        while (len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) {
+            len--;
+        }
+    }
+    if (xRingbufferSend(s_rb, text, len, 0) != pdTRUE) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_stats.dropped++;
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void glyph_cache_get_stats(glyph_cache_stats_t *stats)
+{
+    if (!stats) return;
+    if (!s_mutex) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_mutex);
+}
+
+void glyph_cache_log_stats(void)
+{
+    if (!s_mutex) return;
+
+    glyph_cache_stats_t stats;
+    glyph_cache_get_stats(&stats);
+    uint32_t lookups = stats.hits + stats.misses;
+    uint32_t hit_rate = lookups ? (uint32_t)((uint64_t)stats.hits * 100 / lookups) : 0;
+    DLOGI(TAG, "字形缓存: 命中 %lu, 未命中 %lu (命中率 %lu%%), 预热 %lu (已缓存 %lu), 淘汰 %lu, "
+          "超出预算 %lu, 丢弃 %lu, 字形 %lu, 占用 %lu/%lu 字节",
+          stats.hits, stats.misses, hit_rate, stats.warmed, stats.warm_skipped, stats.evictions,
+          stats.over_budget, stats.dropped, stats.glyphs, stats.bytes, stats.budget);
+}
@@ -0,0 +1,67 @@
+/**
+ * @file glyph_cache.h
+ * @brief 菜品字体字形缓存与后台预热
+ *
+ * binfont的字形位图是压缩存储的，每次绘制都要在渲染线程上解压。这里把原字体包装成一个
+ * 新字体：
+ *   - 字形位图首次绘制时解压为A8并缓存在PSRAM中，之后直接返回缓存；
+ *   - 缓存总量受预算限制，超出时淘汰最久未使用且未在绘制中的字形；
+ *   - glyph_cache_warm把文字放入队列，由后台任务提前解压其中的字形（只用剩余预算，不淘汰）。
+ * 渲染线程（可能有多个绘制单元）和预热任务通过缓存内部的互斥锁串行访问原字体。
+ */
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "lvgl.h"
+
+/**
+ * @brief 字形缓存统计信息
+ */
+typedef struct {
+    uint32_t hits;           // 绘制时命中缓存
+    uint32_t misses;         // 绘制时未命中（现场解压）
+    uint32_t warmed;         // 预热解压的字形数
+    uint32_t warm_skipped;   // 预热时已在缓存中的字形数
+    uint32_t evictions;      // 淘汰的字形数
+    uint32_t over_budget;    // 预算不足未能缓存的次数
+    uint32_t dropped;        // 预热队列满丢弃的文字段数
+    uint32_t glyphs;         // 当前缓存的字形数
+    uint32_t bytes;          // 当前缓存占用（含条目头）
+    uint32_t budget;         // 缓存预算
+} glyph_cache_stats_t;
+
+/**
+ * @brief 用字形缓存包装字体并启动预热任务（只能调用一次）
+ *
+ * @param base 原字体（通常为lv_binfont_create加载的字体），需在缓存存在期间保持有效
+ * @return lv_font_t* 包装后的字体，失败返回NULL（此时应直接使用原字体）
+ */
+lv_font_t *glyph_cache_create(const lv_font_t *base);
+
+/**
+ * @brief 预热一段UTF-8文字中的字形（复制后放入队列，立即返回）
+ *
+ * @param text UTF-8文字（不要求以'\0'结尾）
+ * @param len 字节数
+ * @return esp_err_t
+ *         - ESP_OK 已放入队列
+ *         - ESP_ERR_INVALID_STATE 缓存尚未创建
+ *         - ESP_ERR_NO_MEM 队列已满
+ */
+esp_err_t glyph_cache_warm(const char *text, size_t len);
+
+/**
+ * @brief 获取统计信息
+ */
+void glyph_cache_get_stats(glyph_cache_stats_t *stats);
+
+/**
+ * @brief 打印统计信息
+ */
+void glyph_cache_log_stats(void);
+
+#endif // GLYPH_CACHE_H
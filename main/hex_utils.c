@@ -1,46 +1,123 @@
 #include "hex_utils.h"
-#include <ctype.h>
 #include <string.h>
 
+#define HEX_BAD 0xFF
+
+// 字符到数值的查找表，非十六进制字符为HEX_BAD（高4位非0）
+#define HEX_ROW_BAD16 HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, \
+                      HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD
+static const uint8_t s_hex_lut[256] = {
+    HEX_ROW_BAD16, HEX_ROW_BAD16, HEX_ROW_BAD16,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD,
+    HEX_BAD, 10, 11, 12, 13, 14, 15, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD,
+    HEX_ROW_BAD16,
+    HEX_BAD, 10, 11, 12, 13, 14, 15, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD, HEX_BAD,
+    HEX_ROW_BAD16,
+    HEX_ROW_BAD16, HEX_ROW_BAD16, HEX_ROW_BAD16, HEX_ROW_BAD16,
+    HEX_ROW_BAD16, HEX_ROW_BAD16, HEX_ROW_BAD16, HEX_ROW_BAD16,
+};
+
 /* 十六进制字符转换为数值 */
 uint8_t hex_char_to_value(char c) {
-    if (c >= '0' && c <= '9') return c - '0';
-    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
-    return 0;
+    uint8_t v = s_hex_lut[(uint8_t)c];
+    return v == HEX_BAD ? 0 : v;
 }
 
 /* 检查字符串是否为有效的十六进制 */
 bool hex_is_valid(const char *str) {
-    for (int i = 0; str[i]; i++) {
-        if (!isxdigit((unsigned char)str[i])) {
-            return false;
-        }
+    uint8_t acc = 0;
+    for (const uint8_t *p = (const uint8_t *)str; *p; p++) {
+        acc |= s_hex_lut[*p];
+    }
+    return (acc & 0xF0) == 0;
+}
+
+/* 输出与输入是否重叠（原地解码） */
+static bool hex_overlaps(const uint8_t *in, size_t in_len, const uint8_t *out, size_t out_len) {
+    uintptr_t a = (uintptr_t)in;
+    uintptr_t b = (uintptr_t)out;
+    return b < a + in_len && a < b + out_len;
+}
+
+/* 只校验不写出 */
+static bool hex_all_valid(const uint8_t *in, size_t len) {
+    uint8_t bad = 0;
+    for (size_t i = 0; i < len; i++) {
+        bad |= s_hex_lut[in[i]];
+    }
+    return (bad & 0xF0) == 0;
+}
+
+/* 解码核心：主循环一次查表8个字符、写出4字节，返回各字符查表结果的按位或（高4位非0表示有非法字符） */
+static inline uint8_t hex_decode_core(const uint8_t *in, size_t hex_len, uint8_t *out) {
+    uint8_t bad = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    for (; i + 8 <= hex_len; i += 8, j += 4) {
+        uint8_t v0 = s_hex_lut[in[i]];
+        uint8_t v1 = s_hex_lut[in[i + 1]];
+        uint8_t v2 = s_hex_lut[in[i + 2]];
+        uint8_t v3 = s_hex_lut[in[i + 3]];
+        uint8_t v4 = s_hex_lut[in[i + 4]];
+        uint8_t v5 = s_hex_lut[in[i + 5]];
+        uint8_t v6 = s_hex_lut[in[i + 6]];
+        uint8_t v7 = s_hex_lut[in[i + 7]];
+        bad |= v0 | v1 | v2 | v3 | v4 | v5 | v6 | v7;
+
+        // 先读完8个输入再写出，保证原地解码安全
+        out[j]     = (uint8_t)(v0 << 4) | v1;
+        out[j + 1] = (uint8_t)(v2 << 4) | v3;
+        out[j + 2] = (uint8_t)(v4 << 4) | v5;
+        out[j + 3] = (uint8_t)(v6 << 4) | v7;
+    }
+
+    for (; i < hex_len; i += 2, j++) {
+        uint8_t hi = s_hex_lut[in[i]];
+        uint8_t lo = s_hex_lut[in[i + 1]];
+        bad |= hi | lo;
+        out[j] = (uint8_t)(hi << 4) | lo;
     }
-    return true;
+    return bad;
+}
+
+/* 校验并解码十六进制：合并校验只在解码结束后判断一次 */
+int hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size) {
+    if (hex_len % 2 != 0) {
+        return HEX_ERR_ODD_LENGTH;
+    }
+    size_t out_len = hex_len / 2;
+    if (out_size < out_len) {
+        return HEX_ERR_NO_SPACE;
+    }
+
+    const uint8_t *in = (const uint8_t *)hex;
+
+    // 原地解码时先整体校验，失败不能改写输入（调用方会退回使用原文）
+    if (hex_overlaps(in, hex_len, out, out_len) && !hex_all_valid(in, hex_len)) {
+        return HEX_ERR_INVALID;
+    }
+
+    if (hex_decode_core(in, hex_len, out) & 0xF0) {
+        return HEX_ERR_INVALID;
+    }
+    return (int)out_len;
+}
+
+/* 解码已校验过的十六进制 */
+void hex_decode_unchecked(const char *hex, size_t hex_len, uint8_t *out) {
+    (void)hex_decode_core((const uint8_t *)hex, hex_len, out);
 }
 
 /* 十六进制字符串转换为UTF-8字符串 */
 int hex_to_ascii(const char *hex, char *output, size_t output_size) {
-    int hex_len = strlen(hex);
-    if (hex_len % 2 != 0 || output_size < hex_len / 2 + 1) {
+    if (output_size == 0) {
         return -1;
     }
-    
-    int j = 0;
-    for (int i = 0; i < hex_len; i += 2) {
-        uint8_t high = hex_char_to_value(hex[i]);
-        uint8_t low = hex_char_to_value(hex[i + 1]);
-        uint8_t byte = (high << 4) | low;
-        
-        // 对于中文字符（UTF-8编码），直接存储字节
-        output[j++] = byte;
-        
-        // 检查输出缓冲区是否已满
-        if (j >= output_size - 1) {
-            break;
-        }
-    }
-    output[j] = '\0';
-    return j;
-}
\ No newline at end of file
+    int len = hex_decode(hex, strlen(hex), (uint8_t *)output, output_size - 1);
+    if (len < 0) {
+        return -1;
+    }
+    output[len] = '\0';
+    return len;
+}
@@ -5,13 +5,44 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+// hex_decode错误码
+#define HEX_ERR_ODD_LENGTH  (-1)  // 长度不是偶数
+#define HEX_ERR_INVALID     (-2)  // 含非十六进制字符
+#define HEX_ERR_NO_SPACE    (-3)  // 输出缓冲区不足
+
 // 十六进制字符转换为数值
 uint8_t hex_char_to_value(char c);
 
 // 检查字符串是否为有效的十六进制
 bool hex_is_valid(const char *str);
 
-// 十六进制字符串转换为普通字符串
+/**
+ * @brief 校验并解码十六进制（每次处理8个字符）
+ *
+ * 输出不追加'\0'。允许原地解码（out == hex）：此时先校验整个输入再写出，
+ * 失败时输入保持不变；输出与输入不重叠时单次遍历，失败时out的内容不确定。
+ *
+ * @param hex 十六进制字符
+ * @param hex_len 字符数
+ * @param out 输出缓冲区
+ * @param out_size 输出缓冲区大小
+ * @return int 成功返回解码字节数，失败返回HEX_ERR_*
+ */
+int hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size);
+
+/**
+ * @brief 解码已校验过的十六进制，不再检查输入
+ *
+ * 调用方需已确认hex_len为偶数、全部为十六进制字符且out至少有hex_len/2字节（否则输出不确定）。
+ * 允许原地解码（out == hex），不允许out位于hex之后的部分重叠。
+ *
+ * @param hex 十六进制字符
+ * @param hex_len 字符数
+ * @param out 输出缓冲区
+ */
+void hex_decode_unchecked(const char *hex, size_t hex_len, uint8_t *out);
+
+// 十六进制字符串转换为普通字符串（以'\0'结尾，失败返回-1）
 int hex_to_ascii(const char *hex, char *output, size_t output_size);
 
-#endif // HEX_UTILS_H
\ No newline at end of file
+#endif // HEX_UTILS_H
@@ -0,0 +1,256 @@
+/**
+ * @file json_tok.c
+ * @brief 无内存分配的JSON词法分析器实现
+ */
+
+#include "json_tok.h"
+#include <string.h>
+
+// 分配一个token
+static json_tok_t *tok_alloc(json_tok_parser_t *parser, json_tok_t *tokens, unsigned int num_tokens)
+{
+    if ((unsigned int)parser->next >= num_tokens) {
+        return NULL;
+    }
+    json_tok_t *tok = &tokens[parser->next++];
+    tok->start = -1;
+    tok->end = -1;
+    tok->size = 0;
+    tok->parent = -1;
+    tok->type = JSON_TOK_UNDEFINED;
+    return tok;
+}
+
+// 解析基本类型（数字、true/false/null）
+static int parse_primitive(json_tok_parser_t *parser, const char *js, size_t len,
+                           json_tok_t *tokens, unsigned int num_tokens)
+{
+    uint32_t start = parser->pos;
+
+    for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+        char c = js[parser->pos];
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n' ||
+            c == ',' || c == ']' || c == '}' || c == ':') {
+            break;
+        }
+        if (c < 32 || c >= 127) {
+            parser->pos = start;
+            return JSON_TOK_ERR_INVAL;
+        }
+    }
+
+    json_tok_t *tok = tok_alloc(parser, tokens, num_tokens);
+    if (!tok) {
+        parser->pos = start;
+        return JSON_TOK_ERR_NOMEM;
+    }
+    tok->type = JSON_TOK_PRIMITIVE;
+    tok->start = start;
+    tok->end = parser->pos;
+    tok->parent = parser->super;
+    parser->pos--;
+    return 0;
+}
+
+// 解析字符串（只校验转义，不做反转义）
+static int parse_string(json_tok_parser_t *parser, const char *js, size_t len,
+                        json_tok_t *tokens, unsigned int num_tokens)
+{
+    uint32_t start = parser->pos;
+
+    // 跳过起始引号
+    parser->pos++;
+
+    for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+        char c = js[parser->pos];
+
+        if (c == '"') {
+            json_tok_t *tok = tok_alloc(parser, tokens, num_tokens);
+            if (!tok) {
+                parser->pos = start;
+                return JSON_TOK_ERR_NOMEM;
+            }
+            tok->type = JSON_TOK_STRING;
+            tok->start = start + 1;
+            tok->end = parser->pos;
+            tok->parent = parser->super;
+            return 0;
+        }
+
+        if (c == '\\' && parser->pos + 1 < len) {
+            parser->pos++;
+            switch (js[parser->pos]) {
+            case '"': case '/': case '\\': case 'b':
+            case 'f': case 'r': case 'n': case 't':
+                break;
+            case 'u':
+                parser->pos++;
+                for (int i = 0; i < 4 && parser->pos < len && js[parser->pos] != '\0'; i++) {
+                    char h = js[parser->pos];
+                    if (!((h >= '0' && h <= '9') || (h >= 'A' && h <= 'F') || (h >= 'a' && h <= 'f'))) {
+                        parser->pos = start;
+                        return JSON_TOK_ERR_INVAL;
+                    }
+                    parser->pos++;
+                }
+                parser->pos--;
+                break;
+            default:
+                parser->pos = start;
+                return JSON_TOK_ERR_INVAL;
+            }
+        }
+    }
+
+    parser->pos = start;
+    return JSON_TOK_ERR_PART;
+}
+
+void json_tok_init(json_tok_parser_t *parser)
+{
+    parser->pos = 0;
+    parser->next = 0;
+    parser->super = -1;
+}
+
+int json_tok_parse(json_tok_parser_t *parser, const char *js, size_t len,
+                   json_tok_t *tokens, unsigned int num_tokens)
+{
+    int count = parser->next;
+
+    for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++) {
+        char c = js[parser->pos];
+        json_tok_t *tok;
+        int r;
+
+        switch (c) {
+        case '{':
+        case '[':
+            tok = tok_alloc(parser, tokens, num_tokens);
+            if (!tok) {
+                return JSON_TOK_ERR_NOMEM;
+            }
+            if (parser->super != -1) {
+                json_tok_t *super = &tokens[parser->super];
+                // 对象或数组不能作为键
+                if (super->type == JSON_TOK_OBJECT) {
+                    return JSON_TOK_ERR_INVAL;
+                }
+                super->size++;
+                tok->parent = parser->super;
+            }
+            tok->type = (c == '{') ? JSON_TOK_OBJECT : JSON_TOK_ARRAY;
+            tok->start = parser->pos;
+            parser->super = parser->next - 1;
+            count++;
+            break;
+
+        case '}':
+        case ']': {
+            json_tok_type_t type = (c == '}') ? JSON_TOK_OBJECT : JSON_TOK_ARRAY;
+            if (parser->next < 1) {
+                return JSON_TOK_ERR_INVAL;
+            }
+            tok = &tokens[parser->next - 1];
+            for (;;) {
+                if (tok->start != -1 && tok->end == -1) {
+                    if (tok->type != type) {
+                        return JSON_TOK_ERR_INVAL;
+                    }
+                    tok->end = parser->pos + 1;
+                    parser->super = tok->parent;
+                    break;
+                }
+                if (tok->parent == -1) {
+                    if (tok->type != type || parser->super == -1) {
+                        return JSON_TOK_ERR_INVAL;
+                    }
+                    break;
+                }
+                tok = &tokens[tok->parent];
+            }
+            break;
+        }
+
+        case '"':
+            r = parse_string(parser, js, len, tokens, num_tokens);
+            if (r < 0) {
+                return r;
+            }
+            if (parser->super != -1) {
+                tokens[parser->super].size++;
+            }
+            count++;
+            break;
+
+        case '\t':
+        case '\r':
+        case '\n':
+        case ' ':
+            break;
+
+        case ':':
+            parser->super = parser->next - 1;
+            break;
+
+        case ',':
+            if (parser->super != -1 &&
+                tokens[parser->super].type != JSON_TOK_ARRAY &&
+                tokens[parser->super].type != JSON_TOK_OBJECT) {
+                parser->super = tokens[parser->super].parent;
+            }
+            break;
+
+        case '-': case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case 't': case 'f': case 'n':
+            // 基本类型不能作为键
+            if (parser->super != -1) {
+                const json_tok_t *super = &tokens[parser->super];
+                if (super->type == JSON_TOK_OBJECT ||
+                    (super->type == JSON_TOK_STRING && super->size != 0)) {
+                    return JSON_TOK_ERR_INVAL;
+                }
+            }
+            r = parse_primitive(parser, js, len, tokens, num_tokens);
+            if (r < 0) {
+                return r;
+            }
+            if (parser->super != -1) {
+                tokens[parser->super].size++;
+            }
+            count++;
+            break;
+
+        default:
+            return JSON_TOK_ERR_INVAL;
+        }
+    }
+
+    // 存在未闭合的对象或数组
+    for (int i = parser->next - 1; i >= 0; i--) {
+        if (tokens[i].start != -1 && tokens[i].end == -1) {
+            return JSON_TOK_ERR_PART;
+        }
+    }
+
+    return count;
+}
+
+bool json_tok_eq(const char *js, const json_tok_t *tok, const char *str)
+{
+    size_t len = strlen(str);
+    return tok->type == JSON_TOK_STRING &&
+           (size_t)(tok->end - tok->start) == len &&
+           memcmp(js + tok->start, str, len) == 0;
+}
+
+int json_tok_skip(const json_tok_t *tokens, int count, int index)
+{
+    int32_t end = tokens[index].end;
+    int next = index + 1;
+    while (next < count && tokens[next].start < end) {
+        next++;
+    }
+    return next;
+}
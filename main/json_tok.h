@@ -0,0 +1,87 @@
+/**
+ * @file json_tok.h
+ * @brief 无内存分配的JSON词法分析器（jsmn风格）
+ *
+ * 直接在输入缓冲区上切分出对象、数组、字符串和基本类型token，
+ * token只记录起止偏移，不拷贝数据、不分配内存。
+ * 对象的size为键的个数，键token的size为1，其值token的parent指向该键。
+ */
+
+#ifndef JSON_TOK_H
+#define JSON_TOK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// token类型
+typedef enum {
+    JSON_TOK_UNDEFINED = 0,
+    JSON_TOK_OBJECT    = 1,
+    JSON_TOK_ARRAY     = 2,
+    JSON_TOK_STRING    = 3,
+    JSON_TOK_PRIMITIVE = 4,
+} json_tok_type_t;
+
+// 错误码
+#define JSON_TOK_ERR_NOMEM  (-1)  // token数组不足
+#define JSON_TOK_ERR_INVAL  (-2)  // 非法字符或结构
+#define JSON_TOK_ERR_PART   (-3)  // 输入不完整
+
+// token：字符串的start/end不含引号
+typedef struct {
+    int32_t start;         // 起始偏移
+    int32_t end;           // 结束偏移（不含）
+    int16_t size;          // 子元素个数
+    int16_t parent;        // 父token下标，-1表示无
+    json_tok_type_t type;  // token类型
+} json_tok_t;
+
+// 解析器状态
+typedef struct {
+    uint32_t pos;      // 当前偏移
+    int16_t next;      // 下一个可用token下标
+    int16_t super;     // 当前父token下标
+} json_tok_parser_t;
+
+/**
+ * @brief 初始化解析器
+ *
+ * @param parser 解析器
+ */
+void json_tok_init(json_tok_parser_t *parser);
+
+/**
+ * @brief 切分JSON文本
+ *
+ * @param parser 解析器
+ * @param js JSON文本
+ * @param len 文本长度
+ * @param tokens token数组
+ * @param num_tokens token数组容量
+ * @return int 成功返回token数量，失败返回JSON_TOK_ERR_*
+ */
+int json_tok_parse(json_tok_parser_t *parser, const char *js, size_t len,
+                   json_tok_t *tokens, unsigned int num_tokens);
+
+/**
+ * @brief 判断字符串token是否等于给定内容
+ *
+ * @param js JSON文本
+ * @param tok token
+ * @param str 比较的字符串
+ * @return true 相等
+ */
+bool json_tok_eq(const char *js, const json_tok_t *tok, const char *str);
+
+/**
+ * @brief 跳过token及其全部子token
+ *
+ * @param tokens token数组
+ * @param count token数量
+ * @param index 当前token下标
+ * @return int 下一个兄弟token的下标
+ */
+int json_tok_skip(const json_tok_t *tokens, int count, int index);
+
+#endif // JSON_TOK_H
@@ -2,6 +2,7 @@
 #include "font/lv_symbol_def.h"
 #include "nvs_flash.h"
 #include "esp_log.h"
+#include "order_log.h"
 #include "esp_err.h"
 #include "lv_conf.h"  /* Include LVGL configuration first */
 #include "lvgl.h"
@@ -15,14 +16,26 @@
 #include "host/ble_gatt.h"
 #include "services/gap/ble_svc_gap.h"
 #include "services/gatt/ble_svc_gatt.h"
-#include "cJSON.h"
 /* #include "lv_font_mulan_14.c" */
 #include "../../managed_components/lvgl__lvgl/src/font/lv_font.h"
 #include "lv_font_device.c"
 #include "order_ui.h"
 #include "hex_utils.h"
 #include "utf8_validator.h"
+#include "order_ingest.h"
+#include "order_frame.h"
+#include "order_wire.h"
+#include "order_session.h"
+#include "order_journal.h"
+#include "dish_intern.h"
+#include "glyph_cache.h"
+#include "mmap_font.h"
+#include "ttf_fallback.h"
+#include "esp_heap_caps.h"
+#include "order_bench.h"
+#include "esp_timer.h"
 #include <stdlib.h>
+#include <string.h>
 
 // 菜品字体预渲染函数声明
 void init_dish_font_prerender(void);
@@ -37,11 +50,16 @@ void init_dish_font_prerender(void);
 
 static const char *TAG = "NimBLE_BLE_PRPH";
 
+// 订单模型：协议层写入，界面和出餐通知订阅
+static order_model_t *s_orders = NULL;
+
 // 全局字体文件系统句柄
 #if __has_include("esp_mmap_assets.h")
 static mmap_assets_handle_t font_asset_handle = NULL;
 static esp_lv_fs_handle_t fs_handle = NULL;
 lv_font_t *dish_font = NULL;
+static lv_font_t *dish_font_base = NULL;  // 字形缓存包装前的字体，清理时销毁
+static bool dish_font_mmap = false;       // dish_font_base由mmap_font创建
 lv_font_t *device_font = NULL;
 lv_font_t *info_font = NULL;
 #endif
@@ -91,7 +109,6 @@ static void create_order_ui(void)
 static ble_uuid16_t gatt_svc_uuid = BLE_UUID16_INIT(0xABCD);
 static ble_uuid16_t gatt_chr_uuid = BLE_UUID16_INIT(0x1234);
 static ble_uuid16_t gatt_notify_uuid = BLE_UUID16_INIT(0x5678);
-static uint16_t g_conn_handle = BLE_HS_CONN_HANDLE_NONE;
 static uint16_t g_notify_handle = 0;
 
 static int bleprph_gap_event(struct ble_gap_event *event, void *arg);
@@ -99,27 +116,6 @@ static void bleprph_advertise(void);
 static void bleprph_on_sync(void);
 static void bleprph_on_reset(int reason);
 static void bleprph_host_task(void *param);
-int send_notification(const char *json_str)
-{
-    if (g_conn_handle == BLE_HS_CONN_HANDLE_NONE || g_notify_handle == 0) {
-        return -1;
-    }
-
-    struct os_mbuf *om = ble_hs_mbuf_from_flat(json_str, strlen(json_str));
-    if (!om) {
-        return -1;
-    }
-
-    int rc = ble_gattc_notify_custom(g_conn_handle, g_notify_handle, om);
-    if (rc != 0) {
-        ESP_LOGE(TAG, "Failed to send notification: %d", rc);
-        os_mbuf_free_chain(om);
-        return rc;
-    }
-
-    return 0;
-}
-
 static int bleprph_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                              struct ble_gatt_access_ctxt *ctxt, void *arg);
 
@@ -131,7 +127,11 @@ static const struct ble_gatt_svc_def gatt_svcs[] = {
             {
                 .uuid = (ble_uuid_t *)&gatt_chr_uuid,
                 .access_cb = bleprph_chr_access,
+#if CONFIG_ORDER_LINK_HIGH_THROUGHPUT
+                .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_WRITE_NO_RSP | BLE_GATT_CHR_F_READ,
+#else
                 .flags = BLE_GATT_CHR_F_WRITE | BLE_GATT_CHR_F_READ,
+#endif
                 .val_handle = 0,
             },
             {
@@ -146,210 +146,262 @@ static const struct ble_gatt_svc_def gatt_svcs[] = {
     {0}
 };
 
-// 解码十六进制字符串到ASCII
-static char* decode_hex_content(const char* hex_content, char* buffer, size_t buffer_size) {
+// 解码十六进制内容到以'\0'结尾的缓冲区（同时校验十六进制和UTF-8，支持原地解码）
+static char* decode_hex_content(const char* hex_content, size_t hex_len, char* buffer, size_t buffer_size) {
     if (!hex_content || !buffer || buffer_size == 0) return NULL;
     
-    int hex_len = strlen(hex_content);
-    if (hex_len % 2 != 0 || !hex_is_valid(hex_content)) return NULL;
+    int decoded_len = utf8_hex_decode(hex_content, hex_len, (uint8_t *)buffer, buffer_size - 1);
+    if (decoded_len <= 0) return NULL;
     
-    int decoded_len = hex_to_ascii(hex_content, buffer, buffer_size);
-    return decoded_len > 0 ? buffer : NULL;
+    buffer[decoded_len] = '\0';
+    return buffer;
 }
 
-// 处理系统消息
-static void handle_system_message(cJSON* root) {
-    cJSON *content = cJSON_GetObjectItem(root, "content");
-    if (!content || !cJSON_IsString(content)) return;
+// 从订单ID生成订单号
+static int generate_order_number(const char* order_id) {
+    if (!order_id) return 1;
     
-    char *content_str = content->valuestring;
-    char decoded_content[256] = {0};
+    int len = strlen(order_id);
+    int order_num = 1;
     
-    // 尝试解码十六进制内容
-    if (decode_hex_content(content_str, decoded_content, sizeof(decoded_content))) {
-        ESP_LOGI(TAG, "解码系统消息: %s", decoded_content);
-        show_popup_message(decoded_content, 3000);
+    if (len > 4) {
+        order_num = atoi(order_id + len - 4);
     } else {
-        ESP_LOGI(TAG, "系统消息: %s", content_str);
-        show_popup_message(content_str, 3000);
+        order_num = atoi(order_id);
     }
+    
+    return order_num > 0 ? order_num : 1;
 }
 
-// 构建菜品字符串（性能优化版）- 减少内存分配和字符串操作
-static char* build_dishes_string(cJSON* items) {
-    if (!items || !cJSON_IsArray(items)) return NULL;
-    
-    // 预计算所需内存大小
-    size_t total_len = 1; // 终止符
-    int item_count = 0;
+// 复制字符串片段到以'\0'结尾的缓冲区（超长截断）
+static const char *order_str_copy(order_str_t str, char *buf, size_t buf_size)
+{
+    size_t len = str.len < buf_size - 1 ? str.len : buf_size - 1;
+    memcpy(buf, str.ptr, len);
+    buf[len] = '\0';
+    return buf;
+}
+
+// 取出字符串字段的文本：JSON中的十六进制先解码，失败则使用原文
+static const char *order_str_text(const order_msg_t *msg, order_str_t str, char *buf, size_t buf_size)
+{
+    if (msg->hex_encoded && decode_hex_content(str.ptr, str.len, buf, buf_size)) {
+        return buf;
+    }
+    return order_str_copy(str, buf, buf_size);
+}
+
+// 原地解码JSON中的十六进制菜品名（解码结果不长于原文），返回文本长度
+static uint16_t decode_item_in_place(const order_msg_t *msg, order_str_t item)
+{
+    // 字符串片段指向接收缓冲区，本身可写
+    char *text = (char *)item.ptr;
+    if (msg->hex_encoded && decode_hex_content(text, item.len, text, item.len + 1)) {
+        return item.len / 2;
+    }
+    return item.len;
+}
+
+// 被拒绝的订单消息数（只在接入工作任务中修改）
+static uint32_t s_rejected_msgs = 0;
+
+// 消息已在接入工作任务中异步处理，写入响应早已返回，通过通知告诉发送该消息的POS
+static void reject_order_msg(const order_msg_t *msg, const char *order_id, const char *err)
+{
+    s_rejected_msgs++;
+    if (order_session_rejected(msg->conn_handle, order_id, err) != ESP_OK) {
+        DLOGW(TAG, "拒绝通知未能入队: %s", err);
+    }
+}
+
+// 按消息类型更新订单UI
+static void apply_order_msg(const order_msg_t *msg)
+{
+    if (msg->type == ORDER_MSG_INFO) {
+        char content[256];
+        order_str_text(msg, msg->content, content, sizeof(content));
+        DLOGI(TAG, "系统消息: %s", content);
+        show_popup_message(content, 3000);
+        return;
+    }
     
-    cJSON *item = NULL;
-    cJSON_ArrayForEach(item, items) {
-        cJSON *name = cJSON_GetObjectItem(item, "name");
-        if (!cJSON_IsString(name)) continue;
-        
-        char *name_str = name->valuestring;
-        char decoded_name[128] = {0};
-        
-        // 尝试解码十六进制菜品名
-        if (decode_hex_content(name_str, decoded_name, sizeof(decoded_name))) {
-            name_str = decoded_name;
-        }
-        
-        total_len += strlen(name_str);
-        if (item_count > 0) total_len += 3; // "、"
-        item_count++;
+    // 超出订单表限制的消息整条拒绝，不截断后再显示
+    char order_id[ORDER_STORE_ID_MAX + 1];
+    if (msg->order_id.len > ORDER_STORE_ID_MAX) {
+        DLOGW(TAG, "订单ID过长 (%u 字节，最多 %d)，拒绝", msg->order_id.len, ORDER_STORE_ID_MAX);
+        reject_order_msg(msg, NULL, "orderId");
+        return;
     }
+    order_str_copy(msg->order_id, order_id, sizeof(order_id));
+    DLOGI(TAG, "处理订单: type=%d, orderId=%s", msg->type, order_id);
     
-    if (item_count == 0) return NULL;
+    if (msg->type != ORDER_MSG_REMOVE && msg->item_total > ORDER_MSG_MAX_ITEMS) {
+        DLOGW(TAG, "订单 %s 有 %u 个菜品 (最多 %d)，拒绝", order_id, msg->item_total, ORDER_MSG_MAX_ITEMS);
+        reject_order_msg(msg, order_id, "items");
+        return;
+    }
     
-    // 一次性分配足够内存
-    char *dishes_str = malloc(total_len);
-    if (!dishes_str) return NULL;
+    if (msg->type == ORDER_MSG_REMOVE) {
+        if (order_model_remove(s_orders, order_id) != ESP_OK) {
+            DLOGW(TAG, "订单ID %s 不存在，无法删除", order_id);
+            return;
+        }
+        show_order_popup(ORDER_POPUP_REMOVED);
+        return;
+    }
     
-    dishes_str[0] = '\0';
-    size_t current_pos = 0;
-    item_count = 0;
+    // 一次性填充结构化订单，UI层直接使用
+    dish_t dishes[ORDER_MSG_MAX_ITEMS];
+    for (uint16_t i = 0; i < msg->item_count; i++) {
+        dishes[i].name = msg->items[i].ptr;
+        dishes[i].name_len = decode_item_in_place(msg, msg->items[i]);
+    }
     
-    cJSON_ArrayForEach(item, items) {
-        cJSON *name = cJSON_GetObjectItem(item, "name");
-        if (!cJSON_IsString(name)) continue;
-        
-        char *name_str = name->valuestring;
-        char decoded_name[128] = {0};
-        
-        if (decode_hex_content(name_str, decoded_name, sizeof(decoded_name))) {
-            name_str = decoded_name;
+    order_t order = {
+        .order_id = order_id,
+        .order_num = generate_order_number(order_id),
+        .dish_count = msg->item_count,
+        .dishes = dishes,
+    };
+    esp_err_t err;
+    if (msg->type == ORDER_MSG_ADD) {
+        err = order_model_add(s_orders, &order);
+        if (err == ESP_OK) {
+            show_order_popup(ORDER_POPUP_ADDED);
         }
-        
-        size_t name_len = strlen(name_str);
-        
-        if (item_count > 0) {
-            memcpy(dishes_str + current_pos, "、", 3);
-            current_pos += 3;
+    } else {
+        err = order_model_update(s_orders, &order);
+        if (err == ESP_OK) {
+            show_order_popup(ORDER_POPUP_UPDATED);
         }
-        
-        memcpy(dishes_str + current_pos, name_str, name_len);
-        current_pos += name_len;
-        item_count++;
     }
-    
-    dishes_str[current_pos] = '\0';
-    return dishes_str;
+    if (err != ESP_OK) {
+        DLOGW(TAG, "订单 %s 未能保存: %s", order_id, esp_err_to_name(err));
+    }
 }
 
-// 从订单ID生成订单号
-static int generate_order_number(const char* order_id) {
-    if (!order_id) return 1;
+// 处理缺少type字段的非标准消息：只提取content显示
+static void process_legacy_content(char *msg)
+{
+    char *content_start = strstr(msg, "content");
+    if (!content_start) return;
     
-    int len = strlen(order_id);
-    int order_num = 1;
+    char *quote_start = strchr(content_start, '"');
+    if (!quote_start) return;
     
-    if (len > 4) {
-        order_num = atoi(order_id + len - 4);
+    char *quote_end = strchr(quote_start + 1, '"');
+    if (!quote_end) return;
+    
+    *quote_end = '\0';
+    char *hex_content = quote_start + 1;
+    
+    char decoded_content[256] = {0};
+    if (decode_hex_content(hex_content, quote_end - hex_content, decoded_content, sizeof(decoded_content))) {
+        DLOGW(TAG, "解码内容: %s", decoded_content);
+        show_popup_message(decoded_content, 3000);
+    }
+    *quote_end = '"';
+}
+
+#if CONFIG_ORDER_CAPTURE
+// 以十六进制整条输出原始消息，供tools/host中的基准回放（不经过延迟日志，避免截断）
+static void capture_order_message(const char *msg, size_t len)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    char *hex = malloc(len * 2 + 1);
+    if (!hex) return;
+    for (size_t i = 0; i < len; i++) {
+        hex[i * 2] = digits[(uint8_t)msg[i] >> 4];
+        hex[i * 2 + 1] = digits[(uint8_t)msg[i] & 0x0F];
+    }
+    hex[len * 2] = '\0';
+    ESP_LOGI("OrderCapture", "%s", hex);
+    free(hex);
+}
+#endif
+
+// 处理一条完整的订单消息（在接入工作任务中调用，调用时已持有显示锁）
+static void process_order_message(char *msg, size_t len, uint16_t conn_handle)
+{
+    order_msg_t order_msg;
+
+#if CONFIG_ORDER_CAPTURE
+    capture_order_message(msg, len);
+#endif
+
+    if (order_wire_is_binary((const uint8_t *)msg, len)) {
+        if (!order_wire_decode((const uint8_t *)msg, len, &order_msg)) {
+            DLOGE(TAG, "二进制订单消息格式错误 (%u 字节)", (unsigned)len);
+            return;
+        }
     } else {
-        order_num = atoi(order_id);
+        DLOGI(TAG, "收到蓝牙JSON信息: %s", msg);
+        if (!order_wire_decode_json(msg, len, &order_msg)) {
+            process_legacy_content(msg);
+            return;
+        }
     }
     
-    return order_num > 0 ? order_num : 1;
+    order_msg.conn_handle = conn_handle;
+    apply_order_msg(&order_msg);
+}
+
+#if CONFIG_ORDER_JOURNAL
+// 模型的所有变更都在显示锁内进行，日志写快照时同样持有显示锁
+static void orders_lock(void)
+{
+    bsp_display_lock(portMAX_DELAY);
+}
+
+static void orders_unlock(void)
+{
+    bsp_display_unlock();
+}
+#endif
+
+// 已出餐的订单放入通知队列，由蓝牙主机任务发送
+static void on_order_event(order_model_event_t event, order_rec_t *rec, void *arg)
+{
+    if (event == ORDER_MODEL_SERVED) {
+        order_session_served(rec->order_id);
+        DLOGI(TAG, "出餐通知已入队: %s", rec->order_id);
+    }
+}
+
+// 重组完成的消息直接以池缓冲区交给接入队列
+static esp_err_t deliver_to_ingest(char *msg, size_t len, uint16_t conn_handle)
+{
+    return order_ingest_submit(msg, len, conn_handle, order_frame_buf_release);
 }
 
-// 蓝牙数据处理优化 - 减少JSON解析开销
+// 蓝牙数据接收 - 只做分片重组和入队，解析和UI更新交给接入工作任务
 static int bleprph_chr_access(uint16_t conn_handle, uint16_t attr_handle,
                              struct ble_gatt_access_ctxt *ctxt, void *arg)
 {
     switch (ctxt->op) {
     case BLE_GATT_ACCESS_OP_WRITE_CHR: {
-        uint8_t buf[512];
-        uint16_t out_len = 0;
-        int rc = ble_hs_mbuf_to_flat(ctxt->om, buf, sizeof(buf), &out_len);
-        if (rc != 0) {
-            ESP_LOGE(TAG, "ble_hs_mbuf_to_flat failed: %d", rc);
+        order_session_t *session = order_session_find(conn_handle);
+        if (!session) {
             return BLE_ATT_ERR_UNLIKELY;
         }
-        
-        buf[out_len < sizeof(buf) ? out_len : sizeof(buf) - 1] = '\0';
-        ESP_LOGI(TAG, "收到蓝牙JSON信息: %s", (char *)buf);
-        
-        // 快速检查消息类型，避免不必要的JSON解析
-        const char *type_start = strstr((char *)buf, "\"type\"");
-        if (!type_start) {
-            // 尝试处理非标准JSON格式
-            char *content_start = strstr((char *)buf, "content");
-            if (content_start) {
-                char *quote_start = strchr(content_start, '"');
-                if (quote_start) {
-                    char *quote_end = strchr(quote_start + 1, '"');
-                    if (quote_end) {
-                        *quote_end = '\0';
-                        char *hex_content = quote_start + 1;
-                        
-                        char decoded_content[256] = {0};
-                        if (decode_hex_content(hex_content, decoded_content, sizeof(decoded_content))) {
-                            ESP_LOGW(TAG, "解码内容: %s", decoded_content);
-                            show_popup_message(decoded_content, 3000);
-                        }
-                        *quote_end = '"';
-                    }
-                }
-            }
-            return BLE_ATT_ERR_UNLIKELY;
-        }
-
-        cJSON *root = cJSON_Parse((char *)buf);
-        if (!root) {
-            return BLE_ATT_ERR_UNLIKELY;
-        }
-
-        // 检查操作类型
-        cJSON *type = cJSON_GetObjectItem(root, "type");
-        if (type && cJSON_IsString(type)) {
-            const char *type_str = type->valuestring;
-            
-            if (strcmp(type_str, "info") == 0) {
-                handle_system_message(root);
-            } else if (strcmp(type_str, "add") == 0 || strcmp(type_str, "update") == 0 || strcmp(type_str, "remove") == 0) {
-                bsp_display_lock(portMAX_DELAY);
-                
-                cJSON *id = cJSON_GetObjectItem(root, "orderId");
-                if (!id || !cJSON_IsString(id)) {
-                    ESP_LOGE(TAG, "无效的订单ID");
-                    bsp_display_unlock();
-                    cJSON_Delete(root);
-                    return 0;
-                }
-                
-                char *order_id = id->valuestring;
-                ESP_LOGI(TAG, "处理订单: type=%s, orderId=%s", type_str, order_id);
-                
-                if (strcmp(type_str, "remove") == 0) {
-                    remove_order_by_id(order_id);
-                    show_popup_message("订单已删除", 2000);
-                } else {
-                    char *dishes_str = build_dishes_string(cJSON_GetObjectItem(root, "items"));
-                    int order_num = generate_order_number(order_id);
-                    
-                    if (strcmp(type_str, "add") == 0) {
-                        create_dynamic_order_row_with_id(order_id, order_num, dishes_str ? dishes_str : "无菜品");
-                        show_popup_message("订单已添加", 2000);
-                    } else {
-                        update_order_by_id(order_id, order_num, dishes_str ? dishes_str : "无菜品");
-                        show_popup_message("订单已更新", 2000);
-                    }
-                    
-                    if (dishes_str) free(dishes_str);
-                }
-                
-                bsp_display_unlock();
-            }
+        int rc = order_session_receive(session, ctxt->om);
+        if (rc != 0) {
+            DLOGW(TAG, "订单写入被拒绝: %d", rc);
         }
-
-        cJSON_Delete(root);
-        return 0;
+        return rc;
     }
     case BLE_GATT_ACCESS_OP_READ_CHR: {
-        const char *resp = "OK";
-        int rc = os_mbuf_append(ctxt->om, resp, strlen(resp));
+        // 能力协商：以"OK"开头兼容旧版POS，新版POS据此选择二进制格式、分片大小和是否使用无响应写入
+        char resp[80];
+        int resp_len = snprintf(resp, sizeof(resp), "OK;v=%d;fmt=json,bin;mtu=%u;max=%d%s",
+                                ORDER_WIRE_VERSION, ble_att_mtu(conn_handle), CONFIG_ORDER_FRAME_MAX_LEN,
+#if CONFIG_ORDER_LINK_HIGH_THROUGHPUT
+                                ";wnr=1;ack=1"
+#else
+                                ""
+#endif
+                                );
+        int rc = os_mbuf_append(ctxt->om, resp, resp_len);
         return rc == 0 ? 0 : BLE_ATT_ERR_INSUFFICIENT_RES;
     }
     default:
@@ -363,22 +415,62 @@ static int bleprph_gap_event(struct ble_gap_event *event, void *arg)
     switch (event->type) {
     case BLE_GAP_EVENT_CONNECT:
         if (event->connect.status == 0) {
-            g_conn_handle = event->connect.conn_handle;
-            ESP_LOGI(TAG, "Connected, handle=%d", event->connect.conn_handle);
+            DLOGI(TAG, "Connected, handle=%d", event->connect.conn_handle);
+            if (!order_session_open(event->connect.conn_handle, g_notify_handle)) {
+                ble_gap_terminate(event->connect.conn_handle, BLE_ERR_REM_USER_CONN_TERM);
+                return 0;
+            }
         } else {
-            ESP_LOGI(TAG, "Connect failed; status=%d", event->connect.status);
+            DLOGI(TAG, "Connect failed; status=%d", event->connect.status);
+        }
+        // 还有空闲会话时继续广播，允许其他POS同时连接
+        if (order_session_count() < ORDER_SESSION_MAX) {
             bleprph_advertise();
         }
         return 0;
 
     case BLE_GAP_EVENT_DISCONNECT:
-        g_conn_handle = BLE_HS_CONN_HANDLE_NONE;
-        ESP_LOGI(TAG, "Disconnected; reason=%d", event->disconnect.reason);
+        order_session_close(event->disconnect.conn.conn_handle);
+        DLOGI(TAG, "Disconnected; handle=%d reason=%d",
+                 event->disconnect.conn.conn_handle, event->disconnect.reason);
         bleprph_advertise();
         return 0;
 
+    case BLE_GAP_EVENT_SUBSCRIBE:
+        if (event->subscribe.attr_handle == g_notify_handle) {
+            DLOGI(TAG, "Subscribe; handle=%d notify=%d",
+                     event->subscribe.conn_handle, event->subscribe.cur_notify);
+            order_session_set_subscribed(event->subscribe.conn_handle, event->subscribe.cur_notify);
+        }
+        return 0;
+
+    case BLE_GAP_EVENT_MTU:
+        DLOGI(TAG, "MTU updated; handle=%d mtu=%d",
+                 event->mtu.conn_handle, event->mtu.value);
+        return 0;
+
+    case BLE_GAP_EVENT_CONN_UPDATE:
+        order_session_on_conn_update(event->conn_update.conn_handle);
+        return 0;
+
+    case BLE_GAP_EVENT_DATA_LEN_CHG:
+        DLOGI(TAG, "Data length changed; handle=%d tx=%d rx=%d",
+                 event->data_len_chg.conn_handle, event->data_len_chg.max_tx_octets,
+                 event->data_len_chg.max_rx_octets);
+        return 0;
+
+    case BLE_GAP_EVENT_PHY_UPDATE_COMPLETE:
+        DLOGI(TAG, "PHY updated; handle=%d status=%d tx=%d rx=%d",
+                 event->phy_updated.conn_handle, event->phy_updated.status,
+                 event->phy_updated.tx_phy, event->phy_updated.rx_phy);
+        return 0;
+
+    case BLE_GAP_EVENT_NOTIFY_TX:
+        order_session_on_notify_tx(event);
+        return 0;
+
     case BLE_GAP_EVENT_ADV_COMPLETE:
-        ESP_LOGI(TAG, "Advertising complete");
+        DLOGI(TAG, "Advertising complete");
         bleprph_advertise();
         return 0;
 
@@ -397,10 +489,14 @@ static void bleprph_advertise(void)
     int rc;
     uint8_t own_addr_type;
 
+    if (ble_gap_adv_active()) {
+        return;
+    }
+
     ble_hs_util_ensure_addr(0);
     rc = ble_hs_id_infer_auto(0, &own_addr_type);
     if (rc != 0) {
-        ESP_LOGE(TAG, "infer addr type failed; rc=%d", rc);
+        DLOGE(TAG, "infer addr type failed; rc=%d", rc);
         return;
     }
 
@@ -420,12 +516,12 @@ static void bleprph_advertise(void)
 
     rc = ble_gap_adv_set_fields(&fields);
     if (rc != 0) {
-        ESP_LOGE(TAG, "adv set fields failed; rc=%d", rc);
+        DLOGE(TAG, "adv set fields failed; rc=%d", rc);
         return;
     }
     rc = ble_gap_adv_rsp_set_fields(&rsp_fields);
     if (rc != 0) {
-        ESP_LOGE(TAG, "adv rsp set fields failed; rc=%d", rc);
+        DLOGE(TAG, "adv rsp set fields failed; rc=%d", rc);
         return;
     }
 
@@ -435,10 +531,10 @@ static void bleprph_advertise(void)
     rc = ble_gap_adv_start(own_addr_type, NULL, BLE_HS_FOREVER,
                            &adv_params, bleprph_gap_event, NULL);
     if (rc != 0) {
-        ESP_LOGE(TAG, "adv start failed; rc=%d", rc);
+        DLOGE(TAG, "adv start failed; rc=%d", rc);
         return;
     }
-    ESP_LOGI(TAG, "Advertising started: %s", name);
+    DLOGI(TAG, "Advertising started: %s", name);
 }
 
 /* 蓝牙同步回调 */
@@ -448,10 +544,14 @@ static void bleprph_on_sync(void)
     uint8_t addr_val[6];
     int rc;
 
+    if (ble_gap_adv_active()) {
+        return;
+    }
+
     ble_hs_util_ensure_addr(0);
     rc = ble_hs_id_infer_auto(0, &own_addr_type);
     if (rc == 0 && ble_hs_id_copy_addr(own_addr_type, addr_val, NULL) == 0) {
-        ESP_LOGI(TAG, "Device Address: %02x:%02x:%02x:%02x:%02x:%02x",
+        DLOGI(TAG, "Device Address: %02x:%02x:%02x:%02x:%02x:%02x",
                  addr_val[5], addr_val[4], addr_val[3],
                  addr_val[2], addr_val[1], addr_val[0]);
     }
@@ -462,13 +562,13 @@ static void bleprph_on_sync(void)
 /* 蓝牙重置回调 */
 static void bleprph_on_reset(int reason)
 {
-    ESP_LOGE(TAG, "Resetting state; reason=%d", reason);
+    DLOGE(TAG, "Resetting state; reason=%d", reason);
 }
 
 /* 蓝牙主机任务 */
 static void bleprph_host_task(void *param)
 {
-    ESP_LOGI(TAG, "BLE Host Task Started");
+    DLOGI(TAG, "BLE Host Task Started");
     nimble_port_run();
     nimble_port_freertos_deinit();
 }
@@ -489,7 +589,7 @@ static esp_err_t init_font_filesystem(void)
     
     esp_err_t ret = mmap_assets_new(&config, &font_asset_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize font assets: %d", ret);
+        DLOGE(TAG, "Failed to initialize font assets: %d", ret);
         return ret;
     }
     
@@ -502,7 +602,7 @@ static esp_err_t init_font_filesystem(void)
     
     ret = esp_lv_fs_desc_init(&fs_cfg, &fs_handle);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize LVGL filesystem: %d", ret);
+        DLOGE(TAG, "Failed to initialize LVGL filesystem: %d", ret);
         return ret;
     }
     
@@ -517,7 +617,7 @@ static esp_err_t load_device_font(void)
 {
     // 使用内置的设备字体
     device_font = &lv_font_device;
-    ESP_LOGI(TAG, "Device font set to built-in lv_font_device");
+    DLOGI(TAG, "Device font set to built-in lv_font_device");
     return ESP_OK;
 }
 
@@ -525,34 +625,151 @@ static esp_err_t load_info_font(void)
 {
     // 使用内置的设备字体
     info_font = &lv_font_device;
-    ESP_LOGI(TAG, "Info font set to built-in lv_font_device");
+    DLOGI(TAG, "Info font set to built-in lv_font_device");
     return ESP_OK;
 }
 
+#if __has_include("esp_mmap_assets.h")
+// 字体加载占用的内存：系统堆（含PSRAM）和LVGL内置堆
+static size_t font_heap_used(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size + heap_caps_get_total_size(MALLOC_CAP_8BIT) -
+           heap_caps_get_free_size(MALLOC_CAP_8BIT);
+}
+
+// 直接读取映射的字体分区，不拷贝字体数据
+static lv_font_t *load_dish_font_mmap(void)
+{
+    const uint8_t *data = mmap_assets_get_mem(font_asset_handle, MMAP_FONTS_LV_FONT_DISHES_BIN);
+    int size = mmap_assets_get_size(font_asset_handle, MMAP_FONTS_LV_FONT_DISHES_BIN);
+    if (!data || size <= 0) {
+        return NULL;
+    }
+    return mmap_font_create(data, (size_t)size);
+}
+
+// 加载菜品字体并记录耗时和常驻内存
+static lv_font_t *load_dish_font_measured(bool mmap)
+{
+    size_t heap_before = font_heap_used();
+    int64_t start = esp_timer_get_time();
+    lv_font_t *font = mmap ? load_dish_font_mmap() : lv_binfont_create("F:lv_font_dishes.bin");
+    int64_t elapsed = esp_timer_get_time() - start;
+    size_t heap_after = font_heap_used();
+
+    if (font) {
+        DLOGI(TAG, "Dish font loaded via %s in %lld us, resident %d bytes",
+              mmap ? "mmap" : "lv_binfont", elapsed, (int)(heap_after - heap_before));
+    }
+    return font;
+}
+
+static void destroy_dish_font(lv_font_t *font, bool mmap)
+{
+    if (mmap) {
+        mmap_font_destroy(font);
+    } else {
+        lv_binfont_destroy(font);
+    }
+}
+#endif
+
 static esp_err_t load_dish_font(void)
 {
 #if __has_include("esp_mmap_assets.h")
-    dish_font = lv_binfont_create("F:lv_font_dishes.bin");
-    if (!dish_font) {
-        ESP_LOGE(TAG, "Failed to load dish font from lv_font_dishes.bin");
+    lv_font_t *font = NULL;
+#if CONFIG_ORDER_DISH_FONT_MMAP
+    font = load_dish_font_measured(true);
+    dish_font_mmap = font != NULL;
+    if (!font) {
+        DLOGW(TAG, "Mapped dish font unavailable, falling back to lv_binfont");
+    }
+#if CONFIG_ORDER_BENCH
+    // 性能测试时再用lv_binfont加载一次作对比
+    if (font) {
+        lv_font_t *copy = load_dish_font_measured(false);
+        if (copy) destroy_dish_font(copy, false);
+    }
+#endif
+#endif
+    if (!font) {
+        font = load_dish_font_measured(false);
+    }
+    if (!font) {
+        DLOGE(TAG, "Failed to load dish font from lv_font_dishes.bin");
         // 设置fallback字体
         dish_font = &lv_font_device;
-        ESP_LOGW(TAG, "Using fallback font for dish names");
+        DLOGW(TAG, "Using fallback font for dish names");
         return ESP_OK; // 返回成功，因为fallback字体已设置
     }
-    ESP_LOGI(TAG, "Dish font loaded successfully from lv_font_dishes.bin");
+    dish_font = font;
+    DLOGI(TAG, "Dish font loaded successfully from lv_font_dishes.bin");
     return ESP_OK;
 #else
-    ESP_LOGW(TAG, "Font loading not available");
+    DLOGW(TAG, "Font loading not available");
     // 设置fallback字体
     dish_font = &lv_font_device;
     return ESP_OK; // 返回成功，因为fallback字体已设置
 #endif
 }
 
+#if __has_include("esp_mmap_assets.h") && CONFIG_ORDER_TTF_FALLBACK
+// 菜品字体缺字时由font分区中的TTF光栅化（直接读取映射的数据）
+static void attach_ttf_fallback(void)
+{
+    if (dish_font == &lv_font_device) {
+        return;
+    }
+    int count = mmap_assets_get_stored_files(font_asset_handle);
+    for (int i = 0; i < count; i++) {
+        const char *name = mmap_assets_get_name(font_asset_handle, i);
+        if (!name || strcmp(name, CONFIG_ORDER_TTF_FALLBACK_FILE) != 0) {
+            continue;
+        }
+        lv_font_t *fallback = ttf_fallback_create(mmap_assets_get_mem(font_asset_handle, i),
+                                                  mmap_assets_get_size(font_asset_handle, i),
+                                                  CONFIG_ORDER_TTF_FALLBACK_SIZE);
+        if (fallback) {
+            bsp_display_lock(portMAX_DELAY);
+            dish_font->fallback = fallback;
+            bsp_display_unlock();
+        }
+        return;
+    }
+    DLOGI(TAG, "No %s in font partition, dish font has no TTF fallback", CONFIG_ORDER_TTF_FALLBACK_FILE);
+}
+#endif
+
 // 字体加载任务函数
 static void font_load_task_func(void *pvParameters) {
     load_dish_font();
+    bsp_display_lock(portMAX_DELAY);
+    order_ui_sync_dish_font();
+    bsp_display_unlock();
+
+#if __has_include("esp_mmap_assets.h")
+    dish_font_base = dish_font;
+#if CONFIG_ORDER_GLYPH_CACHE
+    // binfont的字形每次绘制都要解压，包装字形缓存后在后台预热
+    if (dish_font != &lv_font_device) {
+        lv_font_t *cached = glyph_cache_create(dish_font);
+        if (cached) {
+            bsp_display_lock(portMAX_DELAY);
+            dish_font = cached;
+            order_ui_sync_dish_font();
+            bsp_display_unlock();
+            init_dish_font_prerender();
+        } else {
+            DLOGW(TAG, "Glyph cache unavailable, dish font used directly");
+        }
+    }
+#endif
+#if CONFIG_ORDER_TTF_FALLBACK
+    attach_ttf_fallback();
+#endif
+#endif
     vTaskDelete(NULL);
 }
 
@@ -560,16 +777,60 @@ static void font_load_task_func(void *pvParameters) {
 void cleanup_font_cache(void) {
     // 清理LVGL字体缓存
 #if __has_include("esp_mmap_assets.h")
-    if (dish_font && dish_font != &lv_font_device) {
-        lv_binfont_destroy(dish_font);
+    if (dish_font_base && dish_font_base != &lv_font_device) {
+        destroy_dish_font(dish_font_base, dish_font_mmap);
+        dish_font_base = NULL;
         dish_font = NULL;
     }
     // device_font 和 info_font 现在使用内置字体，不需要清理
 #endif
 }
 
+#if CONFIG_ORDER_STATS_INTERVAL_MS > 0
+// 周期打印运行统计
+static void stats_timer_cb(void *arg)
+{
+    order_ingest_log_stats();
+    order_frame_log_stats();
+    order_session_log_stats();
+    order_link_log_stats();
+#if CONFIG_ORDER_JOURNAL
+    order_journal_log_stats();
+#endif
+
+    order_model_stats_t model;
+    order_store_stats_t store;
+    order_model_get_stats(s_orders, &model, &store);
+    DLOGI(TAG, "订单: 当前 %u/%u (峰值 %u), 添加 %lu, 更新 %lu, 出餐 %lu, 删除 %lu, 未找到 %lu, 失败 %lu, 拒绝 %lu, 最长探测 %lu, 菜品截断 %u",
+          store.count, store.capacity, store.peak, model.added, model.updated, model.served, model.removed,
+          model.not_found, model.failed, s_rejected_msgs, store.probe_max, store.dish_truncated);
+    dish_intern_log_stats();
+#if CONFIG_ORDER_GLYPH_CACHE
+    glyph_cache_log_stats();
+#endif
+#if CONFIG_ORDER_TTF_FALLBACK
+    ttf_fallback_log_stats();
+#endif
+    order_ui_log_stats();
+}
+
+static void start_stats_timer(void)
+{
+    const esp_timer_create_args_t args = {
+        .callback = stats_timer_cb,
+        .name = "stats",
+    };
+    esp_timer_handle_t timer = NULL;
+    if (esp_timer_create(&args, &timer) == ESP_OK) {
+        esp_timer_start_periodic(timer, (uint64_t)CONFIG_ORDER_STATS_INTERVAL_MS * 1000);
+    }
+}
+#endif
+
 void app_main(void)
 {
+    int rc;
+
     // 初始化NVS
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -577,39 +838,82 @@ void app_main(void)
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+
+#if CONFIG_ORDER_LOG_DEFERRED
+    // 延迟日志尽早启动，之后的热路径日志不再直接阻塞在控制台输出上
+    if (order_log_init() != ESP_OK) {
+        ESP_LOGW(TAG, "延迟日志初始化失败，日志将直接输出");
+    }
+#endif
     
     // 注册清理函数，确保程序退出时清理缓存
     atexit(cleanup_font_cache);
 
-    // 初始化菜品字体预渲染（异步执行，不阻塞主线程）
-    init_dish_font_prerender();
+    // 订单模型和接入队列需在蓝牙开始接收数据前就绪
+    s_orders = order_model_create(CONFIG_ORDER_STORE_CAPACITY);
+    if (!s_orders) {
+        DLOGE(TAG, "order_model_create failed");
+        return;
+    }
+#if CONFIG_ORDER_JOURNAL
+    // 先回放日志恢复重启前的订单，界面创建时会为这些订单补建订单行
+    const order_journal_config_t journal_cfg = {
+        .partition_label = "storage",
+        .model = s_orders,
+        .lock = orders_lock,
+        .unlock = orders_unlock,
+    };
+    ret = order_journal_init(&journal_cfg);
+    if (ret != ESP_OK) {
+        DLOGW(TAG, "订单日志不可用，重启后订单不会恢复: %s", esp_err_to_name(ret));
+    }
+#endif
+    order_model_subscribe(s_orders, on_order_event, NULL);
+
+    ret = order_ingest_init(process_order_message);
+    if (ret != ESP_OK) {
+        DLOGE(TAG, "order_ingest_init failed: %d", ret);
+        return;
+    }
+    ret = order_frame_pool_init();
+    if (ret != ESP_OK) {
+        DLOGE(TAG, "order_frame_pool_init failed: %d", ret);
+        return;
+    }
 
     // 初始化蓝牙
     ret = nimble_port_init();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "nimble_port_init failed: %d", ret);
+        DLOGE(TAG, "nimble_port_init failed: %d", ret);
         return;
     }
+    order_session_init(deliver_to_ingest);
 
     ble_svc_gap_init();
     ble_svc_gatt_init();
 
+    // 请求最大ATT MTU，分片大小随协商结果增大
+    rc = ble_att_set_preferred_mtu(BLE_ATT_MTU_MAX);
+    if (rc != 0) {
+        DLOGE(TAG, "set preferred mtu failed; rc=%d", rc);
+    }
+
     ble_hs_cfg.reset_cb = bleprph_on_reset;
     ble_hs_cfg.sync_cb = bleprph_on_sync;
 
-    int rc = ble_svc_gap_device_name_set("MuLan");
+    rc = ble_svc_gap_device_name_set("MuLan");
     if (rc != 0) {
-        ESP_LOGE(TAG, "set device name failed; rc=%d", rc);
+        DLOGE(TAG, "set device name failed; rc=%d", rc);
     }
 
     rc = ble_gatts_count_cfg(gatt_svcs);
     if (rc != 0) {
-        ESP_LOGE(TAG, "ble_gatts_count_cfg failed; rc=%d", rc);
+        DLOGE(TAG, "ble_gatts_count_cfg failed; rc=%d", rc);
         return;
     }
     rc = ble_gatts_add_svcs(gatt_svcs);
     if (rc != 0) {
-        ESP_LOGE(TAG, "ble_gatts_add_svcs failed; rc=%d", rc);
+        DLOGE(TAG, "ble_gatts_add_svcs failed; rc=%d", rc);
         return;
     }
 
@@ -658,6 +962,14 @@ void app_main(void)
     
     // 最小化显示锁定时间
     bsp_display_lock(portMAX_DELAY);
-    order_ui_init(lv_scr_act());
+    order_ui_init(lv_scr_act(), s_orders);
     bsp_display_unlock();
+
+#if CONFIG_ORDER_STATS_INTERVAL_MS > 0
+    start_stats_timer();
+#endif
+
+#if CONFIG_ORDER_BENCH
+    order_bench_run();
+#endif
 }
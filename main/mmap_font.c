@@ -0,0 +1,584 @@
+/**
+ * @file mmap_font.c
+ * @brief 直接读取内存映射分区的binfont字体
+ *
+ * 文件格式与lv_binfont_loader相同：head、cmap、loca、glyf、kern（可选）依次排列，
+ * 每个表以长度和4字节标签开头。字形描述按位打包在glyf表中每个字形的开头，
+ * 位图紧随其后（不按字节对齐），这里按位直接读取，不做拷贝。
+ */
+
+#include "mmap_font.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "order_log.h"
+
+static const char *TAG = "MmapFont";
+
+#define TABLE_HEADER_SIZE   8           // 长度 + 标签
+#define HEAD_SIZE           40          // head表内容
+#define CMAP_RECORD_SIZE    16
+
+// head表字段偏移
+#define HEAD_TABLES         4
+#define HEAD_ASCENT         8
+#define HEAD_DESCENT        10
+#define HEAD_DEFAULT_ADV    22
+#define HEAD_KERN_SCALE     24
+#define HEAD_LOCA_FORMAT    26
+#define HEAD_GID_FORMAT     27
+#define HEAD_ADV_FORMAT     28
+#define HEAD_BPP            29
+#define HEAD_XY_BITS        30
+#define HEAD_WH_BITS        31
+#define HEAD_ADV_BITS       32
+#define HEAD_COMPRESSION    33
+#define HEAD_SUBPX          34
+#define HEAD_UNDERLINE_POS  36
+#define HEAD_UNDERLINE_TH   38
+
+// cmap子表格式，与lv_font_fmt_txt_cmap_type_t一致
+enum {
+    CMAP_FORMAT0_FULL,
+    CMAP_SPARSE_FULL,
+    CMAP_FORMAT0_TINY,
+    CMAP_SPARSE_TINY,
+};
+
+// 位图格式，与lv_font_fmt_txt_bitmap_format_t一致
+enum {
+    BITMAP_PLAIN,
+    BITMAP_COMPRESSED,
+    BITMAP_COMPRESSED_NO_PREFILTER,
+};
+
+typedef struct {
+    lv_font_t font;                     // 须为第一个成员
+    const uint8_t *cmap;                // cmap表（含表头），子表数据的偏移相对于此
+    const uint8_t *cmap_records;
+    const uint8_t *loca;                // loca偏移数组
+    const uint8_t *glyf;                // glyf表（含表头），loca偏移相对于此
+    uint32_t glyf_size;
+    uint32_t cmap_count;
+    uint32_t glyph_count;
+    uint16_t default_adv;
+    uint16_t kern_scale;
+    uint8_t loca_32;                    // loca偏移为32位
+    uint8_t bpp;
+    uint8_t xy_bits;
+    uint8_t wh_bits;
+    uint8_t adv_bits;
+    uint8_t adv_fixed;                  // 字宽为12.4定点数
+    uint8_t compression;
+    // 字距调整（kern表）
+    uint8_t kern_format;                // 0: 字形对, 3: 字形分类
+    uint8_t kern_gid16;                 // 字形对中的字形序号为16位
+    uint8_t kern_rows;
+    uint8_t kern_cols;
+    uint32_t kern_count;                // 字形对数量 / 分类映射长度
+    const uint8_t *kern_ids;
+    const uint8_t *kern_left;
+    const uint8_t *kern_right;
+    const int8_t *kern_values;
+} mmap_font_t;
+
+// 字形描述（字宽为1/16像素）
+typedef struct {
+    uint32_t adv_w;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint16_t box_w;
+    uint16_t box_h;
+    uint32_t bitmap_bit;                // 位图在glyf表中的起始位
+    uint32_t end_bit;
+} glyph_info_t;
+
+static const uint8_t opa2_table[4] = {0, 85, 170, 255};
+static const uint8_t opa3_table[8] = {0, 36, 73, 109, 146, 182, 218, 255};
+static const uint8_t opa4_table[16] = {
+    0, 17, 34, 51, 68, 85, 102, 119, 136, 153, 170, 187, 204, 221, 238, 255
+};
+
+// 映射的数据不保证对齐，按小端逐字节读取
+static inline uint16_t rd16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t rd32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 从高位开始按位读取，n不超过16
+static inline uint32_t read_bits(const uint8_t *base, uint32_t *bit, uint8_t n)
+{
+    uint32_t value = 0;
+    uint32_t pos = *bit;
+    while (n) {
+        uint8_t avail = 8 - (pos & 7);
+        uint8_t take = n < avail ? n : avail;
+        uint8_t byte = base[pos >> 3];
+        value = (value << take) | ((byte >> (avail - take)) & ((1u << take) - 1));
+        pos += take;
+        n -= take;
+    }
+    *bit = pos;
+    return value;
+}
+
+static inline int32_t read_bits_signed(const uint8_t *base, uint32_t *bit, uint8_t n)
+{
+    uint32_t value = read_bits(base, bit, n);
+    if (n && (value & (1u << (n - 1)))) {
+        value |= ~0u << n;
+    }
+    return (int32_t)value;
+}
+
+// 读表头，校验标签和长度，返回表长度（0表示无效）
+static uint32_t table_check(const uint8_t *data, size_t size, size_t offset, const char *tag)
+{
+    if (offset > size || size - offset < TABLE_HEADER_SIZE) return 0;
+    uint32_t length = rd32(data + offset);
+    if (memcmp(data + offset + 4, tag, 4) != 0 || length < TABLE_HEADER_SIZE || length > size - offset) {
+        return 0;
+    }
+    return length;
+}
+
+static int sparse_find(const uint8_t *list, uint32_t count, uint32_t rcp)
+{
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint16_t v = rd16(list + mid * 2);
+        if (v == rcp) return (int)mid;
+        if (v < rcp) lo = mid + 1; else hi = mid;
+    }
+    return -1;
+}
+
+// Unicode码点 → 字形序号，0表示字体中没有
+static uint32_t glyph_id(const mmap_font_t *mf, uint32_t letter)
+{
+    for (uint32_t i = 0; i < mf->cmap_count; i++) {
+        const uint8_t *rec = mf->cmap_records + i * CMAP_RECORD_SIZE;
+        uint32_t rcp = letter - rd32(rec + 4);
+        if (rcp >= rd16(rec + 8)) continue;
+
+        const uint8_t *data = mf->cmap + rd32(rec);
+        uint16_t gid_start = rd16(rec + 10);
+        uint16_t entries = rd16(rec + 12);
+        int idx;
+        switch (rec[14]) {
+        case CMAP_FORMAT0_TINY:
+            return gid_start + rcp;
+        case CMAP_FORMAT0_FULL:
+            return rcp < entries ? gid_start + data[rcp] : 0;
+        case CMAP_SPARSE_TINY:
+            idx = sparse_find(data, entries, rcp);
+            return idx < 0 ? 0 : gid_start + (uint32_t)idx;
+        case CMAP_SPARSE_FULL:
+            idx = sparse_find(data, entries, rcp);
+            return idx < 0 ? 0 : gid_start + rd16(data + entries * 2 + idx * 2);
+        default:
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static bool glyph_read(const mmap_font_t *mf, uint32_t gid, glyph_info_t *info)
+{
+    if (gid == 0 || gid >= mf->glyph_count) return false;
+
+    uint32_t start, end;
+    if (mf->loca_32) {
+        start = rd32(mf->loca + gid * 4);
+        end = gid + 1 < mf->glyph_count ? rd32(mf->loca + (gid + 1) * 4) : mf->glyf_size;
+    } else {
+        start = rd16(mf->loca + gid * 2);
+        end = gid + 1 < mf->glyph_count ? rd16(mf->loca + (gid + 1) * 2) : mf->glyf_size;
+    }
+    uint32_t header_bits = mf->adv_bits + 2 * mf->xy_bits + 2 * mf->wh_bits;
+    if (start < TABLE_HEADER_SIZE || end > mf->glyf_size || end < start ||
+        (end - start) * 8 < header_bits) {
+        return false;
+    }
+
+    uint32_t bit = start * 8;
+    info->adv_w = mf->adv_bits ? read_bits(mf->glyf, &bit, mf->adv_bits) : mf->default_adv;
+    if (!mf->adv_fixed) {
+        info->adv_w *= 16;
+    }
+    info->ofs_x = (int16_t)read_bits_signed(mf->glyf, &bit, mf->xy_bits);
+    info->ofs_y = (int16_t)read_bits_signed(mf->glyf, &bit, mf->xy_bits);
+    info->box_w = (uint16_t)read_bits(mf->glyf, &bit, mf->wh_bits);
+    info->box_h = (uint16_t)read_bits(mf->glyf, &bit, mf->wh_bits);
+    info->bitmap_bit = bit;
+    info->end_bit = end * 8;
+    return true;
+}
+
+static int pair_cmp(uint32_t l1, uint32_t r1, uint32_t l2, uint32_t r2)
+{
+    if (l1 != l2) return l1 < l2 ? -1 : 1;
+    if (r1 != r2) return r1 < r2 ? -1 : 1;
+    return 0;
+}
+
+static int8_t kern_value(const mmap_font_t *mf, uint32_t left, uint32_t right)
+{
+    if (mf->kern_format == 3) {
+        if (left >= mf->kern_count || right >= mf->kern_count) return 0;
+        uint8_t lc = mf->kern_left[left];
+        uint8_t rc = mf->kern_right[right];
+        if (lc == 0 || rc == 0 || lc > mf->kern_rows || rc > mf->kern_cols) return 0;
+        return mf->kern_values[(lc - 1) * mf->kern_cols + (rc - 1)];
+    }
+
+    // 字形对按左、右字形序号排序
+    uint32_t lo = 0, hi = mf->kern_count;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        uint32_t l, r;
+        if (mf->kern_gid16) {
+            l = rd16(mf->kern_ids + mid * 4);
+            r = rd16(mf->kern_ids + mid * 4 + 2);
+        } else {
+            l = mf->kern_ids[mid * 2];
+            r = mf->kern_ids[mid * 2 + 1];
+        }
+        int c = pair_cmp(left, right, l, r);
+        if (c == 0) return mf->kern_values[mid];
+        if (c > 0) lo = mid + 1; else hi = mid;
+    }
+    return 0;
+}
+
+static bool mmap_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    const mmap_font_t *mf = (const mmap_font_t *)font;
+    bool is_tab = letter == '\t';
+    if (is_tab) letter = ' ';
+
+    uint32_t gid = glyph_id(mf, letter);
+    glyph_info_t info;
+    if (!gid || !glyph_read(mf, gid, &info)) return false;
+
+    int32_t adv_w = (int32_t)info.adv_w;
+    if (is_tab) adv_w *= 2;
+    if (mf->kern_values && letter_next && font->kerning == LV_FONT_KERNING_NORMAL) {
+        uint32_t gid_next = glyph_id(mf, letter_next);
+        if (gid_next) {
+            adv_w += (kern_value(mf, gid, gid_next) * mf->kern_scale) >> 4;
+        }
+    }
+
+    dsc->adv_w = (uint16_t)((adv_w + (1 << 3)) >> 4);
+    dsc->box_w = info.box_w;
+    dsc->box_h = info.box_h;
+    dsc->ofs_x = info.ofs_x;
+    dsc->ofs_y = info.ofs_y;
+    dsc->format = (uint8_t)mf->bpp;
+    dsc->is_placeholder = false;
+    dsc->gid.index = gid;
+    return true;
+}
+
+static const uint8_t *opa_table(uint8_t bpp)
+{
+    switch (bpp) {
+    case 2: return opa2_table;
+    case 3: return opa3_table;
+    case 4: return opa4_table;
+    default: return NULL;
+    }
+}
+
+// lv_font_conv的RLE：连续两个相同值后进入重复模式，之后每个1位表示再重复一次，
+// 连续11次后改用6位计数
+typedef enum {
+    RLE_SINGLE,
+    RLE_REPEATED,
+    RLE_COUNTER,
+} rle_mode_t;
+
+typedef struct {
+    const uint8_t *in;
+    uint32_t bit;
+    uint32_t end_bit;
+    uint8_t bpp;
+    uint8_t prev;
+    uint8_t count;
+    bool first;
+    rle_mode_t mode;
+} rle_t;
+
+static inline uint8_t rle_bits(rle_t *rle, uint8_t n)
+{
+    // 数据截断时补0，不越过字形末尾读取
+    if (rle->bit + n > rle->end_bit) {
+        rle->bit = rle->end_bit;
+        return 0;
+    }
+    return (uint8_t)read_bits(rle->in, &rle->bit, n);
+}
+
+static uint8_t rle_next(rle_t *rle)
+{
+    uint8_t ret;
+    switch (rle->mode) {
+    case RLE_SINGLE:
+        ret = rle_bits(rle, rle->bpp);
+        if (!rle->first && rle->prev == ret) {
+            rle->count = 0;
+            rle->mode = RLE_REPEATED;
+        }
+        rle->first = false;
+        rle->prev = ret;
+        return ret;
+    case RLE_REPEATED:
+        rle->count++;
+        if (rle_bits(rle, 1)) {
+            ret = rle->prev;
+            if (rle->count == 11) {
+                rle->count = rle_bits(rle, 6);
+                if (rle->count) {
+                    rle->mode = RLE_COUNTER;
+                } else {
+                    ret = rle_bits(rle, rle->bpp);
+                    rle->prev = ret;
+                    rle->mode = RLE_SINGLE;
+                }
+            }
+        } else {
+            ret = rle_bits(rle, rle->bpp);
+            rle->prev = ret;
+            rle->mode = RLE_SINGLE;
+        }
+        return ret;
+    case RLE_COUNTER:
+    default:
+        ret = rle->prev;
+        if (--rle->count == 0) {
+            ret = rle_bits(rle, rle->bpp);
+            rle->prev = ret;
+            rle->mode = RLE_SINGLE;
+        }
+        return ret;
+    }
+}
+
+static const void *mmap_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+    const mmap_font_t *mf = (const mmap_font_t *)g_dsc->resolved_font;
+    glyph_info_t info;
+    if (!draw_buf || !glyph_read(mf, g_dsc->gid.index, &info) || info.box_w == 0 || info.box_h == 0) {
+        return NULL;
+    }
+
+    uint32_t w = info.box_w;
+    uint32_t h = info.box_h;
+    uint32_t stride = lv_draw_buf_width_to_stride(w, LV_COLOR_FORMAT_A8);
+    if (draw_buf->data_size < stride * h) {
+        return NULL;
+    }
+    uint8_t *out = draw_buf->data;
+    const uint8_t *table = opa_table(mf->bpp);
+
+    if (mf->compression == BITMAP_PLAIN) {
+        uint32_t bit = info.bitmap_bit;
+        if (info.end_bit < bit || info.end_bit - bit < w * h * mf->bpp) return NULL;
+        for (uint32_t y = 0; y < h; y++) {
+            uint8_t *row = out + y * stride;
+            for (uint32_t x = 0; x < w; x++) {
+                uint8_t v = (uint8_t)read_bits(mf->glyf, &bit, mf->bpp);
+                row[x] = mf->bpp == 1 ? (v ? 0xFF : 0) : table ? table[v] : v;
+            }
+        }
+        return draw_buf;
+    }
+
+    // 先解出原始值，带预过滤时每行与上一行异或，最后统一换算为不透明度
+    rle_t rle = {
+        .in = mf->glyf,
+        .bit = info.bitmap_bit,
+        .end_bit = info.end_bit,
+        .bpp = mf->bpp,
+        .first = true,
+        .mode = RLE_SINGLE,
+    };
+    bool prefilter = mf->compression == BITMAP_COMPRESSED;
+    for (uint32_t y = 0; y < h; y++) {
+        uint8_t *row = out + y * stride;
+        const uint8_t *above = row - stride;
+        for (uint32_t x = 0; x < w; x++) {
+            uint8_t v = rle_next(&rle);
+            row[x] = (prefilter && y) ? v ^ above[x] : v;
+        }
+    }
+    if (table) {
+        for (uint32_t y = 0; y < h; y++) {
+            uint8_t *row = out + y * stride;
+            for (uint32_t x = 0; x < w; x++) {
+                row[x] = table[row[x]];
+            }
+        }
+    }
+    return draw_buf;
+}
+
+// 解析kern表，格式不支持时忽略字距调整
+static void kern_parse(mmap_font_t *mf, const uint8_t *kern, uint32_t length, uint8_t gid_format)
+{
+    const uint8_t *p = kern + TABLE_HEADER_SIZE;
+    uint32_t left = length - TABLE_HEADER_SIZE;
+    if (left < 4) return;
+    uint8_t format = p[0];
+    p += 4;
+    left -= 4;
+
+    if (format == 0) {
+        if (left < 4) return;
+        uint32_t count = rd32(p);
+        uint32_t id_size = gid_format ? 4 : 2;
+        p += 4;
+        left -= 4;
+        if (count > left / (id_size + 1)) return;
+        mf->kern_gid16 = gid_format ? 1 : 0;
+        mf->kern_count = count;
+        mf->kern_ids = p;
+        mf->kern_values = (const int8_t *)(p + count * id_size);
+    } else if (format == 3) {
+        if (left < 4) return;
+        uint16_t map_len = rd16(p);
+        uint8_t rows = p[2];
+        uint8_t cols = p[3];
+        p += 4;
+        left -= 4;
+        if ((uint32_t)map_len * 2 + rows * cols > left) return;
+        mf->kern_count = map_len;
+        mf->kern_rows = rows;
+        mf->kern_cols = cols;
+        mf->kern_left = p;
+        mf->kern_right = p + map_len;
+        mf->kern_values = (const int8_t *)(p + map_len * 2);
+    } else {
+        DLOGW(TAG, "不支持的kern格式 %u，忽略字距调整", format);
+        return;
+    }
+    mf->kern_format = format;
+}
+
+lv_font_t *mmap_font_create(const uint8_t *data, size_t size)
+{
+    if (!data) return NULL;
+
+    size_t offset = 0;
+    uint32_t head_len = table_check(data, size, offset, "head");
+    if (head_len < TABLE_HEADER_SIZE + HEAD_SIZE) {
+        DLOGE(TAG, "字体文件头无效");
+        return NULL;
+    }
+    const uint8_t *head = data + TABLE_HEADER_SIZE;
+    uint16_t tables = rd16(head + HEAD_TABLES);
+    uint16_t ascent = rd16(head + HEAD_ASCENT);
+    int16_t descent = (int16_t)rd16(head + HEAD_DESCENT);
+    uint8_t bpp = head[HEAD_BPP];
+    uint8_t compression = head[HEAD_COMPRESSION];
+    if (bpp != 1 && bpp != 2 && bpp != 3 && bpp != 4 && bpp != 8) {
+        DLOGE(TAG, "不支持的像素位数 %u", bpp);
+        return NULL;
+    }
+    if (compression > BITMAP_COMPRESSED_NO_PREFILTER || head[HEAD_XY_BITS] > 16 || head[HEAD_WH_BITS] > 16 || head[HEAD_ADV_BITS] > 16) {
+        DLOGE(TAG, "不支持的字形格式");
+        return NULL;
+    }
+    offset += head_len;
+
+    uint32_t cmap_len = table_check(data, size, offset, "cmap");
+    if (cmap_len < TABLE_HEADER_SIZE + 4) goto bad;
+    const uint8_t *cmap = data + offset;
+    uint32_t cmap_count = rd32(cmap + TABLE_HEADER_SIZE);
+    if (cmap_count > (cmap_len - TABLE_HEADER_SIZE - 4) / CMAP_RECORD_SIZE) goto bad;
+    // 子表数据须在cmap表内
+    const uint8_t *records = cmap + TABLE_HEADER_SIZE + 4;
+    for (uint32_t i = 0; i < cmap_count; i++) {
+        const uint8_t *rec = records + i * CMAP_RECORD_SIZE;
+        uint32_t entries = rd16(rec + 12);
+        uint32_t bytes = rec[14] == CMAP_FORMAT0_FULL ? entries :
+                         rec[14] == CMAP_SPARSE_TINY ? entries * 2 :
+                         rec[14] == CMAP_SPARSE_FULL ? entries * 4 : 0;
+        if (rd32(rec) > cmap_len || bytes > cmap_len - rd32(rec)) goto bad;
+    }
+    offset += cmap_len;
+
+    uint32_t loca_len = table_check(data, size, offset, "loca");
+    if (loca_len < TABLE_HEADER_SIZE + 4) goto bad;
+    const uint8_t *loca = data + offset + TABLE_HEADER_SIZE;
+    uint32_t glyph_count = rd32(loca);
+    uint8_t loca_32 = head[HEAD_LOCA_FORMAT] ? 1 : 0;
+    if (glyph_count > (loca_len - TABLE_HEADER_SIZE - 4) / (loca_32 ? 4 : 2)) goto bad;
+    offset += loca_len;
+
+    uint32_t glyf_len = table_check(data, size, offset, "glyf");
+    if (glyf_len == 0) goto bad;
+    const uint8_t *glyf = data + offset;
+    offset += glyf_len;
+
+    mmap_font_t *mf = calloc(1, sizeof(mmap_font_t));
+    if (!mf) return NULL;
+
+    mf->cmap = cmap;
+    mf->cmap_records = records;
+    mf->cmap_count = cmap_count;
+    mf->loca = loca + 4;
+    mf->loca_32 = loca_32;
+    mf->glyph_count = glyph_count;
+    mf->glyf = glyf;
+    mf->glyf_size = glyf_len;
+    mf->default_adv = rd16(head + HEAD_DEFAULT_ADV);
+    mf->kern_scale = rd16(head + HEAD_KERN_SCALE);
+    mf->adv_fixed = head[HEAD_ADV_FORMAT] ? 1 : 0;
+    mf->bpp = bpp;
+    mf->xy_bits = head[HEAD_XY_BITS];
+    mf->wh_bits = head[HEAD_WH_BITS];
+    mf->adv_bits = head[HEAD_ADV_BITS];
+    mf->compression = compression;
+
+    if (tables >= 4) {
+        uint32_t kern_len = table_check(data, size, offset, "kern");
+        if (kern_len) {
+            kern_parse(mf, data + offset, kern_len, head[HEAD_GID_FORMAT]);
+        }
+    }
+
+    lv_font_t *font = &mf->font;
+    font->get_glyph_dsc = mmap_get_glyph_dsc;
+    font->get_glyph_bitmap = mmap_get_glyph_bitmap;
+    font->line_height = ascent - descent;
+    font->base_line = -descent;
+    font->subpx = head[HEAD_SUBPX];
+    font->underline_position = (int8_t)rd16(head + HEAD_UNDERLINE_POS);
+    font->underline_thickness = (int8_t)rd16(head + HEAD_UNDERLINE_TH);
+
+    DLOGI(TAG, "映射字体: %lu 个字形, %u bpp, %s", glyph_count, bpp,
+          compression == BITMAP_PLAIN ? "未压缩" : "压缩");
+    return font;
+
+bad:
+    DLOGE(TAG, "字体文件表结构无效");
+    return NULL;
+}
+
+void mmap_font_destroy(lv_font_t *font)
+{
+    free(font);
+}
+
+size_t mmap_font_resident_size(const lv_font_t *font)
+{
+    return font ? sizeof(mmap_font_t) : 0;
+}
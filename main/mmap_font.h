@@ -0,0 +1,39 @@
+/**
+ * @file mmap_font.h
+ * @brief 直接读取内存映射分区的binfont字体
+ *
+ * lv_binfont_create会把整个字体文件（字形描述、cmap、位图）拷贝到LVGL堆中。
+ * font分区已经映射到地址空间，这里只解析文件头，字形查找和位图解码都直接读取映射的数据：
+ *   - 常驻内存只有一个很小的描述结构，与字形数量无关；
+ *   - 压缩字体在每次取位图时解码，解码结果由字形缓存（glyph_cache）缓存；
+ *   - 字体不保存查找状态，可在多个绘制单元中并发使用。
+ * 映射的数据需在字体存在期间保持有效。
+ */
+
+#ifndef MMAP_FONT_H
+#define MMAP_FONT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lvgl.h"
+
+/**
+ * @brief 由映射的binfont文件创建字体
+ *
+ * @param data 文件数据（lv_font_conv --format bin 生成）
+ * @param size 文件大小
+ * @return lv_font_t* 字体，格式不支持或数据损坏时返回NULL
+ */
+lv_font_t *mmap_font_create(const uint8_t *data, size_t size);
+
+/**
+ * @brief 销毁字体（不影响映射的数据）
+ */
+void mmap_font_destroy(lv_font_t *font);
+
+/**
+ * @brief 字体占用的内存（字节）
+ */
+size_t mmap_font_resident_size(const lv_font_t *font);
+
+#endif // MMAP_FONT_H
@@ -0,0 +1,317 @@
+/**
+ * @file order_bench.c
+ * @brief 订单处理链路性能测试
+ *
+ * 使用合成数据在设备上测量各环节的处理能力，结果通过日志输出。
+ */
+
+#include "sdkconfig.h"
+#include "order_bench.h"
+
+#if CONFIG_ORDER_BENCH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "host/ble_hs.h"
+#include "order_frame.h"
+#include "order_ingest.h"
+#include "order_session.h"
+#include "order_store.h"
+
+static const char *TAG = "OrderBench";
+
+#define BENCH_FRAME_PAYLOAD  240   // MTU 247时单个分片的数据长度
+#define BENCH_STORE_OPS      2000
+#define BENCH_SCAN_LOOKUPS   100
+#define BENCH_STORE_ID_LEN   16
+#define BENCH_DISH_COUNT     8
+#define BENCH_CLIENTS        ORDER_SESSION_MAX
+#define BENCH_CLIENT_ORDERS  20
+#define BENCH_CLIENT_DISHES  6
+#define BENCH_LOAD_TIMEOUT_US (30 * 1000 * 1000)
+
+// 旧实现：每个订单单独calloc并挂在链表上，按订单ID线性查找
+typedef struct bench_scan_node {
+    struct bench_scan_node *next;
+    char order_id[];
+} bench_scan_node_t;
+
+static bench_scan_node_t *bench_scan_find(bench_scan_node_t *head, const char *order_id)
+{
+    for (; head; head = head->next) {
+        if (strcmp(head->order_id, order_id) == 0) {
+            return head;
+        }
+    }
+    return NULL;
+}
+
+// 订单存储：1k~10k条在线订单时的添加/查找/更新/删除耗时，与链表线性查找对比
+static void bench_order_store(void)
+{
+    static const uint16_t sizes[] = {1000, 5000, 10000};
+    static const char *dish_name = "麻婆豆腐";
+    const uint16_t max_size = sizes[sizeof(sizes) / sizeof(sizes[0]) - 1];
+
+    char (*ids)[BENCH_STORE_ID_LEN] = heap_caps_malloc((size_t)max_size * BENCH_STORE_ID_LEN,
+                                                       MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!ids) return;
+    for (uint32_t i = 0; i < max_size; i++) {
+        snprintf(ids[i], BENCH_STORE_ID_LEN, "2025%08lu", (unsigned long)(i * 7919u));
+    }
+
+    dish_t dishes[BENCH_DISH_COUNT];
+    for (int i = 0; i < BENCH_DISH_COUNT; i++) {
+        dishes[i].name = dish_name;
+        dishes[i].name_len = strlen(dish_name);
+    }
+    order_t order = {.dish_count = BENCH_DISH_COUNT, .dishes = dishes};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        uint16_t n = sizes[s];
+        order_store_t *store = order_store_create(n);
+        if (!store) {
+            ESP_LOGW(TAG, "[store] %u 条: 分配失败", n);
+            continue;
+        }
+
+        uint32_t start = esp_cpu_get_cycle_count();
+        for (uint16_t i = 0; i < n; i++) {
+            order.order_id = ids[i];
+            order.order_num = i;
+            order_store_add(store, &order, NULL);
+        }
+        uint32_t add_cycles = (esp_cpu_get_cycle_count() - start) / n;
+
+        // 伪随机访问，避免顺序访问掩盖缓存未命中
+        uint32_t seed = 12345;
+        start = esp_cpu_get_cycle_count();
+        for (int op = 0; op < BENCH_STORE_OPS; op++) {
+            seed = seed * 1103515245u + 12345u;
+            order_store_find(store, ids[(seed >> 8) % n]);
+        }
+        uint32_t find_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_STORE_OPS;
+
+        start = esp_cpu_get_cycle_count();
+        for (int op = 0; op < BENCH_STORE_OPS; op++) {
+            seed = seed * 1103515245u + 12345u;
+            order.order_id = ids[(seed >> 8) % n];
+            order_store_update(store, order_store_find(store, order.order_id), &order);
+        }
+        uint32_t update_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_STORE_OPS;
+
+        start = esp_cpu_get_cycle_count();
+        for (int op = 0; op < BENCH_STORE_OPS; op++) {
+            seed = seed * 1103515245u + 12345u;
+            order.order_id = ids[(seed >> 8) % n];
+            order_store_remove(store, order_store_find(store, order.order_id));
+            order_store_add(store, &order, NULL);
+        }
+        uint32_t churn_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_STORE_OPS;
+
+        order_store_stats_t stats;
+        order_store_get_stats(store, &stats);
+        order_store_destroy(store);
+
+        // 旧实现对照
+        bench_scan_node_t *head = NULL;
+        bench_scan_node_t **tail = &head;
+        uint16_t built = 0;
+        start = esp_cpu_get_cycle_count();
+        for (; built < n; built++) {
+            size_t id_len = strlen(ids[built]);
+            bench_scan_node_t *node = calloc(1, sizeof(*node) + id_len + 1);
+            if (!node) break;
+            memcpy(node->order_id, ids[built], id_len + 1);
+            *tail = node;
+            tail = &node->next;
+        }
+        uint32_t scan_add_cycles = built ? (esp_cpu_get_cycle_count() - start) / built : 0;
+
+        uint32_t scan_find_cycles = 0;
+        if (built) {
+            start = esp_cpu_get_cycle_count();
+            for (int op = 0; op < BENCH_SCAN_LOOKUPS; op++) {
+                seed = seed * 1103515245u + 12345u;
+                bench_scan_find(head, ids[(seed >> 8) % built]);
+            }
+            scan_find_cycles = (esp_cpu_get_cycle_count() - start) / BENCH_SCAN_LOOKUPS;
+        }
+        while (head) {
+            bench_scan_node_t *next = head->next;
+            free(head);
+            head = next;
+        }
+
+        ESP_LOGI(TAG, "[store] %u 条: 添加 %lu, 查找 %lu, 更新 %lu, 删除+添加 %lu cycles/次, 最长探测 %lu, 内存 %u KB",
+                 n, add_cycles, find_cycles, update_cycles, churn_cycles, stats.probe_max,
+                 (unsigned)(stats.slab_bytes / 1024));
+        ESP_LOGI(TAG, "[store] %u 条: 链表对照 添加 %lu, 查找 %lu cycles/次", built, scan_add_cycles, scan_find_cycles);
+    }
+
+    heap_caps_free(ids);
+}
+
+// 按MTU分片写入一条消息，返回最后一个分片的处理结果
+static int bench_send_frames(order_frame_ctx_t *ctx, const char *msg, size_t msg_len)
+{
+    uint8_t frame[ORDER_FRAME_HDR_LEN + BENCH_FRAME_PAYLOAD];
+    uint16_t seq = 0;
+    int rc = 0;
+
+    for (size_t off = 0; off < msg_len; off += BENCH_FRAME_PAYLOAD, seq++) {
+        size_t chunk = msg_len - off < BENCH_FRAME_PAYLOAD ? msg_len - off : BENCH_FRAME_PAYLOAD;
+        frame[0] = ORDER_FRAME_MARKER | ((seq >> ORDER_FRAME_SEQ_HI_SHIFT) & ORDER_FRAME_SEQ_HI_MASK) |
+                   (off + chunk == msg_len ? ORDER_FRAME_FLAG_FINAL : 0);
+        frame[1] = seq & 0xFF;
+        frame[2] = msg_len & 0xFF;
+        frame[3] = msg_len >> 8;
+        memcpy(frame + ORDER_FRAME_HDR_LEN, msg + off, chunk);
+
+        struct os_mbuf *om = ble_hs_mbuf_from_flat(frame, ORDER_FRAME_HDR_LEN + chunk);
+        if (!om) {
+            return -1;
+        }
+        rc = order_frame_receive(ctx, om);
+        os_mbuf_free_chain(om);
+        if (rc != 0) {
+            break;
+        }
+    }
+    return rc;
+}
+
+// 模拟的POS客户端
+typedef struct {
+    int index;
+    uint32_t sent;       // 已被接受的消息数
+    uint32_t retries;    // 因队列或缓冲池满而重发的次数
+    uint32_t failures;   // 其他错误
+    SemaphoreHandle_t done;
+} bench_client_t;
+
+// 与main.c中的交付方式一致：重组后的缓冲区直接进入接入队列
+static esp_err_t bench_deliver_ingest(char *msg, size_t len, uint16_t conn_handle)
+{
+    return order_ingest_submit(msg, len, conn_handle, order_frame_buf_release);
+}
+
+// 客户端任务：先连续下单，再逐个删除，保证测试结束后界面恢复原状
+static void bench_client_task(void *arg)
+{
+    bench_client_t *client = arg;
+    static const char *hex_name = "E9BABBE5A986E8B186E88590";  // 麻婆豆腐
+    char *msg = malloc(CONFIG_ORDER_FRAME_MAX_LEN);
+    order_frame_ctx_t ctx;
+    order_frame_ctx_init(&ctx, bench_deliver_ingest);
+    ctx.conn_handle = BLE_HS_CONN_HANDLE_NONE;   // 没有对应的连接，拒绝通知无处可发
+
+    for (int phase = 0; msg && phase < 2; phase++) {
+        for (int n = 0; n < BENCH_CLIENT_ORDERS; n++) {
+            int len;
+            if (phase == 0) {
+                len = snprintf(msg, CONFIG_ORDER_FRAME_MAX_LEN,
+                               "{\"type\":\"add\",\"orderId\":\"99%02d%04d\",\"items\":[", client->index, n);
+                for (int i = 0; i < BENCH_CLIENT_DISHES; i++) {
+                    len += snprintf(msg + len, CONFIG_ORDER_FRAME_MAX_LEN - len, "%s{\"name\":\"%s\",\"qty\":1}",
+                                    i ? "," : "", hex_name);
+                }
+                len += snprintf(msg + len, CONFIG_ORDER_FRAME_MAX_LEN - len, "]}");
+            } else {
+                len = snprintf(msg, CONFIG_ORDER_FRAME_MAX_LEN,
+                               "{\"type\":\"remove\",\"orderId\":\"99%02d%04d\"}", client->index, n);
+            }
+
+            // 与真实POS一样，被拒绝的写入稍后整条重发
+            for (;;) {
+                int rc = bench_send_frames(&ctx, msg, len);
+                if (rc == 0) {
+                    client->sent++;
+                    break;
+                }
+                if (rc != BLE_ATT_ERR_INSUFFICIENT_RES) {
+                    client->failures++;
+                    break;
+                }
+                client->retries++;
+                vTaskDelay(1);
+            }
+        }
+    }
+
+    order_frame_ctx_reset(&ctx);
+    free(msg);
+    xSemaphoreGive(client->done);
+    vTaskDelete(NULL);
+}
+
+// 多客户端负载：多个POS同时通过重组和接入队列下单，测量端到端处理能力
+static void bench_multi_client_load(void)
+{
+    bench_client_t clients[BENCH_CLIENTS] = {0};
+    SemaphoreHandle_t done = xSemaphoreCreateCounting(BENCH_CLIENTS, 0);
+    if (!done) return;
+
+    order_ingest_stats_t before;
+    order_ingest_get_stats(&before);
+
+    int started = 0;
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < BENCH_CLIENTS; i++) {
+        clients[i].index = i;
+        clients[i].done = done;
+        if (xTaskCreate(bench_client_task, "bench_pos", 4096, &clients[i], 4, NULL) == pdPASS) {
+            started++;
+        }
+    }
+    for (int i = 0; i < started; i++) {
+        xSemaphoreTake(done, portMAX_DELAY);
+    }
+    int64_t submit_us = esp_timer_get_time() - start;
+
+    uint32_t sent = 0, retries = 0, failures = 0;
+    for (int i = 0; i < started; i++) {
+        sent += clients[i].sent;
+        retries += clients[i].retries;
+        failures += clients[i].failures;
+    }
+
+    // 等待工作任务处理完所有消息
+    order_ingest_stats_t after;
+    do {
+        vTaskDelay(pdMS_TO_TICKS(10));
+        order_ingest_get_stats(&after);
+    } while (after.processed - before.processed < sent &&
+             esp_timer_get_time() - start < BENCH_LOAD_TIMEOUT_US);
+    int64_t total_us = esp_timer_get_time() - start;
+    uint32_t processed = after.processed - before.processed;
+    uint32_t batches = after.batches - before.batches;
+
+    ESP_LOGI(TAG, "[load] %d 个客户端, 发送 %lu 条 (重发 %lu, 失败 %lu), 提交耗时 %lld us, 处理完成 %lld us",
+             started, sent, retries, failures, submit_us, total_us);
+    ESP_LOGI(TAG, "[load] 处理 %lu 条/%lu 批, %llu 条/秒, 队列峰值 %lu, 单批最大 %lu, 显示锁最长等待 %lu us",
+             processed, batches, total_us > 0 ? (uint64_t)processed * 1000000ULL / total_us : 0,
+             after.queue_depth_max, after.max_batch_size, after.lock_wait_us_max);
+
+    // 测试消息经过真实的重组缓冲池，清零统计以免计入之后的POS流量
+    order_frame_reset_stats();
+    vSemaphoreDelete(done);
+}
+
+void order_bench_run(void)
+{
+    ESP_LOGI(TAG, "开始性能测试");
+    bench_order_store();
+    bench_multi_client_load();
+    ESP_LOGI(TAG, "性能测试完成");
+}
+
+#endif // CONFIG_ORDER_BENCH
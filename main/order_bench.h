@@ -0,0 +1,14 @@
+/**
+ * @file order_bench.h
+ * @brief 订单处理链路性能测试（CONFIG_ORDER_BENCH）
+ */
+
+#ifndef ORDER_BENCH_H
+#define ORDER_BENCH_H
+
+/**
+ * @brief 运行所有性能测试并打印结果
+ */
+void order_bench_run(void);
+
+#endif // ORDER_BENCH_H
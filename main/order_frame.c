@@ -0,0 +1,293 @@
+/**
+ * @file order_frame.c
+ * @brief 订单特征值分片重组实现
+ */
+
+#include "order_frame.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "order_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "host/ble_hs.h"
+#include "order_wire.h"
+
+static const char *TAG = "OrderFrame";
+
+#define FRAME_BUF_SIZE (CONFIG_ORDER_FRAME_MAX_LEN + 1)
+
+// 缓冲池：一次性在PSRAM中分配，用空闲栈管理
+static char *s_pool = NULL;
+static uint16_t s_free_stack[CONFIG_ORDER_FRAME_POOL_SIZE];
+static int s_free_top = 0;
+static portMUX_TYPE s_pool_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static order_frame_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t order_frame_pool_init(void)
+{
+    if (s_pool) {
+        return ESP_OK;
+    }
+
+    s_pool = heap_caps_malloc((size_t)FRAME_BUF_SIZE * CONFIG_ORDER_FRAME_POOL_SIZE,
+                              MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!s_pool) {
+        DLOGE(TAG, "分配重组缓冲池失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (int i = 0; i < CONFIG_ORDER_FRAME_POOL_SIZE; i++) {
+        s_free_stack[i] = i;
+    }
+    s_free_top = CONFIG_ORDER_FRAME_POOL_SIZE;
+    return ESP_OK;
+}
+
+static char *frame_buf_acquire(void)
+{
+    char *buf = NULL;
+
+    portENTER_CRITICAL(&s_pool_lock);
+    if (s_pool && s_free_top > 0) {
+        buf = s_pool + (size_t)s_free_stack[--s_free_top] * FRAME_BUF_SIZE;
+    }
+    portEXIT_CRITICAL(&s_pool_lock);
+
+    return buf;
+}
+
+void order_frame_buf_release(char *buf)
+{
+    if (!buf || !s_pool) return;
+
+    uint16_t index = (uint16_t)((buf - s_pool) / FRAME_BUF_SIZE);
+    portENTER_CRITICAL(&s_pool_lock);
+    s_free_stack[s_free_top++] = index;
+    portEXIT_CRITICAL(&s_pool_lock);
+}
+
+void order_frame_ctx_init(order_frame_ctx_t *ctx, order_frame_deliver_t deliver)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->deliver = deliver;
+}
+
+void order_frame_ctx_reset(order_frame_ctx_t *ctx)
+{
+    if (ctx->buf) {
+        order_frame_buf_release(ctx->buf);
+    }
+    ctx->buf = NULL;
+    ctx->total = 0;
+    ctx->received = 0;
+    ctx->next_seq = 0;
+    ctx->text = false;
+    ctx->utf8 = UTF8_ACCEPT;
+}
+
+// 统计计数器累加（需在临界区外调用）
+#define FRAME_STAT_INC(field) do {              \
+        portENTER_CRITICAL(&s_stats_lock);      \
+        s_stats.field++;                        \
+        portEXIT_CRITICAL(&s_stats_lock);       \
+    } while (0)
+
+// 交付完整消息，缓冲区所有权随之转移
+static int frame_deliver(order_frame_ctx_t *ctx, char *buf, uint16_t len)
+{
+    buf[len] = '\0';
+    if (ctx->deliver(buf, len, ctx->conn_handle) != ESP_OK) {
+        order_frame_buf_release(buf);
+        FRAME_STAT_INC(rejected);
+        return BLE_ATT_ERR_INSUFFICIENT_RES;
+    }
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.messages++;
+    s_stats.payload_bytes += len;
+    s_stats.last_us = now;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return 0;
+}
+
+// 二进制消息（首字节为魔数）不做UTF-8校验，其余按文本处理
+static bool frame_is_text(const char *data, size_t len)
+{
+    return len > 0 && (uint8_t)data[0] != ORDER_WIRE_MAGIC_V1;
+}
+
+// 记录开始接收一条消息的时间，作为吞吐量统计的起点
+static void frame_mark_start(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    if (s_stats.first_us == 0) {
+        s_stats.first_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+int order_frame_receive(order_frame_ctx_t *ctx, const struct os_mbuf *om)
+{
+    uint16_t om_len = OS_MBUF_PKTLEN(om);
+    if (om_len == 0) {
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    uint8_t hdr[ORDER_FRAME_HDR_LEN];
+    uint16_t hdr_len = om_len < ORDER_FRAME_HDR_LEN ? om_len : ORDER_FRAME_HDR_LEN;
+    if (os_mbuf_copydata(om, 0, hdr_len, hdr) != 0) {
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    // 未分片的完整消息（旧版POS）
+    if ((hdr[0] & ORDER_FRAME_MARKER_MASK) != ORDER_FRAME_MARKER) {
+        if (om_len > CONFIG_ORDER_FRAME_MAX_LEN) {
+            FRAME_STAT_INC(len_errors);
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+        char *buf = frame_buf_acquire();
+        if (!buf) {
+            FRAME_STAT_INC(pool_exhausted);
+            return BLE_ATT_ERR_INSUFFICIENT_RES;
+        }
+        frame_mark_start();
+        os_mbuf_copydata(om, 0, om_len, buf);
+        FRAME_STAT_INC(fragments);
+        if (frame_is_text(buf, om_len) && !utf8_is_valid((const uint8_t *)buf, om_len)) {
+            order_frame_buf_release(buf);
+            FRAME_STAT_INC(utf8_errors);
+            return BLE_ATT_ERR_UNLIKELY;
+        }
+        return frame_deliver(ctx, buf, om_len);
+    }
+
+    if (om_len < ORDER_FRAME_HDR_LEN) {
+        FRAME_STAT_INC(len_errors);
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    uint16_t seq = ORDER_FRAME_HDR_SEQ(hdr);
+    uint16_t total = (uint16_t)hdr[2] | ((uint16_t)hdr[3] << 8);
+    uint16_t payload_len = om_len - ORDER_FRAME_HDR_LEN;
+    bool final = (hdr[0] & ORDER_FRAME_FLAG_FINAL) != 0;
+
+    FRAME_STAT_INC(fragments);
+
+    // 序号0开始新消息，未完成的旧消息被丢弃
+    if (seq == 0) {
+        order_frame_ctx_reset(ctx);
+        if (total == 0 || total > CONFIG_ORDER_FRAME_MAX_LEN) {
+            FRAME_STAT_INC(len_errors);
+            return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+        }
+        ctx->buf = frame_buf_acquire();
+        if (!ctx->buf) {
+            FRAME_STAT_INC(pool_exhausted);
+            return BLE_ATT_ERR_INSUFFICIENT_RES;
+        }
+        ctx->total = total;
+        ctx->text = true;
+        frame_mark_start();
+    } else if (!ctx->buf || seq != ctx->next_seq || total != ctx->total) {
+        DLOGW(TAG, "分片序号错误: 收到 %u, 期望 %u", seq, ctx->next_seq);
+        order_frame_ctx_reset(ctx);
+        FRAME_STAT_INC(seq_errors);
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    if ((uint32_t)ctx->received + payload_len > ctx->total) {
+        order_frame_ctx_reset(ctx);
+        FRAME_STAT_INC(len_errors);
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    // 分片数据直接拷贝进池缓冲区，不经过中间缓冲
+    if (payload_len > 0 &&
+        os_mbuf_copydata(om, ORDER_FRAME_HDR_LEN, payload_len, ctx->buf + ctx->received) != 0) {
+        order_frame_ctx_reset(ctx);
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+    // 消息类型由消息的第一个字节决定，而不是第一个分片：首分片可以不带数据
+    if (ctx->received == 0 && payload_len > 0) {
+        ctx->text = frame_is_text(ctx->buf, payload_len);
+    }
+    if (ctx->text) {
+        ctx->utf8 = utf8_validate_chunk(ctx->utf8, (const uint8_t *)ctx->buf + ctx->received, payload_len);
+        if (ctx->utf8 == UTF8_REJECT) {
+            DLOGW(TAG, "UTF-8编码错误，丢弃消息");
+            order_frame_ctx_reset(ctx);
+            FRAME_STAT_INC(utf8_errors);
+            return BLE_ATT_ERR_UNLIKELY;
+        }
+    }
+    ctx->received += payload_len;
+    ctx->next_seq = seq + 1;
+
+    if (!final) {
+        return 0;
+    }
+
+    if (ctx->received != ctx->total) {
+        DLOGW(TAG, "消息长度不符: 收到 %u, 声明 %u", ctx->received, ctx->total);
+        order_frame_ctx_reset(ctx);
+        FRAME_STAT_INC(len_errors);
+        return BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN;
+    }
+
+    // 消息末尾截断了多字节字符
+    if (ctx->text && ctx->utf8 != UTF8_ACCEPT) {
+        order_frame_ctx_reset(ctx);
+        FRAME_STAT_INC(utf8_errors);
+        return BLE_ATT_ERR_UNLIKELY;
+    }
+
+    char *buf = ctx->buf;
+    uint16_t len = ctx->received;
+    ctx->buf = NULL;
+    order_frame_ctx_reset(ctx);
+    int rc = frame_deliver(ctx, buf, len);
+    if (rc == 0) {
+        ctx->delivered++;
+    }
+    return rc;
+}
+
+void order_frame_get_stats(order_frame_stats_t *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void order_frame_reset_stats(void)
+{
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stats, 0, sizeof(s_stats));
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+uint32_t order_frame_bytes_per_sec(const order_frame_stats_t *stats)
+{
+    int64_t elapsed_us = stats->last_us - stats->first_us;
+    if (elapsed_us <= 0) {
+        return 0;
+    }
+    return (uint32_t)(stats->payload_bytes * 1000000ULL / (uint64_t)elapsed_us);
+}
+
+void order_frame_log_stats(void)
+{
+    order_frame_stats_t stats;
+    order_frame_get_stats(&stats);
+
+    DLOGI(TAG, "分片 %lu, 消息 %lu, 数据 %llu 字节, 吞吐 %lu B/s",
+             stats.fragments, stats.messages, stats.payload_bytes, order_frame_bytes_per_sec(&stats));
+    DLOGI(TAG, "序号错误 %lu, 长度错误 %lu, UTF-8错误 %lu, 缓冲池耗尽 %lu, 队列拒绝 %lu",
+             stats.seq_errors, stats.len_errors, stats.utf8_errors, stats.pool_exhausted, stats.rejected);
+}
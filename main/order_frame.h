@@ -0,0 +1,143 @@
+/**
+ * @file order_frame.h
+ * @brief 订单特征值分片重组
+ *
+ * 订单写入可按分片发送，每个分片带4字节帧头：
+ *   [0] 0xF0 | 标志位（bit0 = 最后一个分片，bit1-3 = 分片序号的高3位）
+ *   [1] 分片序号的低8位（每条消息从0开始递增，共11位）
+ *   [2..3] 消息总长度（小端）
+ * 之后为分片数据。首字节高4位不是0xF的写入视为未分片的完整消息（兼容旧版POS）。
+ * 重组在预分配的缓冲池中完成，完整消息一次性交给解析层。
+ * 文本（JSON）消息在分片到达时增量校验UTF-8，非法数据不等消息收完即被拒绝。
+ * 消息类型按消息的第一个字节判断（二进制消息以魔数开头），与数据如何分片无关。
+ */
+
+#ifndef ORDER_FRAME_H
+#define ORDER_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "utf8_validator.h"
+
+struct os_mbuf;
+
+#define ORDER_FRAME_MARKER       0xF0
+#define ORDER_FRAME_MARKER_MASK  0xF0
+#define ORDER_FRAME_FLAG_FINAL   0x01
+#define ORDER_FRAME_SEQ_HI_MASK  0x0E
+#define ORDER_FRAME_SEQ_HI_SHIFT 7      // 首字节bit1-3移到序号的bit8-10
+#define ORDER_FRAME_SEQ_MAX      0x7FF
+#define ORDER_FRAME_HDR_LEN      4
+
+// 最小MTU（23）下每个分片带16字节数据，2048个分片可以传完最长的消息（32768字节）
+#define ORDER_FRAME_HDR_SEQ(hdr) \
+    ((uint16_t)(hdr)[1] | ((uint16_t)((hdr)[0] & ORDER_FRAME_SEQ_HI_MASK) << ORDER_FRAME_SEQ_HI_SHIFT))
+
+/**
+ * @brief 完整消息交付回调
+ *
+ * @param msg 以'\0'结尾的消息（来自缓冲池）
+ * @param len 消息长度
+ * @param conn_handle 消息来自的连接（重组状态中的conn_handle）
+ * @return esp_err_t 返回ESP_OK表示接管缓冲区，之后需调用order_frame_buf_release释放；
+ *                   否则缓冲区由重组层回收
+ */
+typedef esp_err_t (*order_frame_deliver_t)(char *msg, size_t len, uint16_t conn_handle);
+
+/**
+ * @brief 单个连接的重组状态
+ */
+typedef struct {
+    char *buf;                      // 当前消息缓冲区（来自缓冲池）
+    uint16_t total;                 // 消息总长度
+    uint16_t received;              // 已接收长度
+    uint16_t next_seq;              // 期望的下一个分片序号
+    uint16_t delivered;             // 本连接已交付的分片消息数（用于应用层确认）
+    uint16_t conn_handle;           // 所属连接，交付时原样传给回调（由会话在初始化后设置）
+    bool text;                      // 是否为文本消息（需校验UTF-8）
+    utf8_state_t utf8;              // 跨分片的UTF-8校验状态
+    order_frame_deliver_t deliver;  // 完整消息交付回调
+} order_frame_ctx_t;
+
+/**
+ * @brief 重组统计信息
+ */
+typedef struct {
+    uint32_t fragments;        // 收到的分片数
+    uint32_t messages;         // 交付的完整消息数
+    uint64_t payload_bytes;    // 交付的消息总字节数
+    uint32_t seq_errors;       // 序号错误
+    uint32_t len_errors;       // 长度错误（超长或与总长度不符）
+    uint32_t utf8_errors;      // 文本消息UTF-8编码错误
+    uint32_t pool_exhausted;   // 缓冲池耗尽次数
+    uint32_t rejected;         // 交付失败（接入队列满）次数
+    int64_t first_us;          // 第一条消息开始接收的时间
+    int64_t last_us;           // 最近一条消息交付的时间
+} order_frame_stats_t;
+
+/**
+ * @brief 初始化重组缓冲池
+ *
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t order_frame_pool_init(void);
+
+/**
+ * @brief 释放缓冲池中的缓冲区
+ *
+ * @param buf 缓冲区指针
+ */
+void order_frame_buf_release(char *buf);
+
+/**
+ * @brief 初始化连接的重组状态
+ *
+ * @param ctx 重组状态
+ * @param deliver 完整消息交付回调
+ */
+void order_frame_ctx_init(order_frame_ctx_t *ctx, order_frame_deliver_t deliver);
+
+/**
+ * @brief 丢弃未完成的消息并归还缓冲区（断开连接时调用）
+ *
+ * @param ctx 重组状态
+ */
+void order_frame_ctx_reset(order_frame_ctx_t *ctx);
+
+/**
+ * @brief 处理一次特征值写入
+ *
+ * @param ctx 重组状态
+ * @param om 写入数据
+ * @return int 0成功，否则为BLE_ATT_ERR_*错误码
+ */
+int order_frame_receive(order_frame_ctx_t *ctx, const struct os_mbuf *om);
+
+/**
+ * @brief 获取统计信息快照
+ *
+ * @param out 输出统计信息
+ */
+void order_frame_get_stats(order_frame_stats_t *out);
+
+/**
+ * @brief 清零统计信息（性能测试结束后调用，之后的统计只反映真实流量）
+ */
+void order_frame_reset_stats(void);
+
+/**
+ * @brief 计算已接收订单数据的吞吐量
+ *
+ * @param stats 统计信息
+ * @return uint32_t 字节/秒
+ */
+uint32_t order_frame_bytes_per_sec(const order_frame_stats_t *stats);
+
+/**
+ * @brief 打印统计信息
+ */
+void order_frame_log_stats(void);
+
+#endif // ORDER_FRAME_H
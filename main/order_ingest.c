@@ -0,0 +1,159 @@
+/**
+ * @file order_ingest.c
+ * @brief 蓝牙订单消息接入队列实现
+ */
+
+#include "order_ingest.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/esp-bsp.h"
+#include "bsp/display.h"
+
+static const char *TAG = "OrderIngest";
+
+// 队列中的消息（处理完成后由工作任务释放）
+typedef struct {
+    char *data;
+    size_t len;
+    uint16_t source;
+    order_ingest_release_t release;
+} ingest_msg_t;
+
+static QueueHandle_t s_queue = NULL;
+static order_ingest_handler_t s_handler = NULL;
+static order_ingest_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 工作任务：阻塞等待第一条消息，再无等待地取完当前积压，整批在一次显示锁内处理
+static void ingest_task(void *arg)
+{
+    ingest_msg_t batch[CONFIG_ORDER_INGEST_MAX_BATCH];
+
+    for (;;) {
+        size_t count = 0;
+        if (xQueueReceive(s_queue, &batch[count], portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        count++;
+        while (count < CONFIG_ORDER_INGEST_MAX_BATCH &&
+               xQueueReceive(s_queue, &batch[count], 0) == pdTRUE) {
+            count++;
+        }
+
+        int64_t wait_start = esp_timer_get_time();
+        bsp_display_lock(portMAX_DELAY);
+        uint32_t wait_us = (uint32_t)(esp_timer_get_time() - wait_start);
+
+        for (size_t i = 0; i < count; i++) {
+            s_handler(batch[i].data, batch[i].len, batch[i].source);
+        }
+
+        bsp_display_unlock();
+
+        for (size_t i = 0; i < count; i++) {
+            batch[i].release(batch[i].data);
+        }
+
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.processed += count;
+        s_stats.batches++;
+        s_stats.last_batch_size = count;
+        if (count > s_stats.max_batch_size) {
+            s_stats.max_batch_size = count;
+        }
+        s_stats.lock_wait_us_last = wait_us;
+        s_stats.lock_wait_us_total += wait_us;
+        if (wait_us > s_stats.lock_wait_us_max) {
+            s_stats.lock_wait_us_max = wait_us;
+        }
+        portEXIT_CRITICAL(&s_stats_lock);
+    }
+}
+
+esp_err_t order_ingest_init(order_ingest_handler_t handler)
+{
+    if (!handler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_handler = handler;
+    s_queue = xQueueCreate(CONFIG_ORDER_INGEST_QUEUE_LEN, sizeof(ingest_msg_t));
+    if (!s_queue) {
+        ESP_LOGE(TAG, "创建接入队列失败");
+        return ESP_ERR_NO_MEM;
+    }
+
+    BaseType_t ret = xTaskCreate(ingest_task, "order_ingest", CONFIG_ORDER_INGEST_TASK_STACK,
+                                 NULL, CONFIG_ORDER_INGEST_TASK_PRIORITY, NULL);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "创建接入任务失败");
+        vQueueDelete(s_queue);
+        s_queue = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t order_ingest_submit(char *msg, size_t len, uint16_t source, order_ingest_release_t release)
+{
+    if (!s_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!msg || len == 0 || !release) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ingest_msg_t item = {
+        .data = msg,
+        .len = len,
+        .source = source,
+        .release = release,
+    };
+
+    if (xQueueSend(s_queue, &item, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.dropped++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t depth = uxQueueMessagesWaiting(s_queue);
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.submitted++;
+    if (depth > s_stats.queue_depth_max) {
+        s_stats.queue_depth_max = depth;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    return ESP_OK;
+}
+
+void order_ingest_get_stats(order_ingest_stats_t *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+    out->queue_depth = s_queue ? uxQueueMessagesWaiting(s_queue) : 0;
+}
+
+void order_ingest_log_stats(void)
+{
+    order_ingest_stats_t stats;
+    order_ingest_get_stats(&stats);
+
+    uint32_t avg_wait_us = stats.batches ? (uint32_t)(stats.lock_wait_us_total / stats.batches) : 0;
+    ESP_LOGI(TAG, "队列深度 %lu (峰值 %lu), 入队 %lu, 丢弃 %lu, 已处理 %lu",
+             stats.queue_depth, stats.queue_depth_max, stats.submitted, stats.dropped, stats.processed);
+    ESP_LOGI(TAG, "批次 %lu, 批大小 %lu (峰值 %lu), 锁等待 %luus (平均 %luus, 峰值 %luus)",
+             stats.batches, stats.last_batch_size, stats.max_batch_size,
+             stats.lock_wait_us_last, avg_wait_us, stats.lock_wait_us_max);
+}
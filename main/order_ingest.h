@@ -0,0 +1,78 @@
+/**
+ * @file order_ingest.h
+ * @brief 蓝牙订单消息接入队列
+ *
+ * NimBLE主机任务只负责把收到的数据拷贝进有界队列，由独立的工作任务批量取出，
+ * 在一次显示锁内完成所有UI更新，避免长时间重绘阻塞蓝牙协议栈。
+ */
+
+#ifndef ORDER_INGEST_H
+#define ORDER_INGEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+/**
+ * @brief 消息处理回调（在工作任务中调用，调用时已持有显示锁）
+ *
+ * @param msg 以'\0'结尾的消息内容，回调内可原地修改
+ * @param len 消息长度（不含结尾'\0'）
+ * @param source 提交时给出的消息来源（连接句柄）
+ */
+typedef void (*order_ingest_handler_t)(char *msg, size_t len, uint16_t source);
+
+/**
+ * @brief 消息缓冲区释放回调（处理完成后在工作任务中调用）
+ */
+typedef void (*order_ingest_release_t)(char *msg);
+
+/**
+ * @brief 接入队列统计信息
+ */
+typedef struct {
+    uint32_t submitted;          // 已入队消息数
+    uint32_t dropped;            // 队列满被拒绝的消息数
+    uint32_t processed;          // 已处理消息数
+    uint32_t queue_depth;        // 当前队列深度
+    uint32_t queue_depth_max;    // 队列深度峰值
+    uint32_t batches;            // 已处理批次数
+    uint32_t last_batch_size;    // 最近一批的消息数
+    uint32_t max_batch_size;     // 单批最大消息数
+    uint32_t lock_wait_us_last;  // 最近一次等待显示锁的时间（微秒）
+    uint32_t lock_wait_us_max;   // 等待显示锁的最长时间（微秒）
+    uint64_t lock_wait_us_total; // 等待显示锁的累计时间（微秒）
+} order_ingest_stats_t;
+
+/**
+ * @brief 创建接入队列和工作任务
+ *
+ * @param handler 消息处理回调
+ * @return esp_err_t ESP_OK成功，其他为错误码
+ */
+esp_err_t order_ingest_init(order_ingest_handler_t handler);
+
+/**
+ * @brief 提交一条消息（不拷贝、不阻塞）
+ *
+ * @param msg 以'\0'结尾的消息，成功时所有权转移给接入队列
+ * @param len 消息长度（不含结尾'\0'）
+ * @param source 消息来源（连接句柄），原样传给处理回调
+ * @param release 处理完成后释放缓冲区的回调
+ * @return esp_err_t ESP_OK成功，ESP_ERR_NO_MEM表示队列已满（缓冲区仍归调用者所有）
+ */
+esp_err_t order_ingest_submit(char *msg, size_t len, uint16_t source, order_ingest_release_t release);
+
+/**
+ * @brief 获取统计信息快照
+ *
+ * @param out 输出统计信息
+ */
+void order_ingest_get_stats(order_ingest_stats_t *out);
+
+/**
+ * @brief 打印统计信息
+ */
+void order_ingest_log_stats(void);
+
+#endif // ORDER_INGEST_H
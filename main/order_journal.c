@@ -0,0 +1,550 @@
+/**
+ * @file order_journal.c
+ * @brief 订单日志实现
+ */
+
+#include "order_journal.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "order_log.h"
+
+static const char *TAG = "OrderJournal";
+
+#define JOURNAL_SECTOR       4096
+#define JOURNAL_MAGIC        0x4C4E524Au   // "JRNL"
+#define JOURNAL_TASK_STACK   4096
+#define JOURNAL_TASK_PRIO    2
+#define JOURNAL_ALIGN(n)     (((n) + 3u) & ~3u)
+
+// 记录类型（0xFF为未写入的flash）
+enum {
+    JREC_PUT = 1,            // 订单全部内容（添加或更新）
+    JREC_SERVED = 2,         // 已出餐
+    JREC_DEL = 3,            // 删除
+    JREC_EMPTY = 0xFF,
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;            // 扇区序号，从1开始递增
+    uint32_t base_seq;       // 启用本扇区时的回放起点
+    uint32_t crc;            // 前12字节的CRC
+} jsec_hdr_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t id_len;
+    uint16_t len;            // 负载长度（不含头和对齐填充）
+    uint32_t crc;            // 头（crc字段为0）+ 负载的CRC
+} jrec_hdr_t;
+
+// PUT负载：订单ID、订单号(int32)、菜品数(uint16)、状态(uint8)、菜品名文本
+#define JREC_PUT_FIXED  (sizeof(int32_t) + sizeof(uint16_t) + sizeof(uint8_t))
+#define JREC_MAX        (JOURNAL_SECTOR - sizeof(jsec_hdr_t))
+
+static const esp_partition_t *s_part = NULL;
+static order_journal_config_t s_cfg;
+static RingbufHandle_t s_rb = NULL;
+static uint32_t s_sector_count;
+static uint32_t s_base_seq;          // 当前回放起点
+static uint32_t s_head_seq;          // 正在写入的扇区
+static uint32_t s_head_base;         // 正在写入的扇区头中记录的回放起点
+static uint16_t s_write_off;         // 扇区镜像中已追加的位置
+static uint16_t s_flushed_off;       // 已写入flash的位置
+static bool s_failed;                // flash出错后停止写入
+static volatile bool s_resync;       // 丢过记录，需要写快照
+static uint8_t s_sector[JOURNAL_SECTOR];   // 当前扇区镜像（回放时作读缓冲）
+static order_journal_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t sector_addr(uint32_t seq)
+{
+    return (seq % s_sector_count) * JOURNAL_SECTOR;
+}
+
+static uint32_t sec_hdr_crc(const jsec_hdr_t *hdr)
+{
+    return esp_rom_crc32_le(0, (const uint8_t *)hdr, offsetof(jsec_hdr_t, crc));
+}
+
+static bool sec_hdr_valid(const jsec_hdr_t *hdr, uint32_t index)
+{
+    return hdr->magic == JOURNAL_MAGIC && hdr->seq != 0 && hdr->seq % s_sector_count == index &&
+           hdr->base_seq <= hdr->seq && hdr->crc == sec_hdr_crc(hdr);
+}
+
+static uint32_t rec_crc(const jrec_hdr_t *hdr, const uint8_t *payload)
+{
+    jrec_hdr_t head = *hdr;
+    head.crc = 0;
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&head, sizeof(head));
+    return esp_rom_crc32_le(crc, payload, hdr->len);
+}
+
+// 记录编码后的长度（含头和填充）
+static size_t rec_size(uint8_t type, const order_rec_t *rec)
+{
+    size_t len = rec->id_len;
+    if (type == JREC_PUT) {
+        len += JREC_PUT_FIXED + rec->dish_bytes;
+    }
+    return JOURNAL_ALIGN(sizeof(jrec_hdr_t) + len);
+}
+
+// 编码一条记录，out至少有rec_size字节
+static void rec_encode(uint8_t *out, uint8_t type, const order_rec_t *rec)
+{
+    jrec_hdr_t hdr = {
+        .type = type,
+        .id_len = rec->id_len,
+        .len = rec->id_len,
+    };
+    uint8_t *p = out + sizeof(hdr);
+    memcpy(p, rec->order_id, rec->id_len);
+    p += rec->id_len;
+
+    if (type == JREC_PUT) {
+        int32_t order_num = rec->order_num;
+        uint16_t dish_count = rec->dish_count;
+        memcpy(p, &order_num, sizeof(order_num));
+        p += sizeof(order_num);
+        memcpy(p, &dish_count, sizeof(dish_count));
+        p += sizeof(dish_count);
+        *p++ = rec->status;
+        for (uint16_t i = 0; i < rec->dish_count; i++) {
+            uint16_t name_len = dish_intern_len(rec->dishes[i]);
+            memcpy(p, order_rec_dish(rec, i), name_len + 1);
+            p += name_len + 1;
+        }
+        hdr.len += JREC_PUT_FIXED + rec->dish_bytes;
+    }
+
+    // 对齐填充写0，保持为确定的内容
+    size_t total = JOURNAL_ALIGN(sizeof(hdr) + hdr.len);
+    memset(p, 0, out + total - p);
+    hdr.crc = rec_crc(&hdr, out + sizeof(hdr));
+    memcpy(out, &hdr, sizeof(hdr));
+}
+
+// 把扇区镜像中未写入的部分写入flash
+static void journal_flush(void)
+{
+    if (s_failed || s_write_off == s_flushed_off) return;
+
+    esp_err_t err = esp_partition_write(s_part, sector_addr(s_head_seq) + s_flushed_off,
+                                        s_sector + s_flushed_off, s_write_off - s_flushed_off);
+    portENTER_CRITICAL(&s_stats_lock);
+    if (err == ESP_OK) {
+        s_stats.flushes++;
+        s_stats.bytes += s_write_off - s_flushed_off;
+    } else {
+        s_stats.errors++;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (err != ESP_OK) {
+        DLOGE(TAG, "写入日志失败: %s，停止记录", esp_err_to_name(err));
+        s_failed = true;
+        return;
+    }
+    s_flushed_off = s_write_off;
+}
+
+// 擦除并启用扇区seq，扇区头立即写入
+static esp_err_t journal_open_sector(uint32_t seq)
+{
+    // 复用的扇区必须早于任何可能成为最新扇区的回放起点
+    if (seq - s_head_base >= s_sector_count) {
+        DLOGE(TAG, "日志区已满（快照过大），停止记录");
+        s_failed = true;
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint32_t addr = sector_addr(seq);
+    esp_err_t err = esp_partition_erase_range(s_part, addr, JOURNAL_SECTOR);
+    if (err == ESP_OK) {
+        jsec_hdr_t hdr = {
+            .magic = JOURNAL_MAGIC,
+            .seq = seq,
+            .base_seq = s_base_seq,
+        };
+        hdr.crc = sec_hdr_crc(&hdr);
+        memset(s_sector, 0xFF, sizeof(s_sector));
+        memcpy(s_sector, &hdr, sizeof(hdr));
+        err = esp_partition_write(s_part, addr, &hdr, sizeof(hdr));
+    }
+    if (err != ESP_OK) {
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.errors++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        DLOGE(TAG, "启用日志扇区失败: %s，停止记录", esp_err_to_name(err));
+        s_failed = true;
+        return err;
+    }
+
+    s_head_seq = seq;
+    s_head_base = s_base_seq;
+    s_write_off = sizeof(jsec_hdr_t);
+    s_flushed_off = sizeof(jsec_hdr_t);
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.sectors++;
+    portEXIT_CRITICAL(&s_stats_lock);
+    return ESP_OK;
+}
+
+// 把一条编码好的记录追加到扇区镜像，放不下时换到下一个扇区
+static void journal_place(const uint8_t *rec, size_t size)
+{
+    if (s_failed) return;
+
+    if (s_write_off + size > JOURNAL_SECTOR) {
+        journal_flush();
+        if (journal_open_sector(s_head_seq + 1) != ESP_OK) return;
+    }
+    memcpy(s_sector + s_write_off, rec, size);
+    s_write_off += size;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.records++;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+// 取出缓冲区中所有记录
+static void journal_drain(void)
+{
+    size_t size;
+    uint8_t *item;
+    while ((item = xRingbufferReceive(s_rb, &size, 0)) != NULL) {
+        journal_place(item, size);
+        vRingbufferReturnItem(s_rb, item);
+    }
+}
+
+// 写快照：当前所有订单按到达顺序写到新扇区，完成后以其为回放起点（启动回放时无需加锁）
+// 回放按同样的顺序重新添加，重启后订单列表的先后不变
+static void journal_compact(bool locked)
+{
+    // 锁内先取走快照之前的记录，之后进入缓冲区的记录都比快照新
+    if (locked) {
+        s_cfg.lock();
+        journal_drain();
+    }
+    s_resync = false;
+
+    size_t total = 0;
+    for (order_rec_t *rec = order_model_next(s_cfg.model, NULL); rec; rec = order_model_next(s_cfg.model, rec)) {
+        size_t size = rec_size(JREC_PUT, rec);
+        if (size <= JREC_MAX) total += size;
+    }
+    uint8_t *snap = total ? heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) : NULL;
+    if (total && !snap) {
+        if (locked) s_cfg.unlock();
+        DLOGW(TAG, "快照内存不足，稍后重试");
+        return;
+    }
+    uint8_t *p = snap;
+    for (order_rec_t *rec = order_model_next(s_cfg.model, NULL); rec; rec = order_model_next(s_cfg.model, rec)) {
+        size_t size = rec_size(JREC_PUT, rec);
+        if (size <= JREC_MAX) {
+            rec_encode(p, JREC_PUT, rec);
+            p += size;
+        }
+    }
+    if (locked) s_cfg.unlock();
+
+    // flash写入在锁外进行
+    journal_flush();
+    uint32_t snap_seq = s_head_seq + 1;
+    if (journal_open_sector(snap_seq) == ESP_OK) {
+        for (uint8_t *rec = snap; rec < p; ) {
+            const jrec_hdr_t *hdr = (const jrec_hdr_t *)rec;
+            size_t size = JOURNAL_ALIGN(sizeof(*hdr) + hdr->len);
+            journal_place(rec, size);
+            rec += size;
+        }
+        journal_flush();
+        if (!s_failed) {
+            // 换到新扇区，让新的回放起点立即落到扇区头中
+            s_base_seq = snap_seq;
+            journal_open_sector(s_head_seq + 1);
+            portENTER_CRITICAL(&s_stats_lock);
+            s_stats.compactions++;
+            portEXIT_CRITICAL(&s_stats_lock);
+            DLOGI(TAG, "快照完成: %u 个订单, %u 字节, 起始扇区 %lu",
+                  order_model_count(s_cfg.model), (unsigned)total, snap_seq);
+        }
+    }
+    heap_caps_free(snap);
+}
+
+// 一批记录放入扇区镜像之后：写入flash，日志区用量超过一半或丢过记录时写快照
+static void journal_commit(void)
+{
+    journal_flush();
+
+    if (!s_failed && (s_resync || s_head_seq - s_base_seq + 1 > s_sector_count / 2)) {
+        journal_compact(true);
+    }
+}
+
+static void journal_task(void *arg)
+{
+    const TickType_t window = pdMS_TO_TICKS(CONFIG_ORDER_JOURNAL_FLUSH_MS);
+
+    for (;;) {
+        size_t size;
+        uint8_t *item = xRingbufferReceive(s_rb, &size, portMAX_DELAY);
+
+        // 收到第一条记录后等待一个批量窗口，窗口内的记录合并为一次写入
+        TickType_t start = xTaskGetTickCount();
+        while (item) {
+            journal_place(item, size);
+            vRingbufferReturnItem(s_rb, item);
+            TickType_t elapsed = xTaskGetTickCount() - start;
+            if (elapsed >= window) break;
+            item = xRingbufferReceive(s_rb, &size, window - elapsed);
+        }
+        journal_commit();
+    }
+}
+
+// 模型变更：编码后放入缓冲区，由日志任务写入flash
+static void journal_on_event(order_model_event_t event, order_rec_t *rec, void *arg)
+{
+    uint8_t type;
+    switch (event) {
+    case ORDER_MODEL_ADDED:
+    case ORDER_MODEL_UPDATED:
+        type = JREC_PUT;
+        break;
+    case ORDER_MODEL_SERVED:
+        type = JREC_SERVED;
+        break;
+    case ORDER_MODEL_REMOVED:
+        type = JREC_DEL;
+        break;
+    default:
+        return;
+    }
+
+    size_t size = rec_size(type, rec);
+    void *buf = NULL;
+    if (size > JREC_MAX || xRingbufferSendAcquire(s_rb, &buf, size, 0) != pdTRUE) {
+        // 丢失的变更由下一次快照补齐
+        s_resync = true;
+        portENTER_CRITICAL(&s_stats_lock);
+        s_stats.dropped++;
+        portEXIT_CRITICAL(&s_stats_lock);
+        return;
+    }
+    rec_encode(buf, type, rec);
+    xRingbufferSendComplete(s_rb, buf);
+}
+
+// 把一条记录应用到模型
+static void journal_apply(const jrec_hdr_t *hdr, const uint8_t *payload)
+{
+    char order_id[ORDER_STORE_ID_MAX + 1];
+    if (hdr->id_len == 0 || hdr->id_len > ORDER_STORE_ID_MAX || hdr->id_len > hdr->len) return;
+    memcpy(order_id, payload, hdr->id_len);
+    order_id[hdr->id_len] = '\0';
+
+    if (hdr->type == JREC_DEL) {
+        order_model_remove(s_cfg.model, order_id);
+        return;
+    }
+    if (hdr->type == JREC_SERVED) {
+        order_model_mark_served(s_cfg.model, order_model_find(s_cfg.model, order_id));
+        return;
+    }
+    if (hdr->type != JREC_PUT || hdr->len < hdr->id_len + JREC_PUT_FIXED) return;
+
+    const uint8_t *p = payload + hdr->id_len;
+    int32_t order_num;
+    uint16_t dish_count;
+    memcpy(&order_num, p, sizeof(order_num));
+    p += sizeof(order_num);
+    memcpy(&dish_count, p, sizeof(dish_count));
+    p += sizeof(dish_count);
+    uint8_t status = *p++;
+
+    // 菜品名以'\0'分隔
+    dish_t dishes[ORDER_STORE_MAX_DISHES];
+    const uint8_t *end = payload + hdr->len;
+    uint16_t count = 0;
+    while (count < dish_count && count < ORDER_STORE_MAX_DISHES && p < end) {
+        const uint8_t *nul = memchr(p, '\0', end - p);
+        if (!nul) break;
+        dishes[count].name = (const char *)p;
+        dishes[count].name_len = nul - p;
+        count++;
+        p = nul + 1;
+    }
+
+    order_t order = {
+        .order_id = order_id,
+        .order_num = order_num,
+        .dish_count = count,
+        .dishes = dishes,
+    };
+    if (order_model_add(s_cfg.model, &order) == ESP_OK && status == ORDER_STATUS_COMPLETED) {
+        order_model_mark_served(s_cfg.model, order_model_find(s_cfg.model, order_id));
+    }
+}
+
+// 回放一个扇区，返回false表示扇区无效
+static bool journal_replay_sector(uint32_t seq)
+{
+    if (esp_partition_read(s_part, sector_addr(seq), s_sector, JOURNAL_SECTOR) != ESP_OK) {
+        s_stats.errors++;
+        return false;
+    }
+    const jsec_hdr_t *sec = (const jsec_hdr_t *)s_sector;
+    if (!sec_hdr_valid(sec, seq % s_sector_count) || sec->seq != seq) {
+        return false;
+    }
+
+    size_t off = sizeof(jsec_hdr_t);
+    while (off + sizeof(jrec_hdr_t) <= JOURNAL_SECTOR) {
+        jrec_hdr_t hdr;
+        memcpy(&hdr, s_sector + off, sizeof(hdr));
+        if (hdr.type == JREC_EMPTY) break;
+
+        size_t size = JOURNAL_ALIGN(sizeof(hdr) + hdr.len);
+        const uint8_t *payload = s_sector + off + sizeof(hdr);
+        if (off + size > JOURNAL_SECTOR || rec_crc(&hdr, payload) != hdr.crc) {
+            // 断电时写了一半的记录
+            DLOGW(TAG, "扇区 %lu 偏移 %u 处记录损坏，之后的记录忽略", seq, (unsigned)off);
+            break;
+        }
+        journal_apply(&hdr, payload);
+        s_stats.replayed++;
+        off += size;
+    }
+    return true;
+}
+
+// 找到最新扇区并回放，之后在新扇区上继续记录
+static esp_err_t journal_recover(void)
+{
+    int64_t start = esp_timer_get_time();
+    uint32_t head = 0;
+    uint32_t base = 0;
+
+    for (uint32_t i = 0; i < s_sector_count; i++) {
+        jsec_hdr_t hdr;
+        if (esp_partition_read(s_part, i * JOURNAL_SECTOR, &hdr, sizeof(hdr)) != ESP_OK) {
+            s_stats.errors++;
+            continue;
+        }
+        if (sec_hdr_valid(&hdr, i) && hdr.seq > head) {
+            head = hdr.seq;
+            base = hdr.base_seq;
+        }
+    }
+
+    if (head == 0) {
+        // 空日志区
+        s_base_seq = 1;
+        s_head_base = 1;
+        DLOGI(TAG, "日志区为空，从头开始记录 (%lu 个扇区)", s_sector_count);
+        return journal_open_sector(1);
+    }
+
+    uint32_t seq = base;
+    for (; seq <= head; seq++) {
+        if (!journal_replay_sector(seq)) {
+            DLOGW(TAG, "日志扇区 %lu 无效，回放中止", seq);
+            break;
+        }
+    }
+
+    s_base_seq = base;
+    s_head_base = base;
+    s_stats.recovered = order_model_count(s_cfg.model);
+    s_stats.replay_us = (uint32_t)(esp_timer_get_time() - start);
+    DLOGI(TAG, "回放扇区 %lu~%lu: %lu 条记录, 恢复 %lu 个订单, 耗时 %lu ms",
+          base, seq - 1, s_stats.replayed, s_stats.recovered, s_stats.replay_us / 1000);
+
+    // 回放不完整或日志已用超过一半时立即写快照，缩短下次回放
+    s_head_seq = head;
+    s_write_off = 0;
+    s_flushed_off = 0;
+    if (seq <= head || head + 1 - base > s_sector_count / 2) {
+        journal_compact(false);
+        if (s_failed) {
+            return ESP_FAIL;
+        }
+    }
+    // 新记录从新扇区开始，不写在可能损坏的记录之后（写过快照时已换到新扇区）
+    return s_head_seq == head ? journal_open_sector(head + 1) : ESP_OK;
+}
+
+esp_err_t order_journal_init(const order_journal_config_t *config)
+{
+    if (s_rb) {
+        return ESP_OK;
+    }
+    if (!config || !config->partition_label || !config->model || !config->lock || !config->unlock) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, config->partition_label);
+    if (!s_part) {
+        DLOGE(TAG, "找不到分区 %s", config->partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t size = (size_t)CONFIG_ORDER_JOURNAL_SIZE_KB * 1024;
+    if (size > s_part->size) {
+        size = s_part->size;
+    }
+    s_sector_count = size / JOURNAL_SECTOR;
+    if (s_sector_count < 4) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    s_cfg = *config;
+
+    esp_err_t err = journal_recover();
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    RingbufHandle_t rb = xRingbufferCreate(CONFIG_ORDER_JOURNAL_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    if (!rb) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_rb = rb;
+    if (xTaskCreate(journal_task, "order_journal", JOURNAL_TASK_STACK, NULL, JOURNAL_TASK_PRIO, NULL) != pdPASS) {
+        s_rb = NULL;
+        vRingbufferDelete(rb);
+        return ESP_ERR_NO_MEM;
+    }
+    return order_model_subscribe(s_cfg.model, journal_on_event, NULL);
+}
+
+void order_journal_get_stats(order_journal_stats_t *stats)
+{
+    if (!stats) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *stats = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void order_journal_log_stats(void)
+{
+    order_journal_stats_t stats;
+    order_journal_get_stats(&stats);
+
+    DLOGI(TAG, "日志: 扇区 %lu~%lu/%lu, 记录 %lu, 写入 %lu 次/%lu 字节, 擦除 %lu, 快照 %lu, 丢弃 %lu, 错误 %lu%s",
+          s_base_seq, s_head_seq, s_sector_count, stats.records, stats.flushes, stats.bytes,
+          stats.sectors, stats.compactions, stats.dropped, stats.errors, s_failed ? " (已停止)" : "");
+}
@@ -0,0 +1,72 @@
+/**
+ * @file order_journal.h
+ * @brief 订单日志：把订单变更追加写入storage分区，重启后回放恢复
+ *
+ * 日志区按4KB扇区组成环形，扇区序号seq只增不减，seq对应的扇区位置为seq % 扇区数：
+ *   - 扇区头：魔数、seq、base_seq（回放起点）和CRC，扇区启用时先擦除再写扇区头；
+ *   - 记录：8字节头（类型、ID长度、负载长度、CRC）+ 负载，按4字节对齐，不跨扇区；
+ *   - 模型变更只写入内存环形缓冲区，日志任务在批量窗口内合并后一次写入flash；
+ *   - 已用扇区超过一半时把当前所有订单写成快照，之后的扇区以快照起点为回放起点，
+ *     更早的扇区在环形复用时擦除；
+ *   - 断电时写了一半的记录CRC校验失败，回放到此为止。
+ * 启动时从最新扇区头的base_seq回放到最新扇区，恢复到订单模型中。
+ */
+
+#ifndef ORDER_JOURNAL_H
+#define ORDER_JOURNAL_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "order_model.h"
+
+/**
+ * @brief 日志配置
+ */
+typedef struct {
+    const char *partition_label;   // 数据分区名
+    order_model_t *model;          // 回放目标，同时订阅其变更
+    void (*lock)(void);            // 串行化模型访问（设备上为显示锁），压缩时使用
+    void (*unlock)(void);
+} order_journal_config_t;
+
+/**
+ * @brief 日志统计信息
+ */
+typedef struct {
+    uint32_t records;        // 写入的记录数（含快照）
+    uint32_t flushes;        // 批量写入次数
+    uint32_t bytes;          // 写入字节数
+    uint32_t sectors;        // 启用（擦除）的扇区数
+    uint32_t compactions;    // 快照次数
+    uint32_t dropped;        // 缓冲区满丢弃的记录数（之后强制写快照）
+    uint32_t errors;         // flash读写错误次数
+    uint32_t replayed;       // 启动时回放的记录数
+    uint32_t recovered;      // 启动时恢复的订单数
+    uint32_t replay_us;      // 启动回放耗时
+} order_journal_stats_t;
+
+/**
+ * @brief 回放日志并开始记录模型变更
+ *
+ * 需在模型创建后、其他观察者订阅前调用，回放产生的变更不会再次写入日志。
+ *
+ * @param config 日志配置
+ * @return esp_err_t
+ *         - ESP_OK 成功
+ *         - ESP_ERR_NOT_FOUND 找不到数据分区
+ *         - ESP_ERR_INVALID_SIZE 分区太小
+ *         - ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t order_journal_init(const order_journal_config_t *config);
+
+/**
+ * @brief 获取统计信息
+ */
+void order_journal_get_stats(order_journal_stats_t *stats);
+
+/**
+ * @brief 打印统计信息
+ */
+void order_journal_log_stats(void);
+
+#endif // ORDER_JOURNAL_H
@@ -0,0 +1,230 @@
+/**
+ * @file order_link.c
+ * @brief 蓝牙链路吞吐量调优实现
+ */
+
+#include "order_link.h"
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "order_log.h"
+#include "esp_timer.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "OrderLink";
+
+// 连接参数（间隔单位1.25ms，超时单位10ms）
+#define LINK_FAST_ITVL_MIN    6     // 7.5ms
+#define LINK_FAST_ITVL_MAX    12    // 15ms
+#define LINK_IDLE_ITVL_MIN    40    // 50ms
+#define LINK_IDLE_ITVL_MAX    56    // 70ms
+#define LINK_IDLE_LATENCY     4
+#define LINK_SUPERVISION_TMO  400   // 4s
+
+// 数据长度扩展：单个链路层包最多251字节
+#define LINK_DLE_TX_OCTETS    251
+#define LINK_DLE_TX_TIME      2120
+
+static order_link_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 请求连接参数；只有请求被接受后才记为当前模式
+// 上一次更新尚未完成时控制器返回BLE_HS_EALREADY，记下要求的模式，连接参数更新后重发
+static void link_request_params(order_link_t *link, bool fast)
+{
+    link->want_fast = fast;
+#if CONFIG_ORDER_LINK_HIGH_THROUGHPUT
+    const struct ble_gap_upd_params params = {
+        .itvl_min = fast ? LINK_FAST_ITVL_MIN : LINK_IDLE_ITVL_MIN,
+        .itvl_max = fast ? LINK_FAST_ITVL_MAX : LINK_IDLE_ITVL_MAX,
+        .latency = fast ? 0 : LINK_IDLE_LATENCY,
+        .supervision_timeout = LINK_SUPERVISION_TMO,
+    };
+    int rc = ble_gap_update_params(link->conn_handle, &params);
+    if (rc == BLE_HS_EALREADY) {
+        link->pending = true;
+        return;
+    }
+    link->pending = false;
+    if (rc != 0) {
+        DLOGW(TAG, "请求连接参数失败: conn=%d rc=%d", link->conn_handle, rc);
+        return;
+    }
+#endif
+    link->fast = fast;
+}
+
+// 结束当前突发并计入统计
+static void link_end_burst(order_link_t *link)
+{
+    if (link->burst_writes == 0) {
+        return;
+    }
+
+    // 持续时间至少算一个连接间隔
+    uint32_t itvl_us = (uint32_t)(link->conn_itvl ? link->conn_itvl : LINK_FAST_ITVL_MAX) * 1250;
+    uint64_t active_us = (uint64_t)(link->last_write_us - link->burst_start_us) + itvl_us;
+    uint32_t conn_events = (uint32_t)(active_us / itvl_us);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.bursts++;
+    s_stats.writes += link->burst_writes;
+    s_stats.bytes += link->burst_bytes;
+    s_stats.active_us += active_us;
+    s_stats.conn_events += conn_events;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    DLOGI(TAG, "突发结束: conn=%d 写入 %lu 次/%lu 字节, %llu us, %lu 个连接事件",
+             link->conn_handle, link->burst_writes, link->burst_bytes, active_us, conn_events);
+
+    link->burst_writes = 0;
+    link->burst_bytes = 0;
+}
+
+// 空闲超时：结束突发，恢复长连接间隔
+static void link_idle_cb(struct ble_npl_event *ev)
+{
+    order_link_t *link = ble_npl_event_get_arg(ev);
+    link_end_burst(link);
+    if ((link->fast || link->pending) && link->conn_handle != BLE_HS_CONN_HANDLE_NONE) {
+        link_request_params(link, false);
+    }
+}
+
+void order_link_init(order_link_t *link)
+{
+    memset(link, 0, sizeof(*link));
+    link->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    ble_npl_callout_init(&link->idle_timer, nimble_port_get_dflt_eventq(), link_idle_cb, link);
+}
+
+void order_link_on_connect(order_link_t *link, uint16_t conn_handle)
+{
+    ble_npl_callout_stop(&link->idle_timer);
+    link->conn_handle = conn_handle;
+    link->fast = false;
+    link->want_fast = false;
+    link->pending = false;
+    link->burst_writes = 0;
+    link->burst_bytes = 0;
+    link->acked = 0;
+    link->nacked = 0;
+    order_link_on_conn_update(link);
+
+#if CONFIG_ORDER_LINK_HIGH_THROUGHPUT
+    int rc = ble_gap_set_data_len(conn_handle, LINK_DLE_TX_OCTETS, LINK_DLE_TX_TIME);
+    if (rc != 0) {
+        DLOGW(TAG, "设置数据长度失败: conn=%d rc=%d", conn_handle, rc);
+    }
+    rc = ble_gap_set_prefered_le_phy(conn_handle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK,
+                                     BLE_GAP_LE_PHY_CODED_ANY);
+    if (rc != 0) {
+        DLOGW(TAG, "请求2M PHY失败: conn=%d rc=%d", conn_handle, rc);
+    }
+    link_request_params(link, false);
+#endif
+}
+
+void order_link_on_disconnect(order_link_t *link)
+{
+    ble_npl_callout_stop(&link->idle_timer);
+    link_end_burst(link);
+    link->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+}
+
+void order_link_on_conn_update(order_link_t *link)
+{
+    struct ble_gap_conn_desc desc;
+    if (ble_gap_conn_find(link->conn_handle, &desc) == 0) {
+        link->conn_itvl = desc.conn_itvl;
+        DLOGI(TAG, "连接参数: conn=%d 间隔 %u.%02u ms, 延迟 %u",
+                 link->conn_handle, desc.conn_itvl * 125 / 100, desc.conn_itvl * 125 % 100,
+                 desc.conn_latency);
+    }
+    if (link->pending) {
+        link_request_params(link, link->want_fast);
+    }
+}
+
+void order_link_on_write(order_link_t *link, uint16_t len)
+{
+    int64_t now = esp_timer_get_time();
+    if (link->burst_writes == 0) {
+        link->burst_start_us = now;
+    }
+    link->burst_writes++;
+    link->burst_bytes += len;
+    link->last_write_us = now;
+
+    // 短连接间隔的请求在等待上一次更新完成时不重复发
+    if (!link->fast && !(link->pending && link->want_fast)) {
+        link_request_params(link, true);
+    }
+    ble_npl_callout_reset(&link->idle_timer, ble_npl_time_ms_to_ticks32(CONFIG_ORDER_LINK_IDLE_MS));
+}
+
+void order_link_ack(order_link_t *link, uint16_t attr_handle, uint16_t delivered, int err)
+{
+    char msg[40];
+    int len;
+
+    if (err == 0) {
+        if (delivered == link->acked) {
+            return;
+        }
+        len = snprintf(msg, sizeof(msg), "{\"ack\":%u}", delivered);
+    } else {
+        uint16_t failed = delivered + 1;
+        if (failed == link->nacked) {
+            return;
+        }
+        link->nacked = failed;
+        len = snprintf(msg, sizeof(msg), "{\"nack\":%u,\"err\":%d}", failed, err);
+    }
+
+    int rc = BLE_HS_ENOMEM;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(msg, len);
+    if (om) {
+        rc = ble_gattc_notify_custom(link->conn_handle, attr_handle, om);
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    if (rc != 0) {
+        // 确认是累计的，丢失的确认由下一条覆盖；POS超时后也会重发
+        s_stats.ack_failures++;
+    } else if (err == 0) {
+        s_stats.acks++;
+    } else {
+        s_stats.nacks++;
+    }
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    if (rc == 0 && err == 0) {
+        link->acked = delivered;
+    }
+}
+
+void order_link_get_stats(order_link_stats_t *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void order_link_log_stats(void)
+{
+    order_link_stats_t stats;
+    order_link_get_stats(&stats);
+
+    uint64_t bytes_per_sec = stats.active_us ? stats.bytes * 1000000ULL / stats.active_us : 0;
+    // 每个连接事件的写入次数，保留两位小数
+    uint32_t writes_per_ce_x100 = stats.conn_events ? (uint32_t)((uint64_t)stats.writes * 100 / stats.conn_events) : 0;
+
+    DLOGI(TAG, "突发 %lu 次, 写入 %lu 次/%llu 字节, 吞吐 %llu B/s, 每连接事件 %lu.%02lu 次写入",
+             stats.bursts, stats.writes, stats.bytes, bytes_per_sec,
+             writes_per_ce_x100 / 100, writes_per_ce_x100 % 100);
+    DLOGI(TAG, "确认 %lu, 拒绝 %lu, 确认发送失败 %lu", stats.acks, stats.nacks, stats.ack_failures);
+}
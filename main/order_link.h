@@ -0,0 +1,115 @@
+/**
+ * @file order_link.h
+ * @brief 蓝牙链路吞吐量调优
+ *
+ * 高吞吐模式（CONFIG_ORDER_LINK_HIGH_THROUGHPUT）下：
+ *   - 订单特征值支持无响应写入，POS无需等待ATT响应即可连续发送分片；
+ *   - 分片消息收完后在通知特征值上回复应用层确认：
+ *       {"ack":N}            本连接前N条分片消息已接收（累计确认）
+ *       {"nack":N,"err":E}   第N条消息被拒绝，E为ATT错误码，POS应从第N条重发
+ *     未分片的旧版消息不回复确认；
+ *   - 连接后请求数据长度扩展（DLE）和2M PHY；
+ *   - 开始接收数据时切换到短连接间隔，空闲一段时间后恢复为省电的长间隔。
+ * 统计信息给出实际达到的有效数据吞吐量和每个连接事件的写入次数。
+ */
+
+#ifndef ORDER_LINK_H
+#define ORDER_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "host/ble_hs.h"
+
+/**
+ * @brief 单个连接的链路状态（只在主机任务中访问）
+ */
+typedef struct {
+    uint16_t conn_handle;
+    uint16_t conn_itvl;              // 当前连接间隔（1.25ms单位）
+    bool fast;                       // 短连接间隔的请求是否已被接受
+    bool want_fast;                  // 最近一次要求的模式
+    bool pending;                    // 请求因上一次更新未完成被推迟，连接参数更新后重发
+    struct ble_npl_callout idle_timer;
+    uint32_t burst_writes;           // 当前突发的写入次数
+    uint32_t burst_bytes;            // 当前突发的订单数据字节数（不含分片帧头）
+    int64_t burst_start_us;          // 当前突发开始时间
+    int64_t last_write_us;           // 最近一次写入时间
+    uint16_t acked;                  // 已确认的分片消息数
+    uint16_t nacked;                 // 最近拒绝的消息序号（同一条消息只拒绝一次）
+} order_link_t;
+
+/**
+ * @brief 链路统计信息（所有连接合计，只统计已结束的突发）
+ */
+typedef struct {
+    uint32_t bursts;          // 突发次数
+    uint32_t writes;          // 写入次数
+    uint64_t bytes;           // 订单数据字节数（不含分片帧头）
+    uint64_t active_us;       // 突发持续时间合计
+    uint32_t conn_events;     // 突发期间的连接事件数（按连接间隔估算）
+    uint32_t acks;            // 发出的确认数
+    uint32_t nacks;           // 发出的拒绝数
+    uint32_t ack_failures;    // 确认发送失败数
+} order_link_stats_t;
+
+/**
+ * @brief 初始化链路状态（需在nimble_port_init之后调用）
+ *
+ * @param link 链路状态
+ */
+void order_link_init(order_link_t *link);
+
+/**
+ * @brief 连接建立：请求DLE、2M PHY和空闲连接参数
+ *
+ * @param link 链路状态
+ * @param conn_handle 连接句柄
+ */
+void order_link_on_connect(order_link_t *link, uint16_t conn_handle);
+
+/**
+ * @brief 连接断开：结束当前突发
+ *
+ * @param link 链路状态
+ */
+void order_link_on_disconnect(order_link_t *link);
+
+/**
+ * @brief 连接参数已更新（BLE_GAP_EVENT_CONN_UPDATE），有被推迟的参数请求时重发
+ *
+ * @param link 链路状态
+ */
+void order_link_on_conn_update(order_link_t *link);
+
+/**
+ * @brief 记录一次写入，必要时切换到短连接间隔
+ *
+ * @param link 链路状态
+ * @param len 订单数据长度（不含分片帧头）
+ */
+void order_link_on_write(order_link_t *link, uint16_t len);
+
+/**
+ * @brief 回复分片消息确认
+ *
+ * @param link 链路状态
+ * @param attr_handle 通知特征值句柄
+ * @param delivered 本连接已交付的分片消息数
+ * @param err 0表示确认，否则为拒绝原因（ATT错误码）
+ */
+void order_link_ack(order_link_t *link, uint16_t attr_handle, uint16_t delivered, int err);
+
+/**
+ * @brief 获取统计信息快照
+ *
+ * @param out 输出统计信息
+ */
+void order_link_get_stats(order_link_stats_t *out);
+
+/**
+ * @brief 打印统计信息
+ */
+void order_link_log_stats(void);
+
+#endif // ORDER_LINK_H
@@ -0,0 +1,466 @@
+/**
+ * @file order_log.c
+ * @brief 延迟格式化的日志实现
+ */
+
+#include "order_log.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+
+static const char *TAG = "OrderLog";
+
+#define LOG_LINE_MAX     256
+#define LOG_SPEC_MAX     24
+#define LOG_MAX_TAGS     16
+#define LOG_TASK_STACK   3072
+#define LOG_TASK_PRIO    1
+#define LOG_STR_NULL     0xFFFFFFFFu   // 参数为NULL
+#define LOG_STR_FULL     0xFFFFFFFEu   // 字符串区已满，输出为空
+
+// 长度修饰对应的参数大小，主机测试可按32位目标（ILP32）覆盖
+#ifndef ORDER_LOG_SIZEOF_LONG
+#define ORDER_LOG_SIZEOF_LONG       sizeof(long)
+#endif
+#ifndef ORDER_LOG_SIZEOF_LONG_LONG
+#define ORDER_LOG_SIZEOF_LONG_LONG  sizeof(long long)
+#endif
+#ifndef ORDER_LOG_SIZEOF_SIZE_T
+#define ORDER_LOG_SIZEOF_SIZE_T     sizeof(size_t)
+#endif
+#ifndef ORDER_LOG_SIZEOF_PTRDIFF_T
+#define ORDER_LOG_SIZEOF_PTRDIFF_T  sizeof(ptrdiff_t)
+#endif
+
+// 缓冲区中的一条记录：参数字之后紧跟拷贝的字符串
+typedef struct {
+    uint32_t timestamp;      // 记录时间（毫秒）
+    const char *tag;
+    const char *format;
+    uint8_t level;
+    uint8_t nwords;          // 有效参数字数，超出时剩余转换原样输出
+    uint16_t str_len;        // 字符串区字节数
+    uint32_t words[ORDER_LOG_MAX_WORDS];
+    char str[ORDER_LOG_MAX_STR];
+} log_rec_t;
+
+typedef enum {
+    ARG_NONE,    // %%或不支持的转换
+    ARG_INT,
+    ARG_LL,
+    ARG_DOUBLE,
+    ARG_STR,
+    ARG_PTR,
+} log_arg_t;
+
+// 每个tag的令牌桶
+typedef struct {
+    const char *tag;
+    uint32_t tokens;
+    uint32_t last_ms;
+} log_bucket_t;
+
+static RingbufHandle_t s_rb = NULL;
+static log_bucket_t s_buckets[LOG_MAX_TAGS];
+static order_log_stats_t s_stats = {0};
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 解析'%'之后的一个转换说明，返回说明之后的位置
+static const char *spec_parse(const char *p, log_arg_t *kind, int *stars)
+{
+    size_t size = sizeof(int);
+    int longs = 0;
+
+    *stars = 0;
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') {
+        (*stars)++;
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            (*stars)++;
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    // 按'l'的个数区分long和long long（32位目标上int与long同为4字节，不能按当前大小判断）
+    for (;; p++) {
+        if (*p == 'h') continue;
+        else if (*p == 'l') size = ++longs == 1 ? ORDER_LOG_SIZEOF_LONG : ORDER_LOG_SIZEOF_LONG_LONG;
+        else if (*p == 'z') size = ORDER_LOG_SIZEOF_SIZE_T;
+        else if (*p == 't') size = ORDER_LOG_SIZEOF_PTRDIFF_T;
+        else if (*p == 'j') size = ORDER_LOG_SIZEOF_LONG_LONG;
+        else break;
+    }
+
+    switch (*p) {
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        *kind = size > sizeof(uint32_t) ? ARG_LL : ARG_INT;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *kind = ARG_DOUBLE;
+        break;
+    case 's':
+        *kind = ARG_STR;
+        break;
+    case 'p':
+        *kind = ARG_PTR;
+        break;
+    case '\0':
+        *kind = ARG_NONE;
+        return p;
+    default:
+        *kind = ARG_NONE;
+        break;
+    }
+    return p + 1;
+}
+
+// 转换说明的精度：没有精度时返回-1，精度由参数给出（".*"）时返回LOG_PREC_STAR
+#define LOG_PREC_STAR -2
+static int spec_precision(const char *p)
+{
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') p++;
+    while (*p >= '0' && *p <= '9') p++;
+    if (*p != '.') {
+        return -1;
+    }
+    p++;
+    if (*p == '*') {
+        return LOG_PREC_STAR;
+    }
+    int prec = 0;
+    while (*p >= '0' && *p <= '9') {
+        prec = prec * 10 + (*p++ - '0');
+    }
+    return prec;
+}
+
+// 参数占用的字数
+static int arg_words(log_arg_t kind)
+{
+    switch (kind) {
+    case ARG_LL:
+    case ARG_DOUBLE:
+        return 2;
+    case ARG_PTR:
+        return (sizeof(void *) + 3) / 4;
+    case ARG_NONE:
+        return 0;
+    default:
+        return 1;
+    }
+}
+
+// 按格式字符串取出参数并存入记录
+static void log_capture(log_rec_t *rec, va_list ap)
+{
+    const char *p = rec->format;
+    uint8_t n = 0;
+    uint16_t str_len = 0;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        log_arg_t kind;
+        int stars;
+        int prec = spec_precision(p + 1);
+        p = spec_parse(p + 1, &kind, &stars);
+        if (kind == ARG_NONE) {
+            continue;
+        }
+        if (n + stars + arg_words(kind) > ORDER_LOG_MAX_WORDS) {
+            break;
+        }
+        for (int i = 0; i < stars; i++) {
+            rec->words[n++] = (uint32_t)va_arg(ap, int);
+        }
+        if (prec == LOG_PREC_STAR) {
+            // 精度参数在最后一个'*'，负数等于没有精度
+            prec = (int)rec->words[n - 1];
+        }
+
+        switch (kind) {
+        case ARG_INT:
+            rec->words[n++] = va_arg(ap, unsigned int);
+            break;
+        case ARG_LL: {
+            unsigned long long v = va_arg(ap, unsigned long long);
+            memcpy(&rec->words[n], &v, sizeof(v));
+            n += 2;
+            break;
+        }
+        case ARG_DOUBLE: {
+            double v = va_arg(ap, double);
+            memcpy(&rec->words[n], &v, sizeof(v));
+            n += 2;
+            break;
+        }
+        case ARG_PTR: {
+            void *v = va_arg(ap, void *);
+            memcpy(&rec->words[n], &v, sizeof(v));
+            n += arg_words(ARG_PTR);
+            break;
+        }
+        case ARG_STR: {
+            const char *s = va_arg(ap, const char *);
+            if (!s || str_len + 1 >= ORDER_LOG_MAX_STR) {
+                rec->words[n++] = s ? LOG_STR_FULL : LOG_STR_NULL;
+                break;
+            }
+            // 带精度的字符串可以不以'\0'结尾，最多只读精度给出的字节数
+            size_t room = ORDER_LOG_MAX_STR - str_len - 1;
+            if (prec >= 0 && (size_t)prec < room) {
+                room = prec;
+            }
+            size_t len = strnlen(s, room);
+            memcpy(rec->str + str_len, s, len);
+            rec->str[str_len + len] = '\0';
+            rec->words[n++] = str_len;
+            str_len += len + 1;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    rec->nwords = n;
+    rec->str_len = str_len;
+}
+
+// 用记录中的参数格式化一个转换说明
+static int log_format_one(char *out, size_t size, const char *spec, log_arg_t kind,
+                          int stars, const int *star_vals, const log_rec_t *rec, uint8_t *w)
+{
+#define LOG_SNPRINTF(val) (stars == 0 ? snprintf(out, size, spec, val) :                  \
+                           stars == 1 ? snprintf(out, size, spec, star_vals[0], val) :    \
+                           snprintf(out, size, spec, star_vals[0], star_vals[1], val))
+    switch (kind) {
+    case ARG_INT:
+        return LOG_SNPRINTF(rec->words[(*w)++]);
+    case ARG_LL: {
+        unsigned long long v;
+        memcpy(&v, &rec->words[*w], sizeof(v));
+        *w += 2;
+        return LOG_SNPRINTF(v);
+    }
+    case ARG_DOUBLE: {
+        double v;
+        memcpy(&v, &rec->words[*w], sizeof(v));
+        *w += 2;
+        return LOG_SNPRINTF(v);
+    }
+    case ARG_PTR: {
+        void *v;
+        memcpy(&v, &rec->words[*w], sizeof(v));
+        *w += arg_words(ARG_PTR);
+        return LOG_SNPRINTF(v);
+    }
+    case ARG_STR: {
+        uint32_t off = rec->words[(*w)++];
+        const char *str = off == LOG_STR_NULL ? "(null)" : off == LOG_STR_FULL ? "" : rec->str + off;
+        return LOG_SNPRINTF(str);
+    }
+    default:
+        return 0;
+    }
+#undef LOG_SNPRINTF
+}
+
+// 把记录格式化为一行文本
+static void log_format(const log_rec_t *rec, char *line, size_t size)
+{
+    const char *p = rec->format;
+    size_t pos = 0;
+    uint8_t w = 0;
+
+    while (*p && pos + 1 < size) {
+        if (*p != '%') {
+            line[pos++] = *p++;
+            continue;
+        }
+
+        log_arg_t kind;
+        int stars;
+        const char *end = spec_parse(p + 1, &kind, &stars);
+        size_t spec_len = end - p;
+
+        if (kind == ARG_NONE || spec_len >= LOG_SPEC_MAX ||
+            w + stars + arg_words(kind) > rec->nwords) {
+            // %%输出一个'%'，其他无法格式化的说明原样输出
+            if (spec_len == 2 && p[1] == '%') {
+                line[pos++] = '%';
+            } else {
+                size_t copy = spec_len < size - 1 - pos ? spec_len : size - 1 - pos;
+                memcpy(line + pos, p, copy);
+                pos += copy;
+            }
+            p = end;
+            continue;
+        }
+
+        char spec[LOG_SPEC_MAX];
+        memcpy(spec, p, spec_len);
+        spec[spec_len] = '\0';
+
+        int star_vals[2] = {0};
+        for (int i = 0; i < stars; i++) {
+            star_vals[i] = (int)rec->words[w++];
+        }
+
+        int written = log_format_one(line + pos, size - pos, spec, kind, stars, star_vals, rec, &w);
+        if (written > 0) {
+            pos += (size_t)written < size - pos ? (size_t)written : size - pos - 1;
+        }
+        p = end;
+    }
+    line[pos] = '\0';
+}
+
+static void log_print(const log_rec_t *rec)
+{
+    char line[LOG_LINE_MAX];
+    log_format(rec, line, sizeof(line));
+    ESP_LOG_LEVEL((esp_log_level_t)rec->level, rec->tag, "(%lu) %s", (unsigned long)rec->timestamp, line);
+}
+
+// 令牌桶限流，返回是否允许写入
+static bool log_rate_allow(const char *tag, uint32_t now_ms)
+{
+#if CONFIG_ORDER_LOG_RATE_LIMIT > 0
+    const uint32_t rate = CONFIG_ORDER_LOG_RATE_LIMIT;
+    bool allow = true;
+
+    portENTER_CRITICAL(&s_lock);
+    log_bucket_t *bucket = NULL;
+    for (int i = 0; i < LOG_MAX_TAGS; i++) {
+        if (s_buckets[i].tag == tag || !s_buckets[i].tag) {
+            bucket = &s_buckets[i];
+            break;
+        }
+    }
+    if (bucket) {
+        if (!bucket->tag) {
+            bucket->tag = tag;
+            bucket->tokens = rate;
+            bucket->last_ms = now_ms;
+        }
+        uint32_t refill = (now_ms - bucket->last_ms) * rate / 1000;
+        if (refill > 0) {
+            bucket->tokens = bucket->tokens + refill > rate ? rate : bucket->tokens + refill;
+            bucket->last_ms = now_ms;
+        }
+        if (bucket->tokens > 0) {
+            bucket->tokens--;
+        } else {
+            allow = false;
+            s_stats.dropped_rate++;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return allow;
+#else
+    return true;
+#endif
+}
+
+void order_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    log_rec_t rec;
+    rec.timestamp = esp_log_timestamp();
+
+    if (level > ESP_LOG_ERROR && !log_rate_allow(tag, rec.timestamp)) {
+        return;
+    }
+
+    rec.tag = tag;
+    rec.format = format;
+    rec.level = level;
+
+    va_list ap;
+    va_start(ap, format);
+    log_capture(&rec, ap);
+    va_end(ap);
+
+    // 输出任务启动前直接打印
+    if (!s_rb) {
+        log_print(&rec);
+        return;
+    }
+
+    size_t size = offsetof(log_rec_t, str) + rec.str_len;
+    if (xRingbufferSend(s_rb, &rec, size, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_lock);
+        s_stats.dropped_full++;
+        portEXIT_CRITICAL(&s_lock);
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    s_stats.written++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+// 输出任务：逐条格式化并打印，定期报告丢弃数
+static void log_task(void *arg)
+{
+    uint32_t reported_drops = 0;
+
+    for (;;) {
+        size_t size = 0;
+        log_rec_t *rec = xRingbufferReceive(s_rb, &size, pdMS_TO_TICKS(1000));
+        if (rec) {
+            log_print(rec);
+            vRingbufferReturnItem(s_rb, rec);
+            portENTER_CRITICAL(&s_lock);
+            s_stats.printed++;
+            portEXIT_CRITICAL(&s_lock);
+        }
+
+        order_log_stats_t stats;
+        order_log_get_stats(&stats);
+        uint32_t drops = stats.dropped_full + stats.dropped_rate;
+        if (drops != reported_drops && !rec) {
+            ESP_LOGW(TAG, "丢弃日志 %lu 条 (缓冲区满 %lu, 限流 %lu)",
+                     (unsigned long)(drops - reported_drops),
+                     (unsigned long)stats.dropped_full, (unsigned long)stats.dropped_rate);
+            reported_drops = drops;
+        }
+    }
+}
+
+esp_err_t order_log_init(void)
+{
+    if (s_rb) {
+        return ESP_OK;
+    }
+
+    RingbufHandle_t rb = xRingbufferCreate(CONFIG_ORDER_LOG_BUFFER_SIZE, RINGBUF_TYPE_NOSPLIT);
+    if (!rb) {
+        return ESP_ERR_NO_MEM;
+    }
+    s_rb = rb;
+    if (xTaskCreate(log_task, "order_log", LOG_TASK_STACK, NULL, LOG_TASK_PRIO, NULL) != pdPASS) {
+        s_rb = NULL;
+        vRingbufferDelete(rb);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void order_log_get_stats(order_log_stats_t *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_lock);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file order_log.h
+ * @brief 延迟格式化的日志
+ *
+ * 热路径（NimBLE主机任务、LVGL回调）中只把格式字符串指针和参数写入环形缓冲区，
+ * 由低优先级任务格式化后再输出到控制台，避免串口输出阻塞蓝牙协议栈。
+ *   - 格式字符串必须是字面量（记录中只保存指针）；
+ *   - %s参数在记录时拷贝，单条记录的字符串合计最多ORDER_LOG_MAX_STR字节，超出部分截断；
+ *   - 每个tag按CONFIG_ORDER_LOG_RATE_LIMIT条/秒限流，错误日志不限流；
+ *   - 缓冲区满或被限流的日志计入丢弃计数，由输出任务定期报告。
+ * 关闭CONFIG_ORDER_LOG_DEFERRED时DLOGx等同于ESP_LOGx。
+ */
+
+#ifndef ORDER_LOG_H
+#define ORDER_LOG_H
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_log.h"
+
+// 单条记录最多的参数字数（32位）和字符串字节数
+#define ORDER_LOG_MAX_WORDS  12
+#define ORDER_LOG_MAX_STR    96
+
+#if CONFIG_ORDER_LOG_DEFERRED
+#define DLOG_LEVEL(level, tag, format, ...) do {                        \
+        if (LOG_LOCAL_LEVEL >= (level)) {                               \
+            order_log_write((level), (tag), (format), ##__VA_ARGS__);   \
+        }                                                               \
+    } while (0)
+#else
+#define DLOG_LEVEL(level, tag, format, ...) ESP_LOG_LEVEL_LOCAL(level, tag, format, ##__VA_ARGS__)
+#endif
+
+#define DLOGE(tag, format, ...) DLOG_LEVEL(ESP_LOG_ERROR, tag, format, ##__VA_ARGS__)
+#define DLOGW(tag, format, ...) DLOG_LEVEL(ESP_LOG_WARN, tag, format, ##__VA_ARGS__)
+#define DLOGI(tag, format, ...) DLOG_LEVEL(ESP_LOG_INFO, tag, format, ##__VA_ARGS__)
+#define DLOGD(tag, format, ...) DLOG_LEVEL(ESP_LOG_DEBUG, tag, format, ##__VA_ARGS__)
+#define DLOGV(tag, format, ...) DLOG_LEVEL(ESP_LOG_VERBOSE, tag, format, ##__VA_ARGS__)
+
+/**
+ * @brief 日志统计信息
+ */
+typedef struct {
+    uint32_t written;        // 写入缓冲区的记录数
+    uint32_t dropped_full;   // 缓冲区满丢弃的记录数
+    uint32_t dropped_rate;   // 被限流丢弃的记录数
+    uint32_t printed;        // 已输出的记录数
+} order_log_stats_t;
+
+/**
+ * @brief 创建日志缓冲区和输出任务
+ *
+ * 初始化之前的日志直接输出。
+ *
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t order_log_init(void);
+
+/**
+ * @brief 写入一条日志（不阻塞，不格式化）
+ *
+ * 支持的转换：%d %i %u %x %X %o %c %s %p %f %e %g %%，以及h/hh/l/ll/z/j/t长度修饰和*宽度/精度。
+ *
+ * @param level 日志级别
+ * @param tag 标签（需为静态字符串）
+ * @param format 格式字符串（需为静态字符串）
+ */
+void order_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief 获取统计信息快照
+ *
+ * @param out 输出统计信息
+ */
+void order_log_get_stats(order_log_stats_t *out);
+
+#endif // ORDER_LOG_H
@@ -0,0 +1,168 @@
+#include "order_model.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    order_model_observer_t cb;
+    void *arg;
+} order_model_sub_t;
+
+struct order_model {
+    order_store_t *store;
+    order_model_sub_t subs[ORDER_MODEL_MAX_OBSERVERS];
+    order_model_stats_t stats;
+};
+
+static void model_notify(order_model_t *model, order_model_event_t event, order_rec_t *rec)
+{
+    for (int i = 0; i < ORDER_MODEL_MAX_OBSERVERS; i++) {
+        if (model->subs[i].cb) {
+            model->subs[i].cb(event, rec, model->subs[i].arg);
+        }
+    }
+}
+
+order_model_t *order_model_create(uint16_t capacity)
+{
+    order_model_t *model = calloc(1, sizeof(*model));
+    if (!model) {
+        return NULL;
+    }
+    model->store = order_store_create(capacity);
+    if (!model->store) {
+        free(model);
+        return NULL;
+    }
+    return model;
+}
+
+void order_model_destroy(order_model_t *model)
+{
+    if (!model) return;
+    order_store_destroy(model->store);
+    free(model);
+}
+
+esp_err_t order_model_subscribe(order_model_t *model, order_model_observer_t cb, void *arg)
+{
+    if (!model || !cb) return ESP_ERR_INVALID_ARG;
+
+    for (int i = 0; i < ORDER_MODEL_MAX_OBSERVERS; i++) {
+        if (!model->subs[i].cb) {
+            model->subs[i].cb = cb;
+            model->subs[i].arg = arg;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void order_model_unsubscribe(order_model_t *model, order_model_observer_t cb, void *arg)
+{
+    if (!model) return;
+
+    for (int i = 0; i < ORDER_MODEL_MAX_OBSERVERS; i++) {
+        if (model->subs[i].cb == cb && model->subs[i].arg == arg) {
+            model->subs[i].cb = NULL;
+            model->subs[i].arg = NULL;
+        }
+    }
+}
+
+esp_err_t order_model_add(order_model_t *model, const order_t *order)
+{
+    if (!model) return ESP_ERR_INVALID_ARG;
+
+    order_rec_t *rec = NULL;
+    esp_err_t err = order_store_add(model->store, order, &rec);
+    if (err == ESP_ERR_INVALID_STATE) {
+        // 同一订单重复下发时按更新处理
+        return order_model_update(model, order);
+    }
+    if (err != ESP_OK) {
+        if (err == ESP_ERR_NO_MEM) {
+            model->stats.failed++;
+        }
+        return err;
+    }
+
+    model->stats.added++;
+    model_notify(model, ORDER_MODEL_ADDED, rec);
+    return ESP_OK;
+}
+
+esp_err_t order_model_update(order_model_t *model, const order_t *order)
+{
+    if (!model || !order) return ESP_ERR_INVALID_ARG;
+
+    order_rec_t *rec = order_store_find(model->store, order->order_id);
+    if (!rec) {
+        model->stats.not_found++;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t err = order_store_update(model->store, rec, order);
+    if (err != ESP_OK) {
+        model->stats.failed++;
+        return err;
+    }
+
+    model->stats.updated++;
+    model_notify(model, ORDER_MODEL_UPDATED, rec);
+    return ESP_OK;
+}
+
+esp_err_t order_model_remove(order_model_t *model, const char *order_id)
+{
+    if (!model) return ESP_ERR_INVALID_ARG;
+
+    order_rec_t *rec = order_store_find(model->store, order_id);
+    if (!rec) {
+        model->stats.not_found++;
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    rec->status = ORDER_STATUS_REMOVED;
+    model_notify(model, ORDER_MODEL_REMOVED, rec);
+    order_store_remove(model->store, rec);
+    model->stats.removed++;
+    return ESP_OK;
+}
+
+esp_err_t order_model_mark_served(order_model_t *model, order_rec_t *rec)
+{
+    if (!model || !rec || !rec->in_use) return ESP_ERR_INVALID_ARG;
+    if (rec->status != ORDER_STATUS_PENDING) return ESP_ERR_INVALID_STATE;
+
+    rec->status = ORDER_STATUS_COMPLETED;
+    model->stats.served++;
+    model_notify(model, ORDER_MODEL_SERVED, rec);
+    return ESP_OK;
+}
+
+order_rec_t *order_model_find(order_model_t *model, const char *order_id)
+{
+    return model ? order_store_find(model->store, order_id) : NULL;
+}
+
+order_rec_t *order_model_next(order_model_t *model, order_rec_t *prev)
+{
+    return model ? order_store_next(model->store, prev) : NULL;
+}
+
+uint16_t order_model_count(const order_model_t *model)
+{
+    return model ? order_store_count(model->store) : 0;
+}
+
+void order_model_get_stats(const order_model_t *model, order_model_stats_t *stats,
+                           order_store_stats_t *store_stats)
+{
+    if (!model) return;
+    if (stats) {
+        *stats = model->stats;
+    }
+    if (store_stats) {
+        order_store_get_stats(model->store, store_stats);
+    }
+}
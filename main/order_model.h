@@ -0,0 +1,133 @@
+/**
+ * @file order_model.h
+ * @brief 订单模型：与界面无关的订单状态和变更通知
+ *
+ * 模型只保存订单数据（基于order_store），不依赖LVGL和蓝牙：
+ *   - 协议层调用add/update/remove，界面调用mark_served；
+ *   - 每次变更同步通知所有观察者，界面和出餐通知都作为观察者订阅。
+ * 模型不加锁，由调用方保证串行调用（设备上所有调用都在显示锁内）。
+ * 只依赖标准C库和esp_err.h，可在主机上单独编译。
+ */
+
+#ifndef ORDER_MODEL_H
+#define ORDER_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "order_store.h"
+
+// 最多同时订阅的观察者数
+#define ORDER_MODEL_MAX_OBSERVERS  4
+
+// 变更类型
+typedef enum {
+    ORDER_MODEL_ADDED,       // 新订单
+    ORDER_MODEL_UPDATED,     // 订单号或菜品变化
+    ORDER_MODEL_SERVED,      // 已出餐
+    ORDER_MODEL_REMOVED,     // 即将删除（回调返回后记录被回收）
+} order_model_event_t;
+
+/**
+ * @brief 观察者回调（在发起变更的任务中同步调用）
+ *
+ * @param event 变更类型
+ * @param rec 订单记录，回调中可读写rec->view
+ * @param arg 订阅时传入的参数
+ */
+typedef void (*order_model_observer_t)(order_model_event_t event, order_rec_t *rec, void *arg);
+
+/**
+ * @brief 模型统计信息
+ */
+typedef struct {
+    uint32_t added;
+    uint32_t updated;
+    uint32_t served;
+    uint32_t removed;
+    uint32_t not_found;      // 更新/删除/出餐时订单不存在
+    uint32_t failed;         // 容量或内存不足导致的失败
+} order_model_stats_t;
+
+typedef struct order_model order_model_t;
+
+/**
+ * @brief 创建订单模型
+ *
+ * @param capacity 最多同时保存的订单数
+ * @return order_model_t* 失败返回NULL
+ */
+order_model_t *order_model_create(uint16_t capacity);
+
+/**
+ * @brief 释放订单模型（不通知观察者）
+ */
+void order_model_destroy(order_model_t *model);
+
+/**
+ * @brief 订阅变更通知
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 观察者已满
+ */
+esp_err_t order_model_subscribe(order_model_t *model, order_model_observer_t cb, void *arg);
+
+/**
+ * @brief 取消订阅（cb和arg都需与订阅时一致）
+ */
+void order_model_unsubscribe(order_model_t *model, order_model_observer_t cb, void *arg);
+
+/**
+ * @brief 添加订单，订单ID已存在时按更新处理
+ *
+ * @return esp_err_t
+ *         - ESP_OK 成功
+ *         - ESP_ERR_INVALID_ARG 订单内容无效
+ *         - ESP_ERR_NO_MEM 容量或内存不足
+ */
+esp_err_t order_model_add(order_model_t *model, const order_t *order);
+
+/**
+ * @brief 按订单ID更新订单号和菜品
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FOUND 订单不存在，ESP_ERR_NO_MEM 内存不足
+ */
+esp_err_t order_model_update(order_model_t *model, const order_t *order);
+
+/**
+ * @brief 按订单ID删除订单
+ *
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NOT_FOUND 订单不存在
+ */
+esp_err_t order_model_remove(order_model_t *model, const char *order_id);
+
+/**
+ * @brief 标记订单已出餐（重复标记不再通知）
+ *
+ * @param model 订单模型
+ * @param rec 订单记录
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_INVALID_STATE 已出餐
+ */
+esp_err_t order_model_mark_served(order_model_t *model, order_rec_t *rec);
+
+/**
+ * @brief 按订单ID查找
+ */
+order_rec_t *order_model_find(order_model_t *model, const char *order_id);
+
+/**
+ * @brief 按到达顺序遍历所有订单（从最早的开始）
+ */
+order_rec_t *order_model_next(order_model_t *model, order_rec_t *prev);
+
+/**
+ * @brief 当前订单数
+ */
+uint16_t order_model_count(const order_model_t *model);
+
+/**
+ * @brief 获取统计信息
+ */
+void order_model_get_stats(const order_model_t *model, order_model_stats_t *stats,
+                           order_store_stats_t *store_stats);
+
+#endif // ORDER_MODEL_H
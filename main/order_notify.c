@@ -0,0 +1,379 @@
+/**
+ * @file order_notify.c
+ * @brief 出餐通知发送队列实现
+ */
+
+#include "order_notify.h"
+#include <string.h>
+#include "esp_log.h"
+#include "order_log.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "OrderNotify";
+
+// 没有连接参数时使用的默认合并窗口
+#define NOTIFY_DEFAULT_WINDOW_MS 30
+
+// 通知内容缓冲区，只在主机任务中使用
+static char s_payload[BLE_ATT_MTU_MAX];
+
+static order_notify_stats_t s_stats = {0};
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#define NOTIFY_STAT_ADD(field, n) do {          \
+        portENTER_CRITICAL(&s_stats_lock);      \
+        s_stats.field += (n);                   \
+        portEXIT_CRITICAL(&s_stats_lock);       \
+    } while (0)
+
+static inline order_notify_slot_t *notify_slot(order_notify_queue_t *q, uint16_t i)
+{
+    return &q->ring[(q->head + i) % CONFIG_ORDER_NOTIFY_QUEUE_LEN];
+}
+
+// 追加一段文本
+static size_t payload_append(size_t pos, const char *str, size_t len)
+{
+    memcpy(s_payload + pos, str, len);
+    return pos + len;
+}
+
+// 拒绝通知：{"orderId":"...","status":false,"err":"..."}
+static size_t notify_build_reject(const order_notify_slot_t *slot)
+{
+    static const char id_head[] = "{\"orderId\":\"";
+    static const char id_tail[] = "\",";
+    static const char status[] = "\"status\":false,\"err\":\"";
+    size_t pos = 0;
+
+    if (slot->len > 0) {
+        pos = payload_append(pos, id_head, sizeof(id_head) - 1);
+        pos = payload_append(pos, slot->id, slot->len);
+        pos = payload_append(pos, id_tail, sizeof(id_tail) - 1);
+    } else {
+        s_payload[pos++] = '{';
+    }
+    pos = payload_append(pos, status, sizeof(status) - 1);
+    pos = payload_append(pos, slot->err, strlen(slot->err));
+    s_payload[pos++] = '"';
+    s_payload[pos++] = '}';
+    return pos;
+}
+
+// 从队头取尽量多的订单ID组成一条通知，返回包含的订单数
+// 第一个订单总会被取出（MTU过小时由协议栈截断，与旧版行为一致），之后的订单只在不超过limit时合并；
+// 拒绝通知不参与合并，单独发送
+static uint16_t notify_build(order_notify_queue_t *q, size_t limit, size_t *out_len)
+{
+    static const char single_head[] = "{\"orderId\":\"";
+    static const char single_tail[] = "\",\"status\":true}";
+    static const char multi_head[] = "{\"orderIds\":[";
+    static const char multi_tail[] = "],\"status\":true}";
+    size_t pos = 0;
+    uint16_t n = 0;
+
+    portENTER_CRITICAL(&q->lock);
+    if (q->count > 0 && notify_slot(q, 0)->err) {
+        *out_len = notify_build_reject(notify_slot(q, 0));
+        portEXIT_CRITICAL(&q->lock);
+        return 1;
+    }
+
+    size_t need = sizeof(multi_head) - 1 + sizeof(multi_tail) - 1;
+    while (n < q->count && !notify_slot(q, n)->err) {
+        need += notify_slot(q, n)->len + 2 + (n > 0 ? 1 : 0);
+        if (n > 0 && need > limit) {
+            break;
+        }
+        n++;
+    }
+
+    if (n == 1) {
+        const order_notify_slot_t *slot = notify_slot(q, 0);
+        pos = payload_append(pos, single_head, sizeof(single_head) - 1);
+        pos = payload_append(pos, slot->id, slot->len);
+        pos = payload_append(pos, single_tail, sizeof(single_tail) - 1);
+    } else if (n > 1) {
+        pos = payload_append(pos, multi_head, sizeof(multi_head) - 1);
+        for (uint16_t i = 0; i < n; i++) {
+            const order_notify_slot_t *slot = notify_slot(q, i);
+            if (i > 0) {
+                s_payload[pos++] = ',';
+            }
+            s_payload[pos++] = '"';
+            pos = payload_append(pos, slot->id, slot->len);
+            s_payload[pos++] = '"';
+        }
+        pos = payload_append(pos, multi_tail, sizeof(multi_tail) - 1);
+    }
+    portEXIT_CRITICAL(&q->lock);
+
+    *out_len = pos;
+    return n;
+}
+
+// 弹出队头的n个订单
+static void notify_pop(order_notify_queue_t *q, uint16_t n)
+{
+    portENTER_CRITICAL(&q->lock);
+    q->head = (q->head + n) % CONFIG_ORDER_NOTIFY_QUEUE_LEN;
+    q->count -= n;
+    portEXIT_CRITICAL(&q->lock);
+}
+
+// 连接的一个连接间隔（毫秒）
+static uint32_t notify_window_ms(uint16_t conn_handle)
+{
+    struct ble_gap_conn_desc desc;
+    if (ble_gap_conn_find(conn_handle, &desc) != 0) {
+        return NOTIFY_DEFAULT_WINDOW_MS;
+    }
+    // 连接间隔单位为1.25ms
+    uint32_t ms = (uint32_t)desc.conn_itvl * 5 / 4;
+    return ms > 0 ? ms : 1;
+}
+
+// 发送失败后稍后重试；队头通知连续失败CONFIG_ORDER_NOTIFY_MAX_ERRORS次后丢弃其中的n个订单，
+// 避免一条发不出去的通知卡住整个队列
+static void notify_retry_after_error(order_notify_queue_t *q, uint16_t n)
+{
+    if (n > 0 && ++q->errors >= CONFIG_ORDER_NOTIFY_MAX_ERRORS) {
+        notify_pop(q, n);
+        q->errors = 0;
+        NOTIFY_STAT_ADD(dropped, n);
+        DLOGW(TAG, "出餐通知连续发送失败，丢弃 %u 个订单: conn=%d", n, q->conn_handle);
+    }
+    if (q->count > 0) {
+        ble_npl_callout_reset(&q->timer, ble_npl_time_ms_to_ticks32(CONFIG_ORDER_NOTIFY_RETRY_MS));
+    }
+}
+
+static void notify_timer_cb(struct ble_npl_event *ev)
+{
+    order_notify_queue_flush(ble_npl_event_get_arg(ev));
+}
+
+void order_notify_queue_init(order_notify_queue_t *q)
+{
+    memset(q, 0, sizeof(*q));
+    portMUX_INITIALIZE(&q->lock);
+    q->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+    ble_npl_callout_init(&q->timer, nimble_port_get_dflt_eventq(), notify_timer_cb, q);
+}
+
+void order_notify_queue_bind(order_notify_queue_t *q, uint16_t conn_handle, uint16_t attr_handle)
+{
+    q->conn_handle = conn_handle;
+    q->attr_handle = attr_handle;
+    q->in_flight = 0;
+    q->errors = 0;
+    ble_npl_callout_stop(&q->timer);
+}
+
+void order_notify_queue_clear(order_notify_queue_t *q)
+{
+    portENTER_CRITICAL(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    portEXIT_CRITICAL(&q->lock);
+}
+
+static esp_err_t notify_push(order_notify_queue_t *q, uint16_t target, const char *order_id, size_t len,
+                             const char *err)
+{
+    portENTER_CRITICAL(&q->lock);
+    if (q->count == CONFIG_ORDER_NOTIFY_QUEUE_LEN) {
+        portEXIT_CRITICAL(&q->lock);
+        NOTIFY_STAT_ADD(dropped, 1);
+        DLOGW(TAG, "通知队列已满，丢弃订单 %.*s", (int)len, order_id);
+        return ESP_ERR_NO_MEM;
+    }
+    order_notify_slot_t *slot = notify_slot(q, q->count);
+    memcpy(slot->id, order_id, len);
+    slot->len = len;
+    slot->target = target;
+    slot->err = err;
+    q->count++;
+    portEXIT_CRITICAL(&q->lock);
+
+    if (err) {
+        NOTIFY_STAT_ADD(rejects, 1);
+    } else {
+        NOTIFY_STAT_ADD(queued, 1);
+    }
+    return ESP_OK;
+}
+
+esp_err_t order_notify_queue_push(order_notify_queue_t *q, const char *order_id)
+{
+    if (!order_id) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t len = strlen(order_id);
+    if (len == 0 || len > ORDER_NOTIFY_ID_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return notify_push(q, BLE_HS_CONN_HANDLE_NONE, order_id, len, NULL);
+}
+
+esp_err_t order_notify_queue_push_reject(order_notify_queue_t *q, uint16_t target, const char *order_id,
+                                         const char *err)
+{
+    if (!err || target == BLE_HS_CONN_HANDLE_NONE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // ID过长时无法原样带回，POS按原因处理
+    if (!order_id) {
+        order_id = "";
+    }
+    size_t len = strlen(order_id);
+    if (len > ORDER_NOTIFY_ID_MAX) {
+        order_id = "";
+        len = 0;
+    }
+    return notify_push(q, target, order_id, len, err);
+}
+
+size_t order_notify_queue_move(order_notify_queue_t *dst, order_notify_queue_t *src)
+{
+    size_t moved = 0;
+
+    portENTER_CRITICAL(&src->lock);
+    portENTER_CRITICAL(&dst->lock);
+    while (src->count > 0 && dst->count < CONFIG_ORDER_NOTIFY_QUEUE_LEN) {
+        *notify_slot(dst, dst->count) = *notify_slot(src, 0);
+        dst->count++;
+        src->head = (src->head + 1) % CONFIG_ORDER_NOTIFY_QUEUE_LEN;
+        src->count--;
+        moved++;
+    }
+    portEXIT_CRITICAL(&dst->lock);
+    portEXIT_CRITICAL(&src->lock);
+
+    return moved;
+}
+
+size_t order_notify_queue_copy(order_notify_queue_t *dst, order_notify_queue_t *src)
+{
+    size_t copied = 0;
+    size_t overflow = 0;
+
+    portENTER_CRITICAL(&src->lock);
+    portENTER_CRITICAL(&dst->lock);
+    for (uint16_t i = 0; i < src->count; i++) {
+        const order_notify_slot_t *slot = notify_slot(src, i);
+        if (slot->target != BLE_HS_CONN_HANDLE_NONE && slot->target != dst->conn_handle) {
+            continue;
+        }
+        if (dst->count == CONFIG_ORDER_NOTIFY_QUEUE_LEN) {
+            overflow++;
+            continue;
+        }
+        *notify_slot(dst, dst->count) = *slot;
+        dst->count++;
+        copied++;
+    }
+    portEXIT_CRITICAL(&dst->lock);
+    portEXIT_CRITICAL(&src->lock);
+
+    if (overflow) {
+        NOTIFY_STAT_ADD(dropped, overflow);
+        DLOGW(TAG, "通知队列已满，丢弃 %u 个订单: conn=%d", (unsigned)overflow, dst->conn_handle);
+    }
+    return copied;
+}
+
+void order_notify_queue_flush(order_notify_queue_t *q)
+{
+    if (q->conn_handle == BLE_HS_CONN_HANDLE_NONE || q->attr_handle == 0 ||
+        ble_npl_callout_is_active(&q->timer)) {
+        return;
+    }
+
+    size_t limit = ble_att_mtu(q->conn_handle);
+    limit = limit > 3 ? limit - 3 : 0;
+    if (limit > sizeof(s_payload)) {
+        limit = sizeof(s_payload);
+    }
+
+    size_t len = 0;
+    uint16_t n = notify_build(q, limit, &len);
+    if (n == 0) {
+        return;
+    }
+
+    int rc = BLE_HS_ENOMEM;
+    struct os_mbuf *om = ble_hs_mbuf_from_flat(s_payload, len);
+    if (om) {
+        // NOTIFY_TX事件可能在发送调用内同步产生，先置位
+        q->in_flight = n;
+        // 无论成功与否om都由协议栈释放
+        rc = ble_gattc_notify_custom(q->conn_handle, q->attr_handle, om);
+        if (rc != 0) {
+            q->in_flight = 0;
+        }
+    }
+
+    if (rc == BLE_HS_ENOMEM) {
+        NOTIFY_STAT_ADD(retries, 1);
+        ble_npl_callout_reset(&q->timer, ble_npl_time_ms_to_ticks32(CONFIG_ORDER_NOTIFY_RETRY_MS));
+        return;
+    }
+    if (rc != 0) {
+        // 断开时由连接管理转移或丢弃队列；连接仍在时有限次重试
+        NOTIFY_STAT_ADD(errors, 1);
+        DLOGE(TAG, "发送出餐通知失败: conn=%d rc=%d", q->conn_handle, rc);
+        notify_retry_after_error(q, n);
+        return;
+    }
+
+    notify_pop(q, n);
+    q->errors = 0;
+    portENTER_CRITICAL(&s_stats_lock);
+    s_stats.notifications++;
+    s_stats.ids_sent += n;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    DLOGI(TAG, "已发送出餐通知: conn=%d %.*s", q->conn_handle, (int)len, s_payload);
+}
+
+void order_notify_queue_on_tx(order_notify_queue_t *q, const struct ble_gap_event *event)
+{
+    // 同一特征值上还有链路层的确认通知，只有出餐通知的发送完成才开始合并窗口
+    if (event->notify_tx.indication || event->notify_tx.attr_handle != q->attr_handle || !q->in_flight) {
+        return;
+    }
+    uint16_t sent = q->in_flight;
+    q->in_flight = 0;
+    if (event->notify_tx.status != 0) {
+        // 这条通知已出队，其中的订单无法重发，计为丢弃；队列中其余的订单稍后继续发送
+        NOTIFY_STAT_ADD(errors, 1);
+        NOTIFY_STAT_ADD(dropped, sent);
+        DLOGE(TAG, "出餐通知发送失败，丢弃 %u 个订单: conn=%d status=%d",
+              sent, q->conn_handle, event->notify_tx.status);
+        notify_retry_after_error(q, 0);
+        return;
+    }
+
+    // 通知已交给控制器：等待一个连接间隔再发下一批，期间的点击合并发送
+    ble_npl_callout_reset(&q->timer, ble_npl_time_ms_to_ticks32(notify_window_ms(q->conn_handle)));
+}
+
+void order_notify_get_stats(order_notify_stats_t *out)
+{
+    if (!out) return;
+
+    portENTER_CRITICAL(&s_stats_lock);
+    *out = s_stats;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+void order_notify_log_stats(void)
+{
+    order_notify_stats_t stats;
+    order_notify_get_stats(&stats);
+
+    DLOGI(TAG, "入队 %lu, 拒绝 %lu, 丢弃 %lu, 通知 %lu 条/订单 %lu 个, 重试 %lu, 错误 %lu",
+             stats.queued, stats.rejects, stats.dropped, stats.notifications, stats.ids_sent,
+             stats.retries, stats.errors);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file order_notify.h
+ * @brief 出餐通知发送队列
+ *
+ * 每个连接一个发送队列。UI线程只把已出餐的订单ID放入环形队列，实际发送在NimBLE主机任务中进行：
+ *   - 队列空闲时立即发送；
+ *   - 一条通知发出后等待一个连接间隔，期间点击的订单合并为一条通知；
+ *   - 控制器mbuf不足（BLE_HS_ENOMEM）时保留在队列中稍后重试。
+ * 单个订单的通知格式不变：{"orderId":"...","status":true}
+ * 合并后的通知格式：{"orderIds":["...","..."],"status":true}
+ * 被拒绝的订单只发给发送该订单的连接，且单独发送：{"orderId":"...","status":false,"err":"..."}，
+ * 订单ID过长时不带orderId
+ */
+
+#ifndef ORDER_NOTIFY_H
+#define ORDER_NOTIFY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "host/ble_hs.h"
+
+// 订单ID最大长度（不含'\0'）
+#define ORDER_NOTIFY_ID_MAX  63
+
+typedef struct {
+    uint8_t len;
+    uint16_t target;                 // 只发给这个连接，BLE_HS_CONN_HANDLE_NONE表示所有订阅者
+    const char *err;                 // 非NULL表示订单被拒绝，为拒绝原因（静态字符串）
+    char id[ORDER_NOTIFY_ID_MAX];
+} order_notify_slot_t;
+
+/**
+ * @brief 单个连接的发送队列
+ *
+ * 环形队列可在任意任务中追加，其余字段只在主机任务中访问。
+ */
+typedef struct {
+    order_notify_slot_t ring[CONFIG_ORDER_NOTIFY_QUEUE_LEN];
+    uint16_t head;
+    uint16_t count;
+    portMUX_TYPE lock;
+    uint16_t conn_handle;            // 目标连接，BLE_HS_CONN_HANDLE_NONE表示暂不发送
+    uint16_t attr_handle;            // 通知特征值句柄
+    struct ble_npl_callout timer;    // 合并窗口/重试定时器，运行期间不发送
+    uint16_t in_flight;              // 已发出、等待NOTIFY_TX事件的通知中的订单数，0表示没有
+    uint8_t errors;                  // 队头通知连续发送失败的次数
+} order_notify_queue_t;
+
+/**
+ * @brief 通知队列统计信息（所有队列合计）
+ */
+typedef struct {
+    uint32_t queued;          // 入队的订单数
+    uint32_t dropped;         // 队列满或多次发送失败被丢弃的订单数
+    uint32_t rejects;         // 入队的拒绝通知数
+    uint32_t notifications;   // 发出的通知条数
+    uint32_t ids_sent;        // 已发送的订单数（大于通知条数说明发生了合并）
+    uint32_t retries;         // mbuf不足导致的重试次数
+    uint32_t errors;          // 其他发送错误次数（包括NOTIFY_TX报告的失败）
+} order_notify_stats_t;
+
+/**
+ * @brief 初始化发送队列（需在nimble_port_init之后调用）
+ *
+ * @param q 发送队列
+ */
+void order_notify_queue_init(order_notify_queue_t *q);
+
+/**
+ * @brief 设置发送目标（在主机任务中调用）
+ *
+ * 传入BLE_HS_CONN_HANDLE_NONE时暂停发送，未发送的订单保留在队列中。
+ *
+ * @param q 发送队列
+ * @param conn_handle 连接句柄
+ * @param attr_handle 通知特征值句柄
+ */
+void order_notify_queue_bind(order_notify_queue_t *q, uint16_t conn_handle, uint16_t attr_handle);
+
+/**
+ * @brief 丢弃队列中所有未发送的订单（在主机任务中调用）
+ *
+ * @param q 发送队列
+ */
+void order_notify_queue_clear(order_notify_queue_t *q);
+
+/**
+ * @brief 追加一个已出餐的订单ID（任意任务中调用，不阻塞）
+ *
+ * @param q 发送队列
+ * @param order_id 订单ID
+ * @return esp_err_t ESP_OK成功，ESP_ERR_NO_MEM表示队列已满，ESP_ERR_INVALID_ARG表示ID过长
+ */
+esp_err_t order_notify_queue_push(order_notify_queue_t *q, const char *order_id);
+
+/**
+ * @brief 追加一条订单被拒绝的通知（任意任务中调用，不阻塞）
+ *
+ * @param q 发送队列
+ * @param target 发送该订单的连接，通知只发给它
+ * @param order_id 订单ID，超过ORDER_NOTIFY_ID_MAX时通知中不带订单ID
+ * @param err 拒绝原因，必须是静态字符串
+ * @return esp_err_t ESP_OK成功，ESP_ERR_NO_MEM表示队列已满
+ */
+esp_err_t order_notify_queue_push_reject(order_notify_queue_t *q, uint16_t target, const char *order_id,
+                                         const char *err);
+
+/**
+ * @brief 把src中的订单全部移入dst（在主机任务中调用）
+ *
+ * @param dst 目标队列
+ * @param src 源队列
+ * @return size_t 移动的订单数（dst已满时剩余的留在src中）
+ */
+size_t order_notify_queue_move(order_notify_queue_t *dst, order_notify_queue_t *src);
+
+/**
+ * @brief 把src中发给dst所绑定连接的订单复制到dst，src不变（在主机任务中调用）
+ *
+ * 只指定了其他连接的订单不复制；dst未绑定连接时只复制发给所有订阅者的订单。
+ *
+ * @param dst 目标队列
+ * @param src 源队列
+ * @return size_t 复制的订单数（dst已满时其余的计入丢弃）
+ */
+size_t order_notify_queue_copy(order_notify_queue_t *dst, order_notify_queue_t *src);
+
+/**
+ * @brief 尝试发送一批（在主机任务中调用）
+ *
+ * @param q 发送队列
+ */
+void order_notify_queue_flush(order_notify_queue_t *q);
+
+/**
+ * @brief 处理BLE_GAP_EVENT_NOTIFY_TX事件（在GAP事件回调中调用）
+ *
+ * @param q 事件所属连接的发送队列
+ * @param event GAP事件
+ */
+void order_notify_queue_on_tx(order_notify_queue_t *q, const struct ble_gap_event *event);
+
+/**
+ * @brief 获取统计信息快照
+ *
+ * @param out 输出统计信息
+ */
+void order_notify_get_stats(order_notify_stats_t *out);
+
+/**
+ * @brief 打印统计信息
+ */
+void order_notify_log_stats(void);
+
+#endif // ORDER_NOTIFY_H
@@ -0,0 +1,272 @@
+/**
+ * @file order_session.c
+ * @brief POS连接会话管理实现
+ */
+
+#include "order_session.h"
+#include <string.h>
+#include "esp_log.h"
+#include "order_log.h"
+#include "nimble/nimble_port.h"
+
+static const char *TAG = "OrderSession";
+
+static order_session_t s_sessions[ORDER_SESSION_MAX];
+static order_notify_queue_t s_backlog;       // 没有订阅者时暂存的出餐通知
+static order_notify_queue_t s_pending;       // 其他任务提交、尚未由主机任务分发的通知
+static order_notify_queue_t s_dispatch;      // 主机任务分发时从s_pending取出的一批
+static order_frame_deliver_t s_deliver = NULL;
+static struct ble_npl_event s_flush_ev;      // 通知主机任务发送各会话队列
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;  // 保护active/subscribed
+static bool s_inited = false;
+
+static bool session_any_subscribed(void)
+{
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        if (s_sessions[i].active && s_sessions[i].subscribed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 主机任务中分发新提交的通知并发送所有会话的待发通知
+// 会话的建立、关闭和订阅变化都在主机任务中，这里看到的订阅者就是实际的发送目标
+static void session_flush_all(struct ble_npl_event *ev)
+{
+    // 先整批取出，分发期间其他任务提交的通知留给下一次事件
+    order_notify_queue_move(&s_dispatch, &s_pending);
+    if (!session_any_subscribed()) {
+        // 只暂存出餐通知，拒绝通知的目标连接没有订阅，直接丢弃
+        order_notify_queue_copy(&s_backlog, &s_dispatch);
+        order_notify_queue_clear(&s_dispatch);
+        return;
+    }
+
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        if (s_sessions[i].active && s_sessions[i].subscribed) {
+            order_notify_queue_copy(&s_sessions[i].notify, &s_dispatch);
+        }
+    }
+    order_notify_queue_clear(&s_dispatch);
+
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        if (s_sessions[i].active && s_sessions[i].subscribed) {
+            order_notify_queue_flush(&s_sessions[i].notify);
+        }
+    }
+}
+
+// 会话不再接收通知：没有其他订阅者时未发出的出餐通知暂存给下一个订阅者，其余丢弃
+// （其他订阅者已各有一份，拒绝通知只属于这个连接）
+static void session_release_queue(order_session_t *session)
+{
+    if (!session_any_subscribed()) {
+        order_notify_queue_copy(&s_backlog, &session->notify);
+    }
+    order_notify_queue_clear(&session->notify);
+}
+
+esp_err_t order_session_init(order_frame_deliver_t deliver)
+{
+    if (!deliver) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_inited) {
+        return ESP_OK;
+    }
+
+    s_deliver = deliver;
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        s_sessions[i].active = false;
+        s_sessions[i].conn_handle = BLE_HS_CONN_HANDLE_NONE;
+        order_notify_queue_init(&s_sessions[i].notify);
+        order_link_init(&s_sessions[i].link);
+    }
+    order_notify_queue_init(&s_backlog);
+    order_notify_queue_init(&s_pending);
+    order_notify_queue_init(&s_dispatch);
+    ble_npl_event_init(&s_flush_ev, session_flush_all, NULL);
+    s_inited = true;
+    return ESP_OK;
+}
+
+order_session_t *order_session_find(uint16_t conn_handle)
+{
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        if (s_sessions[i].active && s_sessions[i].conn_handle == conn_handle) {
+            return &s_sessions[i];
+        }
+    }
+    return NULL;
+}
+
+order_session_t *order_session_open(uint16_t conn_handle, uint16_t notify_attr_handle)
+{
+    order_session_t *session = order_session_find(conn_handle);
+    if (session) {
+        return session;
+    }
+
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        if (!s_sessions[i].active) {
+            session = &s_sessions[i];
+            break;
+        }
+    }
+    if (!session) {
+        DLOGE(TAG, "会话已满，无法接受连接 %d", conn_handle);
+        return NULL;
+    }
+
+    order_frame_ctx_init(&session->frame, s_deliver);
+    session->frame.conn_handle = conn_handle;
+    order_notify_queue_clear(&session->notify);
+    order_notify_queue_bind(&session->notify, conn_handle, notify_attr_handle);
+    order_link_on_connect(&session->link, conn_handle);
+
+    portENTER_CRITICAL(&s_lock);
+    session->conn_handle = conn_handle;
+    session->subscribed = false;
+    session->active = true;
+    portEXIT_CRITICAL(&s_lock);
+
+    DLOGI(TAG, "会话建立: conn=%d, 当前 %d 个连接", conn_handle, order_session_count());
+    return session;
+}
+
+void order_session_close(uint16_t conn_handle)
+{
+    order_session_t *session = order_session_find(conn_handle);
+    if (!session) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    session->active = false;
+    session->subscribed = false;
+    portEXIT_CRITICAL(&s_lock);
+
+    order_frame_ctx_reset(&session->frame);
+    order_link_on_disconnect(&session->link);
+    order_notify_queue_bind(&session->notify, BLE_HS_CONN_HANDLE_NONE, 0);
+    session_release_queue(session);
+    session->conn_handle = BLE_HS_CONN_HANDLE_NONE;
+
+    DLOGI(TAG, "会话结束: conn=%d, 剩余 %d 个连接", conn_handle, order_session_count());
+}
+
+int order_session_receive(order_session_t *session, const struct os_mbuf *om)
+{
+    uint16_t len = OS_MBUF_PKTLEN(om);
+    uint8_t hdr[2] = {0};
+    os_mbuf_copydata(om, 0, len < sizeof(hdr) ? len : sizeof(hdr), hdr);
+    bool framed = len >= ORDER_FRAME_HDR_LEN &&
+                  (hdr[0] & ORDER_FRAME_MARKER_MASK) == ORDER_FRAME_MARKER;
+
+    // 吞吐统计只算订单数据
+    order_link_on_write(&session->link, framed ? len - ORDER_FRAME_HDR_LEN : len);
+    if (framed && ORDER_FRAME_HDR_SEQ(hdr) == 0) {
+        // 新消息开始（包括POS重发被拒绝的消息）
+        session->link.nacked = 0;
+    }
+
+    int rc = order_frame_receive(&session->frame, om);
+
+#if CONFIG_ORDER_LINK_HIGH_THROUGHPUT
+    // 只有分片协议的POS才理解确认消息
+    if (framed && session->subscribed) {
+        order_link_ack(&session->link, session->notify.attr_handle, session->frame.delivered, rc);
+    }
+#endif
+    return rc;
+}
+
+void order_session_on_conn_update(uint16_t conn_handle)
+{
+    order_session_t *session = order_session_find(conn_handle);
+    if (session) {
+        order_link_on_conn_update(&session->link);
+    }
+}
+
+void order_session_set_subscribed(uint16_t conn_handle, bool subscribed)
+{
+    order_session_t *session = order_session_find(conn_handle);
+    if (!session || session->subscribed == subscribed) {
+        return;
+    }
+
+    portENTER_CRITICAL(&s_lock);
+    session->subscribed = subscribed;
+    portEXIT_CRITICAL(&s_lock);
+
+    if (subscribed) {
+        if (order_notify_queue_move(&session->notify, &s_backlog) > 0) {
+            DLOGI(TAG, "补发暂存的出餐通知给 conn=%d", conn_handle);
+        }
+        order_notify_queue_flush(&session->notify);
+    } else {
+        // 取消订阅但未断开：队列不再发送，交给其他订阅者或暂存
+        session_release_queue(session);
+    }
+}
+
+void order_session_on_notify_tx(const struct ble_gap_event *event)
+{
+    order_session_t *session = order_session_find(event->notify_tx.conn_handle);
+    if (session) {
+        order_notify_queue_on_tx(&session->notify, event);
+    }
+}
+
+// 已放入待分发队列后通知主机任务，由它按当时的订阅者分发，避免写入刚关闭或重新分配的会话
+static esp_err_t session_post(esp_err_t err)
+{
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    // 事件已在队列中时不会重复投递
+    if (s_inited) {
+        ble_npl_eventq_put(nimble_port_get_dflt_eventq(), &s_flush_ev);
+    }
+    return ESP_OK;
+}
+
+esp_err_t order_session_served(const char *order_id)
+{
+    return session_post(order_notify_queue_push(&s_pending, order_id));
+}
+
+esp_err_t order_session_rejected(uint16_t conn_handle, const char *order_id, const char *err)
+{
+    if (!err || conn_handle == BLE_HS_CONN_HANDLE_NONE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return session_post(order_notify_queue_push_reject(&s_pending, conn_handle, order_id, err));
+}
+
+int order_session_count(void)
+{
+    int count = 0;
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        count += s_sessions[i].active ? 1 : 0;
+    }
+    return count;
+}
+
+void order_session_log_stats(void)
+{
+    DLOGI(TAG, "连接 %d/%d, 待分发通知 %u, 暂存通知 %u",
+             order_session_count(), ORDER_SESSION_MAX, s_pending.count, s_backlog.count);
+    for (int i = 0; i < ORDER_SESSION_MAX; i++) {
+        const order_session_t *session = &s_sessions[i];
+        if (session->active) {
+            DLOGI(TAG, "  conn=%d 订阅=%d 待发送 %u 重组中 %u/%u",
+                     session->conn_handle, session->subscribed, session->notify.count,
+                     session->frame.received, session->frame.total);
+        }
+    }
+    order_notify_log_stats();
+}
@@ -0,0 +1,131 @@
+/**
+ * @file order_session.h
+ * @brief POS连接会话管理
+ *
+ * 每个已连接的POS（收银台、外卖平板等）对应一个会话，独立保存分片重组状态、
+ * 通知订阅状态和出餐通知发送队列。出餐通知先放入待分发队列，由主机任务分发给当时所有已订阅的会话；
+ * 没有任何会话订阅时暂存，交给下一个订阅的会话。
+ * 除order_session_served和order_session_rejected外，其余接口只在NimBLE主机任务中调用。
+ */
+
+#ifndef ORDER_SESSION_H
+#define ORDER_SESSION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "order_frame.h"
+#include "order_notify.h"
+#include "order_link.h"
+
+#define ORDER_SESSION_MAX CONFIG_BT_NIMBLE_MAX_CONNECTIONS
+
+/**
+ * @brief 单个连接的会话
+ */
+typedef struct {
+    bool active;                   // 会话是否在使用
+    bool subscribed;               // 是否已订阅出餐通知
+    uint16_t conn_handle;          // 连接句柄
+    order_frame_ctx_t frame;       // 分片重组状态
+    order_notify_queue_t notify;   // 出餐通知发送队列
+    order_link_t link;             // 链路调优和吞吐统计
+} order_session_t;
+
+/**
+ * @brief 初始化会话表（需在nimble_port_init之后调用）
+ *
+ * @param deliver 重组完成的消息交付回调
+ * @return esp_err_t ESP_OK成功
+ */
+esp_err_t order_session_init(order_frame_deliver_t deliver);
+
+/**
+ * @brief 为新连接创建会话
+ *
+ * @param conn_handle 连接句柄
+ * @param notify_attr_handle 出餐通知特征值句柄
+ * @return order_session_t* 会话，会话已满时返回NULL
+ */
+order_session_t *order_session_open(uint16_t conn_handle, uint16_t notify_attr_handle);
+
+/**
+ * @brief 连接断开，释放会话
+ *
+ * @param conn_handle 连接句柄
+ */
+void order_session_close(uint16_t conn_handle);
+
+/**
+ * @brief 查找连接的会话
+ *
+ * @param conn_handle 连接句柄
+ * @return order_session_t* 会话，不存在时返回NULL
+ */
+order_session_t *order_session_find(uint16_t conn_handle);
+
+/**
+ * @brief 处理订单特征值写入：分片重组、链路统计和应用层确认
+ *
+ * @param session 会话
+ * @param om 写入数据
+ * @return int 0成功，否则为BLE_ATT_ERR_*错误码
+ */
+int order_session_receive(order_session_t *session, const struct os_mbuf *om);
+
+/**
+ * @brief 连接参数已更新（BLE_GAP_EVENT_CONN_UPDATE）
+ *
+ * @param conn_handle 连接句柄
+ */
+void order_session_on_conn_update(uint16_t conn_handle);
+
+/**
+ * @brief 更新通知订阅状态（BLE_GAP_EVENT_SUBSCRIBE）
+ *
+ * @param conn_handle 连接句柄
+ * @param subscribed 是否订阅
+ */
+void order_session_set_subscribed(uint16_t conn_handle, bool subscribed);
+
+/**
+ * @brief 处理BLE_GAP_EVENT_NOTIFY_TX事件
+ *
+ * @param event GAP事件
+ */
+void order_session_on_notify_tx(const struct ble_gap_event *event);
+
+/**
+ * @brief 订单已出餐，分发给所有已订阅的会话（任意任务中调用，不阻塞）
+ *
+ * @param order_id 订单ID
+ * @return esp_err_t ESP_OK已入队，ESP_ERR_NO_MEM表示待分发队列已满
+ */
+esp_err_t order_session_served(const char *order_id);
+
+/**
+ * @brief 订单消息被拒绝，通知发送该消息的POS（任意任务中调用，不阻塞）
+ *
+ * 消息在接入工作任务中异步处理，无法再通过写入响应返回错误，因此改用通知，
+ * 且只发给发送该消息的连接；该连接已断开或未订阅时丢弃。
+ *
+ * @param conn_handle 发送该消息的连接
+ * @param order_id 订单ID
+ * @param err 拒绝原因，必须是静态字符串
+ * @return esp_err_t ESP_OK已入队，ESP_ERR_INVALID_ARG参数无效，ESP_ERR_NO_MEM表示待分发队列已满
+ */
+esp_err_t order_session_rejected(uint16_t conn_handle, const char *order_id, const char *err);
+
+/**
+ * @brief 当前活动会话数
+ *
+ * @return int 会话数
+ */
+int order_session_count(void);
+
+/**
+ * @brief 打印会话状态
+ */
+void order_session_log_stats(void);
+
+#endif // ORDER_SESSION_H
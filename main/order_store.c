@@ -0,0 +1,327 @@
+#include "order_store.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_heap_caps.h"
+#include "order_log.h"
+
+static const char *TAG = "OrderStore";
+#else
+// 主机构建：不依赖ESP-IDF堆和日志
+#define heap_caps_calloc(n, size, caps)  calloc(n, size)
+#define heap_caps_free(p)                free(p)
+#define DLOGE(tag, fmt, ...)             ((void)0)
+#endif
+
+// 哈希槽：高16位为哈希标签，低16位为记录序号+1，0表示空槽
+#define SLOT_EMPTY          0
+#define SLOT_MAKE(hash, i)  (((hash) & 0xFFFF0000u) | ((uint32_t)(i) + 1))
+#define SLOT_INDEX(slot)    (((slot) & 0xFFFFu) - 1)
+#define SLOT_TAG(slot)      ((slot) & 0xFFFF0000u)
+#define FREE_END            0xFFFF
+#define LIST_END            0xFFFF
+
+struct order_store {
+    order_rec_t *recs;       // 记录池
+    uint32_t *table;         // 开放寻址哈希表，大小为2的幂
+    uint32_t mask;
+    uint16_t capacity;
+    uint16_t free_head;      // 空闲记录链表
+    uint16_t oldest;         // 到达顺序链表的两端
+    uint16_t newest;
+    order_store_stats_t stats;
+};
+
+// FNV-1a
+static uint32_t id_hash(const char *id, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)id[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static void *store_alloc(size_t size)
+{
+    void *p = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : calloc(1, size);
+}
+
+order_store_t *order_store_create(uint16_t capacity)
+{
+    if (capacity == 0 || capacity == FREE_END) {
+        return NULL;
+    }
+
+    // 负载因子不超过0.5，保证线性探测的平均探测长度接近1
+    uint32_t slots = 16;
+    while (slots < (uint32_t)capacity * 2) {
+        slots <<= 1;
+    }
+
+    order_store_t *store = calloc(1, sizeof(*store));
+    if (!store) {
+        return NULL;
+    }
+    store->recs = store_alloc((size_t)capacity * sizeof(order_rec_t));
+    store->table = store_alloc(slots * sizeof(uint32_t));
+    if (!store->recs || !store->table) {
+        DLOGE(TAG, "分配订单存储失败 (容量 %u)", capacity);
+        order_store_destroy(store);
+        return NULL;
+    }
+
+    store->mask = slots - 1;
+    store->capacity = capacity;
+    for (uint16_t i = 0; i < capacity; i++) {
+        store->recs[i].next_free = (i + 1 < capacity) ? i + 1 : FREE_END;
+    }
+    store->free_head = 0;
+    store->oldest = LIST_END;
+    store->newest = LIST_END;
+
+    store->stats.capacity = capacity;
+    store->stats.table_slots = slots;
+    store->stats.slab_bytes = (size_t)capacity * sizeof(order_rec_t) + slots * sizeof(uint32_t);
+    return store;
+}
+
+static void rec_release_dishes(order_rec_t *rec)
+{
+    for (uint16_t i = 0; i < rec->dish_count; i++) {
+        dish_intern_release(rec->dishes[i]);
+    }
+    rec->dish_count = 0;
+    rec->dish_bytes = 0;
+}
+
+void order_store_destroy(order_store_t *store)
+{
+    if (!store) return;
+
+    if (store->recs) {
+        for (uint16_t i = 0; i < store->capacity; i++) {
+            if (store->recs[i].in_use) {
+                rec_release_dishes(&store->recs[i]);
+            }
+        }
+    }
+    heap_caps_free(store->recs);
+    heap_caps_free(store->table);
+    free(store);
+}
+
+// 查找订单ID所在槽位，不存在时返回应插入的空槽
+static uint32_t table_probe(const order_store_t *store, const char *id, size_t len, uint32_t hash, bool *found)
+{
+    uint32_t pos = hash & store->mask;
+    for (;;) {
+        uint32_t slot = store->table[pos];
+        if (slot == SLOT_EMPTY) {
+            *found = false;
+            return pos;
+        }
+        if (SLOT_TAG(slot) == (hash & 0xFFFF0000u)) {
+            const order_rec_t *rec = &store->recs[SLOT_INDEX(slot)];
+            if (rec->id_len == len && memcmp(rec->order_id, id, len) == 0) {
+                *found = true;
+                return pos;
+            }
+        }
+        pos = (pos + 1) & store->mask;
+    }
+}
+
+order_rec_t *order_store_find(order_store_t *store, const char *order_id)
+{
+    if (!store || !order_id) return NULL;
+
+    size_t len = strlen(order_id);
+    if (len == 0 || len > ORDER_STORE_ID_MAX) return NULL;
+
+    bool found;
+    uint32_t pos = table_probe(store, order_id, len, id_hash(order_id, len), &found);
+    return found ? &store->recs[SLOT_INDEX(store->table[pos])] : NULL;
+}
+
+// 驻留新的菜品名并替换记录中的句柄，失败时不修改记录
+static esp_err_t rec_set_dishes(order_store_t *store, order_rec_t *rec, const order_t *order)
+{
+    uint16_t count = order->dish_count;
+    if (count > ORDER_STORE_MAX_DISHES) {
+        count = ORDER_STORE_MAX_DISHES;
+        store->stats.dish_truncated++;
+    }
+
+    // 先驻留新菜品再释放旧菜品，更新时不变的菜品名直接命中
+    dish_id_t ids[ORDER_STORE_MAX_DISHES];
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < count; i++) {
+        ids[i] = dish_intern_acquire(order->dishes[i].name, order->dishes[i].name_len);
+        if (ids[i] == DISH_ID_NONE) {
+            while (i > 0) {
+                dish_intern_release(ids[--i]);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        total += dish_intern_len(ids[i]) + 1;
+    }
+
+    rec_release_dishes(rec);
+    memcpy(rec->dishes, ids, count * sizeof(dish_id_t));
+    rec->dish_count = count;
+    rec->dish_bytes = (uint16_t)total;
+    return ESP_OK;
+}
+
+esp_err_t order_store_add(order_store_t *store, const order_t *order, order_rec_t **out)
+{
+    if (out) *out = NULL;
+    if (!store || !order || !order->order_id || (order->dish_count && !order->dishes)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t len = strlen(order->order_id);
+    if (len == 0 || len > ORDER_STORE_ID_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint32_t hash = id_hash(order->order_id, len);
+    bool found;
+    uint32_t pos = table_probe(store, order->order_id, len, hash, &found);
+    if (found) {
+        if (out) *out = &store->recs[SLOT_INDEX(store->table[pos])];
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (store->free_head == FREE_END) {
+        store->stats.rejected++;
+        return ESP_ERR_NO_MEM;
+    }
+
+    uint16_t index = store->free_head;
+    order_rec_t *rec = &store->recs[index];
+    uint16_t next_free = rec->next_free;
+
+    memset(rec, 0, offsetof(order_rec_t, dishes));
+    if (rec_set_dishes(store, rec, order) != ESP_OK) {
+        rec->next_free = next_free;
+        return ESP_ERR_NO_MEM;
+    }
+
+    memcpy(rec->order_id, order->order_id, len);
+    rec->order_id[len] = '\0';
+    rec->id_len = (uint8_t)len;
+    rec->hash = hash;
+    rec->order_num = order->order_num;
+    rec->status = ORDER_STATUS_PENDING;
+    rec->in_use = true;
+    rec->next_free = FREE_END;
+    store->free_head = next_free;
+
+    // 挂到到达顺序链表末尾
+    rec->older = store->newest;
+    rec->newer = LIST_END;
+    if (store->newest != LIST_END) {
+        store->recs[store->newest].newer = index;
+    } else {
+        store->oldest = index;
+    }
+    store->newest = index;
+    store->table[pos] = SLOT_MAKE(hash, index);
+
+    uint32_t distance = (pos - (hash & store->mask)) & store->mask;
+    if (distance > store->stats.probe_max) {
+        store->stats.probe_max = distance;
+    }
+    if (++store->stats.count > store->stats.peak) {
+        store->stats.peak = store->stats.count;
+    }
+
+    if (out) *out = rec;
+    return ESP_OK;
+}
+
+esp_err_t order_store_update(order_store_t *store, order_rec_t *rec, const order_t *order)
+{
+    if (!store || !rec || !rec->in_use || !order || (order->dish_count && !order->dishes)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    esp_err_t err = rec_set_dishes(store, rec, order);
+    if (err != ESP_OK) {
+        return err;
+    }
+    rec->order_num = order->order_num;
+    return ESP_OK;
+}
+
+void order_store_remove(order_store_t *store, order_rec_t *rec)
+{
+    if (!store || !rec || !rec->in_use) return;
+
+    uint16_t index = (uint16_t)(rec - store->recs);
+    bool found;
+    uint32_t pos = table_probe(store, rec->order_id, rec->id_len, rec->hash, &found);
+    if (!found) {
+        DLOGE(TAG, "哈希表中找不到订单 %s", rec->order_id);
+        return;
+    }
+
+    // 回移删除：把后续同一探测链上的槽位前移，不留墓碑
+    uint32_t hole = pos;
+    uint32_t next = pos;
+    for (;;) {
+        next = (next + 1) & store->mask;
+        uint32_t slot = store->table[next];
+        if (slot == SLOT_EMPTY) {
+            break;
+        }
+        uint32_t home = store->recs[SLOT_INDEX(slot)].hash & store->mask;
+        if (((next - home) & store->mask) >= ((next - hole) & store->mask)) {
+            store->table[hole] = slot;
+            hole = next;
+        }
+    }
+    store->table[hole] = SLOT_EMPTY;
+
+    // 从到达顺序链表摘除；保留本记录的newer，遍历中删除当前记录后仍能继续
+    if (rec->older != LIST_END) {
+        store->recs[rec->older].newer = rec->newer;
+    } else {
+        store->oldest = rec->newer;
+    }
+    if (rec->newer != LIST_END) {
+        store->recs[rec->newer].older = rec->older;
+    } else {
+        store->newest = rec->older;
+    }
+
+    rec_release_dishes(rec);
+    rec->in_use = false;
+    rec->view = NULL;
+    rec->next_free = store->free_head;
+    store->free_head = index;
+    store->stats.count--;
+}
+
+order_rec_t *order_store_next(order_store_t *store, order_rec_t *prev)
+{
+    if (!store) return NULL;
+
+    uint16_t i = prev ? prev->newer : store->oldest;
+    return i != LIST_END ? &store->recs[i] : NULL;
+}
+
+uint16_t order_store_count(const order_store_t *store)
+{
+    return store ? store->stats.count : 0;
+}
+
+void order_store_get_stats(const order_store_t *store, order_store_stats_t *stats)
+{
+    if (!store || !stats) return;
+    *stats = store->stats;
+}
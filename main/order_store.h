@@ -0,0 +1,168 @@
+/**
+ * @file order_store.h
+ * @brief 订单存储：定长记录池 + 订单ID开放寻址哈希
+ *
+ * 所有订单记录在创建时一次性从PSRAM分配，增删不再调用malloc：
+ *   - 订单ID直接存放在记录内，菜品名存为驻留表句柄（见dish_intern.h），同名菜品只存一份；
+ *   - 按订单ID的查找/插入/删除为O(1)（线性探测，负载因子不超过0.5，删除时回移，无墓碑）；
+ *   - 记录中保留一个视图指针，视图对象可直接指回记录，双向都不需要遍历。
+ * 存储本身不加锁，由调用方保证串行访问（UI层在显示锁内访问）。
+ */
+
+#ifndef ORDER_STORE_H
+#define ORDER_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "dish_intern.h"
+
+// 订单ID最大长度（不含'\0'）
+#define ORDER_STORE_ID_MAX        63
+// 每个订单最多保存的菜品数，超出部分丢弃（与协议层ORDER_MSG_MAX_ITEMS一致）
+#define ORDER_STORE_MAX_DISHES    32
+
+// 菜品
+typedef struct {
+    const char *name;        // UTF-8菜品名（不要求以'\0'结尾）
+    uint16_t name_len;       // 菜品名长度
+} dish_t;
+
+// 订单（由协议层填充，调用返回后即可释放）
+typedef struct {
+    const char *order_id;    // 订单ID
+    int order_num;           // 订单号
+    uint16_t dish_count;     // 菜品数量
+    const dish_t *dishes;    // 菜品列表
+} order_t;
+
+// 订单状态
+typedef enum {
+    ORDER_STATUS_PENDING,    // 等待中
+    ORDER_STATUS_COMPLETED,  // 已完成
+    ORDER_STATUS_REMOVED     // 已移除
+} order_status_t;
+
+/**
+ * @brief 订单记录
+ *
+ * 菜品名为驻留表句柄，用order_rec_dish取第i个菜品名；记录存在期间菜品名地址不变。
+ */
+typedef struct {
+    uint32_t hash;           // 订单ID哈希
+    uint16_t next_free;      // 空闲链表（仅空闲记录使用）
+    uint16_t older;          // 按到达顺序的双向链表
+    uint16_t newer;
+    bool in_use;
+    uint8_t status;          // order_status_t
+    uint8_t id_len;
+    uint16_t dish_count;
+    uint16_t dish_bytes;     // 菜品名合计字节数（含各'\0'）
+    int order_num;           // 订单号
+    void *view;              // 视图私有数据（设备上为订单行对象）
+    dish_id_t dishes[ORDER_STORE_MAX_DISHES];
+    char order_id[ORDER_STORE_ID_MAX + 1];
+} order_rec_t;
+
+/**
+ * @brief 存储统计信息
+ */
+typedef struct {
+    uint16_t count;          // 当前订单数
+    uint16_t capacity;       // 记录池容量
+    uint16_t peak;           // 订单数峰值
+    uint16_t dish_truncated; // 菜品数超出上限被截断的订单数
+    uint32_t table_slots;    // 哈希表槽位数
+    uint32_t probe_max;      // 查找时最长探测距离
+    uint32_t rejected;       // 记录池已满被拒绝的订单数
+    size_t slab_bytes;       // 记录池和哈希表占用的内存
+} order_store_stats_t;
+
+typedef struct order_store order_store_t;
+
+/**
+ * @brief 创建订单存储（记录池和哈希表优先分配在PSRAM）
+ *
+ * @param capacity 最多同时保存的订单数（1~65534）
+ * @return order_store_t* 失败返回NULL
+ */
+order_store_t *order_store_create(uint16_t capacity);
+
+/**
+ * @brief 释放订单存储及所有记录
+ *
+ * @param store 订单存储
+ */
+void order_store_destroy(order_store_t *store);
+
+/**
+ * @brief 按订单ID查找
+ *
+ * @param store 订单存储
+ * @param order_id 以'\0'结尾的订单ID
+ * @return order_rec_t* 不存在时返回NULL
+ */
+order_rec_t *order_store_find(order_store_t *store, const char *order_id);
+
+/**
+ * @brief 添加订单（复制订单ID和菜品名）
+ *
+ * @param store 订单存储
+ * @param order 订单内容
+ * @param out 返回新记录；订单ID已存在时返回已有记录
+ * @return esp_err_t
+ *         - ESP_OK 成功
+ *         - ESP_ERR_INVALID_ARG 订单ID为空或过长
+ *         - ESP_ERR_INVALID_STATE 订单ID已存在
+ *         - ESP_ERR_NO_MEM 记录池已满或菜品名驻留表已满
+ */
+esp_err_t order_store_add(order_store_t *store, const order_t *order, order_rec_t **out);
+
+/**
+ * @brief 替换订单的订单号和菜品（失败时记录保持不变）
+ *
+ * @param store 订单存储
+ * @param rec 订单记录
+ * @param order 新的订单内容（订单ID不使用）
+ * @return esp_err_t ESP_OK 成功，ESP_ERR_NO_MEM 菜品名驻留表已满
+ */
+esp_err_t order_store_update(order_store_t *store, order_rec_t *rec, const order_t *order);
+
+/**
+ * @brief 删除订单并回收记录
+ *
+ * @param store 订单存储
+ * @param rec 订单记录
+ */
+void order_store_remove(order_store_t *store, order_rec_t *rec);
+
+/**
+ * @brief 按到达顺序遍历所有订单（从最早的开始，遍历期间可删除当前记录）
+ *
+ * 记录池会复用删除后空出的位置，遍历顺序与记录在池中的位置无关；
+ * 更新不改变顺序。
+ *
+ * @param store 订单存储
+ * @param prev 上一条记录，传NULL从头开始
+ * @return order_rec_t* 没有更多记录时返回NULL
+ */
+order_rec_t *order_store_next(order_store_t *store, order_rec_t *prev);
+
+/**
+ * @brief 当前订单数
+ */
+uint16_t order_store_count(const order_store_t *store);
+
+/**
+ * @brief 获取统计信息
+ */
+void order_store_get_stats(const order_store_t *store, order_store_stats_t *stats);
+
+// 第i个菜品名（以'\0'结尾）
+static inline const char *order_rec_dish(const order_rec_t *rec, uint16_t i)
+{
+    return dish_intern_str(rec->dishes[i]);
+}
+
+#endif // ORDER_STORE_H
@@ -1,16 +1,15 @@
 #include "lvgl.h"
 #include "order_ui.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "order_log.h"
+#include "glyph_cache.h"
+#include "text_measure.h"
 #include "bsp/display.h"
 #include "bsp/esp-bsp.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include "sys/queue.h"
-#include "cJSON.h"
-
-// 外部声明send_notification函数
-extern int send_notification(const char *json_str);
 
 // 外部声明字体
 /* extern lv_font_t lv_font_mulan_14; */
@@ -20,203 +19,239 @@ LV_FONT_DECLARE(lv_font_montserrat_14)
 
 static const char *TAG = "OrderUI";
 
-// 预渲染缓存结构（性能优化版）- 使用哈希表快速查找
-#define PRERENDER_CACHE_SIZE 64
-typedef struct prerender_cache_s {
-    char text[48];
-    uint32_t hash;
-    struct prerender_cache_s *next;
-} prerender_cache_t;
-
-static prerender_cache_t *prerender_cache_table[PRERENDER_CACHE_SIZE] = {0};
-
-// 简单哈希函数
-static uint32_t simple_hash(const char *str) {
-    uint32_t hash = 5381;
-    while (*str) {
-        hash = ((hash << 5) + hash) + *str++;
-    }
-    return hash;
-}
-
-// 预渲染文字到纹理缓存（性能优化版）- 使用哈希表快速查找
-static void prerender_text(const char *text, lv_font_t *font) {
-    if (!text || !font || !*text || strlen(text) >= 48) return;
-    
-    uint32_t hash = simple_hash(text);
-    int index = hash % PRERENDER_CACHE_SIZE;
-    
-    // 检查缓存中是否已存在（哈希表快速查找）
-    prerender_cache_t *cache = prerender_cache_table[index];
-    while (cache) {
-        if (cache->hash == hash && strcmp(cache->text, text) == 0) {
-            return; // 已存在缓存，无需重复渲染
-        }
-        cache = cache->next;
-    }
-    
-    // 创建新的缓存项
-    prerender_cache_t *new_cache = malloc(sizeof(prerender_cache_t));
-    if (!new_cache) return;
-    
-    strncpy(new_cache->text, text, sizeof(new_cache->text) - 1);
-    new_cache->text[sizeof(new_cache->text) - 1] = '\0';
-    new_cache->hash = hash;
-    new_cache->next = prerender_cache_table[index];
-    prerender_cache_table[index] = new_cache;
-    
-    // 预渲染中文字符（异步处理）
-    if (dish_font && dish_font == font) {
-        lv_obj_t *temp_label = lv_label_create(lv_layer_top());
-        if (temp_label) {
-            lv_obj_set_style_text_font(temp_label, font, 0);
-            lv_label_set_text_static(temp_label, text);
-            lv_obj_set_pos(temp_label, -100, -100);
-            lv_obj_update_layout(temp_label);
-            lv_obj_del_async(temp_label);
+// 菜品名常用字，菜品字体就绪后先放入字形缓存预热
+static const char s_common_dish_chars[] =
+    "陈醋米饭面条汤菜肉鱼鸡鸭牛羊猪炒煮蒸炸烤炖凉热酸甜苦辣"
+    "咸香鲜嫩脆软硬大小中特加份碗盘杯瓶个只条块斤两克";
+
+// 预热订单中菜品名的字形，字形在订单行绘制前由后台任务解压
+static void warm_order_dishes(const order_rec_t *order) {
+    for (uint16_t i = 0; i < order->dish_count; i++) {
+        const char *dish_name = order_rec_dish(order, i);
+        if (dish_name && *dish_name &&
+            glyph_cache_warm(dish_name, strlen(dish_name)) == ESP_ERR_NO_MEM) {
+            break;
         }
     }
 }
 
-// 清理预渲染缓存（性能优化版）- 哈希表清理
-static void cleanup_prerender_cache(void) {
-    for (int i = 0; i < PRERENDER_CACHE_SIZE; i++) {
-        prerender_cache_t *cache = prerender_cache_table[i];
-        while (cache) {
-            prerender_cache_t *next = cache->next;
-            free(cache);
-            cache = next;
-        }
-        prerender_cache_table[i] = NULL;
-    }
+static lv_obj_t *orders_container = NULL;
+static lv_obj_t *waiting_label = NULL; // 保存等待标签指针
+
+// 虚拟列表：只为可见区域（上下各多留ROW_OVERSCAN行）的订单创建订单行，
+// 订单行从固定大小的行池中复用，滚动时重新绑定到对应订单
+#define ROW_HEIGHT      96
+#define ROW_GAP         10
+#define ROW_PITCH       (ROW_HEIGHT + ROW_GAP)
+#define ROW_OVERSCAN    1
+#define ROW_POOL_MAX    12
+
+// 菜品卡片按菜品名宽度取宽，最窄为原来的固定宽度；超过最宽时换行，行数受订单行高度限制
+#define CARD_W_MIN      120
+#define CARD_W_MAX      240
+#define CARD_H          39
+#define CARD_PAD        8           // 与菜品卡片样式的内边距一致
+#define CARD_MARGIN     5           // 与菜品卡片样式的外边距一致
+#define CARD_H_MAX      (ROW_HEIGHT - 2 * 10 - 2 * CARD_MARGIN)
+#define CARD_TEXT_MAX_W (CARD_W_MAX - 2 * CARD_PAD)
+
+// 行池中的订单行（记录的view指向绑定的订单行，订单行的rec指回记录）
+typedef struct {
+    lv_obj_t *row;
+    lv_obj_t *dish_box;      // 左侧菜品容器
+    lv_obj_t *btn;           // 右侧出餐按钮
+    order_rec_t *rec;        // 当前绑定的订单，NULL表示空闲
+} order_row_t;
+
+static order_model_t *s_model = NULL;
+static order_row_t s_rows[ROW_POOL_MAX];
+static uint16_t s_pool_size = 0;
+static lv_obj_t *s_spacer = NULL;      // 撑开滚动区域的占位对象
+static order_rec_t **s_items = NULL;   // 按到达先后排列的订单，最新的显示在最上面
+static uint16_t s_item_count = 0;
+static uint16_t s_item_cap = 0;
+static order_ui_stats_t s_stats;
+
+// 显示位置index（0为最上面）对应的订单
+static inline order_rec_t *item_at(uint16_t index)
+{
+    return s_items[s_item_count - 1 - index];
 }
 
-// 批量预渲染常用中文字符（优化启动性能）
-static void prerender_common_chinese_chars(lv_font_t *font) {
-    if (!font) return;
-    
-    // 预渲染常用中文字符（菜品名称常用字）
-    const char *common_chars[] = {
-        "陈醋", "米饭", "面条", "汤", "菜", "肉", "鱼", "鸡", "鸭", "牛", "羊", "猪",
-        "炒", "煮", "蒸", "炸", "烤", "炖", "凉", "热", "酸", "甜", "苦", "辣",
-        "咸", "香", "鲜", "嫩", "脆", "软", "硬", "大", "小", "中", "特", "加",
-        "份", "碗", "盘", "杯", "瓶", "个", "只", "条", "块", "斤", "两", "克"
-    };
-    
-    size_t count = sizeof(common_chars) / sizeof(common_chars[0]);
-    for (size_t i = 0; i < count; i++) {
-        prerender_text(common_chars[i], font);
-    }
-    
-    ESP_LOGI(TAG, "已预渲染 %zu 个常用中文字符", count);
+// 共享样式：启动时初始化一次，各对象用lv_obj_add_style引用，不再逐个设置本地样式属性
+static lv_style_t s_style_list;        // 订单列表容器
+static lv_style_t s_style_hint;        // 等待提示
+static lv_style_t s_style_status_bar;  // 底部状态栏
+static lv_style_t s_style_bt_label;    // 蓝牙状态
+static lv_style_t s_style_popup;       // 弹窗（文字属性由标签继承）
+static lv_style_t s_style_row;         // 订单行
+static lv_style_t s_style_dish_box;    // 菜品容器
+static lv_style_t s_style_dish_card;   // 菜品卡片（文字属性由标签继承）
+static lv_style_t s_style_btn;         // 出餐按钮（文字属性由标签继承）
+static lv_style_t s_style_btn_served;  // 已出餐按钮（LV_STATE_DISABLED）
+static bool s_styles_ready = false;
+static const lv_font_t *s_dish_style_font = NULL;
+
+static void ui_styles_init(void)
+{
+    if (s_styles_ready) return;
+
+    lv_style_init(&s_style_list);
+    lv_style_set_pad_all(&s_style_list, 10);
+
+    lv_style_init(&s_style_hint);
+    lv_style_set_text_font(&s_style_hint, &lv_font_device);
+
+    lv_style_init(&s_style_status_bar);
+    lv_style_set_bg_color(&s_style_status_bar, lv_color_hex(0xF1F1F1));
+    lv_style_set_border_width(&s_style_status_bar, 0);
+    lv_style_set_pad_all(&s_style_status_bar, 0);
+
+    lv_style_init(&s_style_bt_label);
+    lv_style_set_text_color(&s_style_bt_label, lv_color_hex(0x0CC160));
+
+    lv_style_init(&s_style_popup);
+    lv_style_set_bg_color(&s_style_popup, lv_color_black());
+    lv_style_set_bg_opa(&s_style_popup, LV_OPA_COVER);
+    lv_style_set_border_width(&s_style_popup, 0);
+    lv_style_set_pad_all(&s_style_popup, 5);
+    lv_style_set_text_font(&s_style_popup, &lv_font_montserrat_14);
+    lv_style_set_text_color(&s_style_popup, lv_color_white());
+
+    lv_style_init(&s_style_row);
+    lv_style_set_pad_all(&s_style_row, 10);
+    lv_style_set_radius(&s_style_row, 5);
+    lv_style_set_bg_color(&s_style_row, lv_color_white());
+
+    lv_style_init(&s_style_dish_box);
+    lv_style_set_border_width(&s_style_dish_box, 0);
+    lv_style_set_pad_all(&s_style_dish_box, 0);
+
+    lv_style_init(&s_style_dish_card);
+    lv_style_set_bg_color(&s_style_dish_card, lv_color_hex(0xF1F1F1));
+    lv_style_set_radius(&s_style_dish_card, 5);
+    lv_style_set_pad_all(&s_style_dish_card, CARD_PAD);
+    lv_style_set_border_width(&s_style_dish_card, 0);
+    lv_style_set_margin_all(&s_style_dish_card, CARD_MARGIN);
+    lv_style_set_text_color(&s_style_dish_card, lv_color_black());
+    lv_style_set_text_align(&s_style_dish_card, LV_TEXT_ALIGN_CENTER);
+    s_dish_style_font = dish_font ? dish_font : &lv_font_device;
+    lv_style_set_text_font(&s_style_dish_card, s_dish_style_font);
+
+    lv_style_init(&s_style_btn);
+    lv_style_set_bg_color(&s_style_btn, lv_color_hex(0x52E011));
+    lv_style_set_radius(&s_style_btn, 5);
+    lv_style_set_border_width(&s_style_btn, 0);
+    lv_style_set_text_color(&s_style_btn, lv_color_white());
+    lv_style_set_text_font(&s_style_btn, &lv_font_device);
+
+    lv_style_init(&s_style_btn_served);
+    lv_style_set_bg_color(&s_style_btn_served, lv_color_hex(0xCCCCCC));
+
+    s_styles_ready = true;
 }
 
-// 按钮点击事件回调函数声明
-static void btn_ready_cb(lv_event_t *e);
-static lv_obj_t *orders_container = NULL;
-static lv_obj_t *waiting_label = NULL; // 保存等待标签指针
+static void dish_card_fit(lv_obj_t *dish_card);
 
-// 订单状态枚举
-typedef enum {
-    ORDER_STATUS_PENDING,    // 等待中
-    ORDER_STATUS_COMPLETED,  // 已完成
-    ORDER_STATUS_REMOVED     // 已移除
-} order_status_t;
-
-// 订单数据结构
-typedef struct order_info {
-    char *order_id;          // 订单ID
-    int order_num;           // 订单号
-    char *dishes;            // 菜品信息
-    lv_obj_t *row_widget;    // 订单行UI对象
-    lv_obj_t *dish_label;   // 菜品标签指针
-    order_status_t status;   // 订单状态
-    STAILQ_ENTRY(order_info) entries;
-} order_info_t;
-
-// 订单队列
-STAILQ_HEAD(order_list_head, order_info);
-static struct order_list_head order_list = STAILQ_HEAD_INITIALIZER(order_list);
-
-// 按钮点击事件：已出餐 → 修改按钮状态、文字、颜色
-// 通知特性UUID
-#define NOTIFY_CHAR_UUID "6E400003-B5A3-F393-E0A9-E50E24DCCA9E"
+// 菜品字体在后台任务中加载，替换后由order_ui_sync_dish_font更新共享样式，已有卡片随之刷新并按新字体重新取宽
+static void ui_styles_sync_dish_font(void)
+{
+    const lv_font_t *font = dish_font ? dish_font : &lv_font_device;
+    if (font != s_dish_style_font) {
+        s_dish_style_font = font;
+        lv_style_set_text_font(&s_style_dish_card, font);
+        lv_obj_report_style_change(&s_style_dish_card);
+
+        for (uint16_t i = 0; i < s_pool_size; i++) {
+            if (!s_rows[i].rec) continue;
+            uint32_t cards = lv_obj_get_child_count(s_rows[i].dish_box);
+            for (uint32_t j = 0; j < cards; j++) {
+                dish_card_fit(lv_obj_get_child(s_rows[i].dish_box, j));
+            }
+        }
+    }
+}
 
+// 按钮点击事件：已出餐 → 交给模型，按钮外观在出餐通知中更新
 static void btn_ready_cb(lv_event_t *e)
 {
     bsp_display_lock(portMAX_DELAY);
     
-    lv_obj_t *btn = lv_event_get_target(e);
-    lv_obj_t *label = lv_obj_get_child(btn, 0);  // 获取按钮内的 label
-    if (label) {
-        lv_label_set_text(label, "出餐");
-    }
-
-    // 修改按钮背景色为灰色（针对MAIN部分）
-    lv_obj_set_style_bg_color(btn, lv_color_hex(0xCCCCCC), LV_PART_MAIN);
-
-    // 禁用按钮交互
-    lv_obj_add_state(btn, LV_STATE_DISABLED);
-    lv_obj_clear_flag(btn, LV_OBJ_FLAG_CLICKABLE);
-
-    // 获取订单ID (从按钮的父对象中获取)
-    lv_obj_t *row = lv_obj_get_parent(btn);
-    if (row) {
-        order_info_t *order = NULL;
-        STAILQ_FOREACH(order, &order_list, entries) {
-            if (order->row_widget == row) {
-                // 构建JSON通知消息
-                char notify_msg[128];
-                snprintf(notify_msg, sizeof(notify_msg), 
-                        "{\"orderId\":\"%s\",\"status\":true}", 
-                        order->order_id);
-                
-                // 通过蓝牙通知发送
-                send_notification(notify_msg);
-                
-                ESP_LOGI(TAG, "已发送出餐通知: %s", notify_msg);
-                break;
-            }
-        }
+    // 按钮的user data指向所在的订单行，订单行当前绑定的记录即为要出餐的订单
+    order_row_t *slot = lv_event_get_user_data(e);
+    if (slot && slot->rec && slot->rec->in_use) {
+        order_model_mark_served(s_model, slot->rec);
     }
 
-    ESP_LOGI(TAG, "✅ 已出餐按钮被点击并已禁用");
     bsp_display_unlock();
 }
 
+static void order_view_on_event(order_model_event_t event, order_rec_t *rec, void *arg);
+static void list_scroll_cb(lv_event_t *e);
+static bool list_create_pool(void);
+static void list_layout(void);
+static bool popup_init(void);
+
 // 初始化订单UI容器（优化版）
-void order_ui_init(lv_obj_t *parent)
+void order_ui_init(lv_obj_t *parent, order_model_t *model)
 {
-    if (!parent) {
-        ESP_LOGE(TAG, "父容器为空，无法初始化订单UI");
+    if (!parent || !model) {
+        DLOGE(TAG, "父容器或订单模型为空，无法初始化订单UI");
         return;
     }
     
     bsp_display_lock(portMAX_DELAY);
+    ui_styles_init();
     
-    // 先清理可能存在的旧容器
+    // 先清理可能存在的旧容器和订阅
+    if (s_model) {
+        order_model_unsubscribe(s_model, order_view_on_event, NULL);
+    }
     if (orders_container && lv_obj_is_valid(orders_container)) {
         lv_obj_del(orders_container);
     }
+    memset(s_rows, 0, sizeof(s_rows));
+    s_pool_size = 0;
+    s_item_count = 0;
+    
+    // 订单显示顺序表，容量与模型的记录池一致
+    order_store_stats_t store_stats;
+    order_model_get_stats(model, NULL, &store_stats);
+    if (s_item_cap < store_stats.capacity) {
+        free(s_items);
+        s_items = malloc(store_stats.capacity * sizeof(order_rec_t *));
+        s_item_cap = s_items ? store_stats.capacity : 0;
+        if (!s_items) {
+            bsp_display_unlock();
+            DLOGE(TAG, "分配订单列表失败");
+            return;
+        }
+    }
     
     // 创建主容器，为底部状态栏留出空间
     orders_container = lv_obj_create(parent);
     if (!orders_container) {
         bsp_display_unlock();
-        ESP_LOGE(TAG, "创建订单容器失败");
+        DLOGE(TAG, "创建订单容器失败");
         return;
     }
     
     lv_obj_set_size(orders_container, LV_PCT(100), LV_PCT(90)); // 90%高度，为状态栏留空间
-    lv_obj_set_flex_flow(orders_container, LV_FLEX_FLOW_COLUMN);
-    lv_obj_set_flex_align(orders_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_START);
     lv_obj_set_scrollbar_mode(orders_container, LV_SCROLLBAR_MODE_AUTO);
-    lv_obj_set_style_pad_all(orders_container, 10, 0);
+    lv_obj_set_scroll_dir(orders_container, LV_DIR_VER);
+    lv_obj_add_style(orders_container, &s_style_list, 0);
+    lv_obj_add_event_cb(orders_container, list_scroll_cb, LV_EVENT_SCROLL, NULL);
+
+    // 订单行按显示位置绝对定位，滚动区域高度由占位对象撑开
+    s_spacer = lv_obj_create(orders_container);
+    lv_obj_remove_style_all(s_spacer);
+    lv_obj_set_size(s_spacer, 1, 0);
+    lv_obj_clear_flag(s_spacer, LV_OBJ_FLAG_CLICKABLE);
 
     // 初始显示等待数据
     waiting_label = lv_label_create(orders_container);
     if (waiting_label) {
-        lv_obj_set_style_text_font(waiting_label, &lv_font_device, 0);
+        lv_obj_add_style(waiting_label, &s_style_hint, 0);
         lv_label_set_text(waiting_label, "等待连接...");
         lv_obj_center(waiting_label);
     }
@@ -225,9 +260,7 @@ void order_ui_init(lv_obj_t *parent)
     lv_obj_t *status_bar = lv_obj_create(parent);
     lv_obj_set_size(status_bar, LV_PCT(100), 54);
     lv_obj_align(status_bar, LV_ALIGN_BOTTOM_MID, 0, 0);
-    lv_obj_set_style_bg_color(status_bar, lv_color_hex(0xF1F1F1), 0);
-    lv_obj_set_style_border_width(status_bar, 0, 0);
-    lv_obj_set_style_pad_all(status_bar, 0, 0);
+    lv_obj_add_style(status_bar, &s_style_status_bar, 0);
     
     // 电量显示
     lv_obj_t *battery_label = lv_label_create(status_bar);
@@ -237,114 +270,259 @@ void order_ui_init(lv_obj_t *parent)
     // 蓝牙状态显示
     lv_obj_t *bluetooth_label = lv_label_create(status_bar);
     lv_label_set_text(bluetooth_label, LV_SYMBOL_BLUETOOTH "OK");
-    lv_obj_set_style_text_color(bluetooth_label, lv_color_hex(0x0CC160), 0);
+    lv_obj_add_style(bluetooth_label, &s_style_bt_label, 0);
     lv_obj_align(bluetooth_label, LV_ALIGN_LEFT_MID, 181, 0);
 
+    if (!list_create_pool()) {
+        DLOGE(TAG, "创建订单行池失败");
+    }
+    popup_init();
+
+    // 订阅模型，并把界面创建前已收到的订单按到达顺序加入列表（最新的显示在最上面）
+    s_model = model;
+    order_model_subscribe(model, order_view_on_event, NULL);
+    for (order_rec_t *order = order_model_next(model, NULL); order; order = order_model_next(model, order)) {
+        order->view = NULL;
+        s_items[s_item_count++] = order;
+    }
+    list_layout();
+
     bsp_display_unlock();
-    ESP_LOGI(TAG, "订单UI初始化完成（包含状态栏）");
+    DLOGI(TAG, "订单UI初始化完成（包含状态栏）");
 }
 
 
 
-/* 弹出窗口定时器回调 */
-static void popup_timer_cb(lv_timer_t *timer) {
-    if (!timer) return;
-    
-    lv_obj_t *popup = (lv_obj_t *)lv_timer_get_user_data(timer);
-    
-    // 仅在需要访问LVGL对象时加锁
-    if (popup && lv_obj_is_valid(popup)) {
-        bsp_display_lock(portMAX_DELAY);
-        if (lv_obj_is_valid(popup)) {
-            lv_obj_del(popup);
+// 弹窗：只有一个常驻弹窗和一个定时器，消息到来时只替换标签文字并延长显示时间
+//   - 订单添加/更新/删除合并成一条汇总（如“已添加 3 个订单”）；
+//   - 与正在显示或排队中的相同文字合并，不重复显示；
+//   - 其他消息进入小队列，依次显示，队列满时丢弃最早的一条。
+// 初始化后每条消息都不再分配内存
+#define POPUP_TEXT_MAX      96
+#define POPUP_QUEUE_LEN     4
+#define POPUP_ORDER_MS      2000
+
+typedef enum {
+    POPUP_KIND_TEXT,
+    POPUP_KIND_ORDERS,
+} popup_kind_t;
+
+typedef struct {
+    uint8_t kind;                        // popup_kind_t
+    uint16_t counts[3];                  // 汇总中各类订单变更的数量（order_popup_t）
+    uint32_t duration_ms;
+    char text[POPUP_TEXT_MAX];
+} popup_msg_t;
+
+static lv_obj_t *s_popup = NULL;
+static lv_obj_t *s_popup_label = NULL;
+static lv_timer_t *s_popup_timer = NULL;
+static bool s_popup_visible = false;
+static popup_msg_t s_popup_cur;
+static popup_msg_t s_popup_queue[POPUP_QUEUE_LEN];
+static uint8_t s_popup_head = 0;
+static uint8_t s_popup_len = 0;
+static char s_popup_buf[POPUP_TEXT_MAX + 32];   // 标签静态引用的显示文字
+
+static void popup_timer_cb(lv_timer_t *timer);
+
+// 创建常驻弹窗和定时器（只执行一次）
+static bool popup_init(void) {
+    if (s_popup) return true;
+
+    ui_styles_init();
+    s_popup = lv_obj_create(lv_layer_top());
+    if (!s_popup) {
+        DLOGE(TAG, "创建弹窗失败");
+        return false;
+    }
+    lv_obj_set_size(s_popup, 280, 80);
+    lv_obj_center(s_popup);
+    lv_obj_add_style(s_popup, &s_style_popup, 0);
+    lv_obj_clear_flag(s_popup, LV_OBJ_FLAG_SCROLLABLE | LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_flag(s_popup, LV_OBJ_FLAG_HIDDEN);
+
+    s_popup_label = lv_label_create(s_popup);
+    lv_label_set_text_static(s_popup_label, "");
+    lv_obj_center(s_popup_label);
+
+    s_popup_timer = lv_timer_create(popup_timer_cb, POPUP_ORDER_MS, NULL);
+    if (!s_popup_timer) {
+        lv_obj_del(s_popup);
+        s_popup = NULL;
+        DLOGE(TAG, "创建弹窗定时器失败");
+        return false;
+    }
+    lv_timer_pause(s_popup_timer);
+    return true;
+}
+
+// 按显示字节数截断，不截断UTF-8字符
+static void popup_copy_text(char *out, const char *text) {
+    size_t len = strlen(text);
+    if (len >= POPUP_TEXT_MAX) {
+        len = POPUP_TEXT_MAX - 1;
+        while (len > 0 && ((uint8_t)text[len] & 0xC0) == 0x80) {
+            len--;
         }
-        bsp_display_unlock();
     }
-    
-    lv_timer_del(timer); // 最后删除定时器，且只删一次
+    memcpy(out, text, len);
+    out[len] = '\0';
 }
 
-void show_popup_message(const char *message, uint32_t duration_ms) {
-    bsp_display_lock(portMAX_DELAY);
-    
-    // 创建弹窗
-    lv_obj_t *popup = lv_obj_create(lv_scr_act());
-    if (!popup) {
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "创建弹窗失败");
-        return;
+static void popup_render(void) {
+    const popup_msg_t *msg = &s_popup_cur;
+    if (msg->kind == POPUP_KIND_TEXT) {
+        memcpy(s_popup_buf, msg->text, sizeof(msg->text));
+    } else {
+        static const char *const single[] = {"订单已添加", "订单已更新", "订单已删除"};
+        static const char *const verbs[] = {"添加", "更新", "删除"};
+        int kinds = 0, last = 0;
+        for (int i = 0; i < 3; i++) {
+            if (msg->counts[i]) {
+                kinds++;
+                last = i;
+            }
+        }
+        if (kinds == 1 && msg->counts[last] == 1) {
+            snprintf(s_popup_buf, sizeof(s_popup_buf), "%s", single[last]);
+        } else if (kinds == 1) {
+            snprintf(s_popup_buf, sizeof(s_popup_buf), "已%s %u 个订单", verbs[last], msg->counts[last]);
+        } else {
+            size_t pos = snprintf(s_popup_buf, sizeof(s_popup_buf), "订单:");
+            const char *sep = " ";
+            for (int i = 0; i < 3; i++) {
+                if (msg->counts[i] && pos < sizeof(s_popup_buf)) {
+                    pos += snprintf(s_popup_buf + pos, sizeof(s_popup_buf) - pos, "%s%s %u", sep, verbs[i], msg->counts[i]);
+                    sep = ", ";
+                }
+            }
+        }
     }
+    // 同一缓冲区重新设置即刷新标签，不分配内存
+    lv_label_set_text_static(s_popup_label, s_popup_buf);
+}
 
-    // 基本样式设置
-    lv_obj_set_size(popup, 280, 80);
-    lv_obj_center(popup);
-    lv_obj_set_style_bg_color(popup, lv_color_black(), 0);
-    lv_obj_set_style_bg_opa(popup, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(popup, 0, 0);
-    lv_obj_set_style_pad_all(popup, 5, 0);
-    lv_obj_set_style_text_font(popup, &lv_font_montserrat_14, 0);
-
-    // 创建消息标签
-    lv_obj_t *label = lv_label_create(popup);
-    lv_label_set_text(label, message);
-    lv_obj_set_style_text_color(label, lv_color_white(), 0);
-    lv_obj_center(label);
-
-    // 设置定时器自动关闭弹出窗口
-    lv_timer_t *timer = lv_timer_create(popup_timer_cb, duration_ms, popup);
-    if (!timer) {
-        // 定时器创建失败时手动删除弹窗
-        lv_obj_del(popup);
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "创建弹窗定时器失败");
-        return;
-    }
-    lv_timer_set_repeat_count(timer, 1);
+// 重新开始计时
+static void popup_arm(uint32_t duration_ms) {
+    lv_timer_set_period(s_popup_timer, duration_ms);
+    lv_timer_reset(s_popup_timer);
+    lv_timer_resume(s_popup_timer);
+}
 
-    bsp_display_unlock();
+static void popup_show(const popup_msg_t *msg) {
+    s_popup_cur = *msg;
+    popup_render();
+    lv_obj_clear_flag(s_popup, LV_OBJ_FLAG_HIDDEN);
+    s_popup_visible = true;
+    popup_arm(msg->duration_ms);
+    s_stats.popups_shown++;
 }
 
-// 根据订单ID查找订单（优化版）- 添加空指针检查
-static order_info_t *find_order_by_id(const char *order_id) {
-    if (!order_id) return NULL;
-    
-    order_info_t *order;
-    STAILQ_FOREACH(order, &order_list, entries) {
-        if (order->order_id && strcmp(order->order_id, order_id) == 0) {
-            return order;
-        }
+static bool popup_merge(popup_msg_t *into, const popup_msg_t *msg) {
+    if (into->kind != msg->kind) return false;
+    if (msg->kind == POPUP_KIND_TEXT && strcmp(into->text, msg->text) != 0) return false;
+
+    for (int i = 0; i < 3; i++) {
+        into->counts[i] += msg->counts[i];
     }
-    return NULL;
+    if (msg->duration_ms > into->duration_ms) {
+        into->duration_ms = msg->duration_ms;
+    }
+    s_stats.popups_coalesced++;
+    return true;
 }
 
-// 安全释放订单内存
-static void safe_free_order(order_info_t *order) {
-    if (!order) return;
-    
-    if (order->order_id) {
-        free(order->order_id);
-        order->order_id = NULL;
+static void popup_push(const popup_msg_t *msg) {
+    if (!popup_init()) return;
+
+    // 与正在显示的消息合并：只换文字并延长显示时间
+    if (s_popup_visible && popup_merge(&s_popup_cur, msg)) {
+        popup_render();
+        popup_arm(msg->duration_ms);
+        return;
+    }
+    for (uint8_t i = 0; i < s_popup_len; i++) {
+        if (popup_merge(&s_popup_queue[(s_popup_head + i) % POPUP_QUEUE_LEN], msg)) {
+            return;
+        }
     }
-    if (order->dishes) {
-        free(order->dishes);
-        order->dishes = NULL;
+    if (!s_popup_visible) {
+        popup_show(msg);
+        return;
+    }
+
+    if (s_popup_len == POPUP_QUEUE_LEN) {
+        s_popup_head = (s_popup_head + 1) % POPUP_QUEUE_LEN;
+        s_popup_len--;
+        s_stats.popups_dropped++;
+    }
+    s_popup_queue[(s_popup_head + s_popup_len) % POPUP_QUEUE_LEN] = *msg;
+    s_popup_len++;
+}
+
+/* 弹出窗口定时器回调：显示队列中的下一条，没有时隐藏弹窗 */
+static void popup_timer_cb(lv_timer_t *timer) {
+    bsp_display_lock(portMAX_DELAY);
+
+    if (s_popup_len) {
+        popup_msg_t next = s_popup_queue[s_popup_head];
+        s_popup_head = (s_popup_head + 1) % POPUP_QUEUE_LEN;
+        s_popup_len--;
+        popup_show(&next);
+    } else {
+        lv_obj_add_flag(s_popup, LV_OBJ_FLAG_HIDDEN);
+        s_popup_visible = false;
+        lv_timer_pause(timer);
     }
-    free(order);
+
+    bsp_display_unlock();
+}
+
+void show_popup_message(const char *message, uint32_t duration_ms) {
+    if (!message) return;
+
+    bsp_display_lock(portMAX_DELAY);
+    popup_msg_t msg = {
+        .kind = POPUP_KIND_TEXT,
+        .duration_ms = duration_ms,
+    };
+    popup_copy_text(msg.text, message);
+    popup_push(&msg);
+    bsp_display_unlock();
+}
+
+void show_order_popup(order_popup_t event) {
+    if (event > ORDER_POPUP_REMOVED) return;
+
+    bsp_display_lock(portMAX_DELAY);
+    popup_msg_t msg = {
+        .kind = POPUP_KIND_ORDERS,
+        .duration_ms = POPUP_ORDER_MS,
+    };
+    msg.counts[event] = 1;
+    popup_push(&msg);
+    bsp_display_unlock();
 }
 
 // 清理所有订单资源
 void order_ui_cleanup(void) {
     bsp_display_lock(portMAX_DELAY);
     
-    // 清理订单队列
-    order_info_t *order, *temp;
-    STAILQ_FOREACH_SAFE(order, &order_list, entries, temp) {
-        STAILQ_REMOVE(&order_list, order, order_info, entries);
-        safe_free_order(order);
+    // 取消订阅并解除记录与订单行的关联（订单行随容器一起删除）
+    if (s_model) {
+        order_model_unsubscribe(s_model, order_view_on_event, NULL);
+        for (order_rec_t *order = order_model_next(s_model, NULL); order; order = order_model_next(s_model, order)) {
+            order->view = NULL;
+        }
+        s_model = NULL;
     }
-    
-    // 清理预渲染缓存
-    cleanup_prerender_cache();
+    memset(s_rows, 0, sizeof(s_rows));
+    s_pool_size = 0;
+    s_item_count = 0;
+    s_item_cap = 0;
+    free(s_items);
+    s_items = NULL;
     
     // 清理UI容器
     if (orders_container && lv_obj_is_valid(orders_container)) {
@@ -353,76 +531,69 @@ void order_ui_cleanup(void) {
     }
     
     waiting_label = NULL;
+    s_spacer = NULL;
     
     bsp_display_unlock();
-    ESP_LOGI(TAG, "订单UI资源清理完成");
+    DLOGI(TAG, "订单UI资源清理完成");
 }
 
-// Unicode十六进制编码解码函数（性能优化版）
-static char* decode_unicode_hex(const char* hex_str) {
-    if (!hex_str) return NULL;
-    
-    size_t len = strlen(hex_str);
-    if (len % 2 != 0) return strdup(hex_str);
-    
-    size_t out_len = len / 2 + 1;
-    char* result = malloc(out_len);
-    if (!result) return NULL;
-    
-    for (size_t i = 0, j = 0; i < len; i += 2, j++) {
-        char hex[3] = {hex_str[i], hex_str[i+1], '\0'};
-        int value;
-        // 使用更快的十六进制转换
-        if (hex[0] >= '0' && hex[0] <= '9') value = (hex[0] - '0') << 4;
-        else if (hex[0] >= 'A' && hex[0] <= 'F') value = (hex[0] - 'A' + 10) << 4;
-        else if (hex[0] >= 'a' && hex[0] <= 'f') value = (hex[0] - 'a' + 10) << 4;
-        else { free(result); return strdup(hex_str); }
-        
-        if (hex[1] >= '0' && hex[1] <= '9') value |= (hex[1] - '0');
-        else if (hex[1] >= 'A' && hex[1] <= 'F') value |= (hex[1] - 'A' + 10);
-        else if (hex[1] >= 'a' && hex[1] <= 'f') value |= (hex[1] - 'a' + 10);
-        else { free(result); return strdup(hex_str); }
-        
-        result[j] = (char)value;
-    }
-    result[out_len - 1] = '\0';
-    
-    return result;
+// 菜品名能否显示在卡片上（过长的菜品名不显示）
+static bool dish_displayable(const char *dish_name) {
+    if (!dish_name || !*dish_name) return false;
+    if (strlen(dish_name) >= 48) {
+        DLOGW(TAG, "菜品名称过长，已截断: %s", dish_name);
+        return false;
+    }
+    return true;
 }
 
-// 创建菜品卡片（性能优化版）- 减少内存分配和样式设置
-static lv_obj_t* create_dish_card(lv_obj_t* parent, const char* dish_name) {
-    if (!parent || !dish_name || !*dish_name) return NULL;
-    
-    // 检查菜品名称长度
-    size_t name_len = strlen(dish_name);
-    if (name_len >= 48) {
-        ESP_LOGW(TAG, "菜品名称过长，已截断: %s", dish_name);
-        // 可以在这里进行截断处理，但为了安全直接返回
-        return NULL;
+static inline dish_id_t dish_card_key(lv_obj_t *dish_card) {
+    return (dish_id_t)(uintptr_t)lv_obj_get_user_data(dish_card);
+}
+
+// 按缓存的测量结果设置卡片和标签尺寸：标签宽度直接给定，布局时不再按内容测量
+static void dish_card_fit(lv_obj_t *dish_card) {
+    lv_obj_t *label = lv_obj_get_child(dish_card, 0);
+    text_metrics_t m;
+    if (!text_measure_dish(dish_card_key(dish_card), s_dish_style_font, CARD_TEXT_MAX_W, &m)) {
+        lv_obj_set_size(dish_card, CARD_W_MIN, CARD_H);
+        lv_obj_set_size(label, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+        return;
     }
-    
-    // 异步预渲染，不阻塞UI创建
-    if (dish_font) {
-        // 延迟预渲染，避免阻塞UI线程
-        static uint32_t last_prerender_time = 0;
-        uint32_t current_time = lv_tick_get();
-        if (current_time - last_prerender_time > 10) { // 每10ms最多预渲染一次
-            prerender_text(dish_name, dish_font);
-            last_prerender_time = current_time;
-        }
+
+    int32_t w = m.wrap_width + 2 * CARD_PAD;
+    int32_t h = m.lines > 1 ? m.height + 2 * CARD_PAD : CARD_H;
+    lv_label_long_mode_t mode = LV_LABEL_LONG_WRAP;
+    if (w < CARD_W_MIN) w = CARD_W_MIN;
+    if (h > CARD_H_MAX) {
+        // 放不下的行以省略号结尾
+        h = CARD_H_MAX;
+        mode = LV_LABEL_LONG_DOT;
     }
-    
+
+    lv_obj_set_size(dish_card, w, h);
+    if (lv_label_get_long_mode(label) != mode) {
+        lv_label_set_long_mode(label, mode);
+    }
+    lv_obj_set_size(label, m.wrap_width,
+                    mode == LV_LABEL_LONG_DOT ? h - 2 * CARD_PAD : LV_SIZE_CONTENT);
+}
+
+// 设置菜品卡片的菜品：卡片的user data保存菜品名句柄作为比对的键
+// 菜品名来自驻留表，订单记录存在期间地址不变，标签直接引用不拷贝
+static void dish_card_set(lv_obj_t *dish_card, dish_id_t id) {
+    lv_obj_set_user_data(dish_card, (void *)(uintptr_t)id);
+    dish_card_fit(dish_card);
+    lv_label_set_text_static(lv_obj_get_child(dish_card, 0), dish_intern_str(id));
+}
+
+// 创建菜品卡片（性能优化版）- 减少内存分配和样式设置
+static lv_obj_t* create_dish_card(lv_obj_t* parent, dish_id_t id) {
     lv_obj_t *dish_card = lv_obj_create(parent);
     if (!dish_card) return NULL;
     
-    // 简化样式设置
-    lv_obj_set_size(dish_card, 120, 39);
-    lv_obj_set_style_bg_color(dish_card, lv_color_hex(0xF1F1F1), 0);
-    lv_obj_set_style_radius(dish_card, 5, 0);
-    lv_obj_set_style_pad_all(dish_card, 8, 0);
-    lv_obj_set_style_border_width(dish_card, 0, 0);
-    lv_obj_set_style_margin_all(dish_card, 5, 0);
+    // 外观和文字属性都来自共享样式，标签继承卡片的字体、颜色和对齐；尺寸在设置菜品时取定
+    lv_obj_add_style(dish_card, &s_style_dish_card, 0);
     
     // 创建标签
     lv_obj_t *dish_label = lv_label_create(dish_card);
@@ -431,280 +602,391 @@ static lv_obj_t* create_dish_card(lv_obj_t* parent, const char* dish_name) {
         return NULL;
     }
     
-    lv_label_set_text(dish_label, dish_name);
-    
-    // 使用从main.c加载的菜品字体
-    if (dish_font) {
-        lv_obj_set_style_text_font(dish_label, dish_font, 0);
-    } else {
-        lv_obj_set_style_text_font(dish_label, &lv_font_device, 0);
-    }
-    lv_obj_set_style_text_color(dish_label, lv_color_black(), 0);
-    lv_obj_set_style_text_align(dish_label, LV_TEXT_ALIGN_CENTER, 0);
     lv_obj_center(dish_label);
     lv_obj_clear_flag(dish_label, LV_OBJ_FLAG_SCROLLABLE);
     
+    dish_card_set(dish_card, id);
     return dish_card;
 }
 
-// 初始化菜品字体预渲染（在程序启动时调用）
-void init_dish_font_prerender(void) {
-    if (dish_font) {
-        ESP_LOGI(TAG, "开始预渲染常用中文字符...");
-        prerender_common_chinese_chars(dish_font);
-        ESP_LOGI(TAG, "菜品字体预渲染完成");
-    } else {
-        ESP_LOGW(TAG, "菜品字体未加载，跳过预渲染");
+// 按菜品名句柄比对已有卡片和订单的菜品，只创建/删除有差异的卡片：
+//   - 同一位置菜品相同的卡片保持不动；
+//   - 后面有相同菜品的卡片移到当前位置；
+//   - 当前位置的卡片后面用不到时直接换成新菜品名（如只改了数量）；
+//   - 以上都不满足时才创建新卡片，多余的卡片最后删除。
+// 卡片尺寸取自测量缓存，改字后宽度不变时只重绘该标签，不触发整行重新布局
+static void sync_dish_cards(lv_obj_t *dish_box, const order_rec_t *order) {
+    dish_id_t ids[ORDER_STORE_MAX_DISHES];
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < order->dish_count; i++) {
+        if (dish_displayable(order_rec_dish(order, i))) {
+            ids[count++] = order->dishes[i];
+        }
     }
-}
 
-// 创建订单行（带订单ID）- 优化版（增强错误处理）
-void create_dynamic_order_row_with_id(const char *order_id, int order_num, const char *dishes) {
-    if (!order_id || !dishes) {
-        ESP_LOGE(TAG, "订单ID或菜品信息为空");
-        return;
-    }
-    
-    bsp_display_lock(portMAX_DELAY);
-    
-    // 清理等待标签
-    if (waiting_label && lv_obj_is_valid(waiting_label)) {
-        lv_obj_del(waiting_label);
-        waiting_label = NULL;
-    }
+    ui_styles_sync_dish_font();
 
-    // 创建订单行
-    lv_obj_t *row = lv_obj_create(orders_container);
-    if (!row) {
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "创建订单行失败");
-        return;
+    uint16_t created = 0, reused = 0, deleted = 0;
+    uint32_t i = 0;
+    for (; i < count; i++) {
+        uint32_t cards = lv_obj_get_child_count(dish_box);
+        lv_obj_t *card = i < cards ? lv_obj_get_child(dish_box, i) : NULL;
+        if (card && dish_card_key(card) == ids[i]) {
+            reused++;
+            continue;
+        }
+
+        // 后面有相同菜品的卡片时移过来
+        lv_obj_t *match = NULL;
+        for (uint32_t j = i + 1; j < cards; j++) {
+            lv_obj_t *other = lv_obj_get_child(dish_box, j);
+            if (dish_card_key(other) == ids[i]) {
+                match = other;
+                break;
+            }
+        }
+        if (match) {
+            lv_obj_move_to_index(match, i);
+            reused++;
+            continue;
+        }
+
+        // 当前位置的卡片之后用不到时改字复用
+        bool needed_later = false;
+        for (uint16_t k = i + 1; card && k < count; k++) {
+            if (ids[k] == dish_card_key(card)) {
+                needed_later = true;
+                break;
+            }
+        }
+        if (card && !needed_later) {
+            dish_card_set(card, ids[i]);
+            reused++;
+            continue;
+        }
+
+        card = create_dish_card(dish_box, ids[i]);
+        if (!card) break;
+        lv_obj_move_to_index(card, i);
+        created++;
     }
-    
-    // 分配订单内存
-    order_info_t *order = malloc(sizeof(order_info_t));
-    if (!order) {
-        lv_obj_del(row);
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "分配订单内存失败");
-        return;
+
+    // 删除多余的卡片
+    while (lv_obj_get_child_count(dish_box) > i) {
+        lv_obj_del(lv_obj_get_child(dish_box, -1));
+        deleted++;
     }
-    
-    memset(order, 0, sizeof(order_info_t));
-    order->order_id = strdup(order_id);
-    order->dishes = strdup(dishes);
-    order->order_num = order_num;
-    order->row_widget = row;
-    order->status = ORDER_STATUS_PENDING;
-    
-    if (!order->order_id || !order->dishes) {
-        safe_free_order(order);
-        lv_obj_del(row);
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "复制订单信息失败");
-        return;
+
+    s_stats.cards_created += created;
+    s_stats.cards_reused += reused;
+    s_stats.cards_deleted += deleted;
+    DLOGD(TAG, "订单 %s 菜品卡片: 新建 %u, 复用 %u, 删除 %u", order->order_id, created, reused, deleted);
+}
+
+// 初始化菜品字体预渲染（菜品字体加载并包装字形缓存后调用）
+void init_dish_font_prerender(void) {
+    esp_err_t err = glyph_cache_warm(s_common_dish_chars, sizeof(s_common_dish_chars) - 1);
+    if (err == ESP_OK) {
+        DLOGI(TAG, "常用中文字符已加入字形预热队列");
+    } else {
+        DLOGW(TAG, "字形缓存不可用，跳过预渲染: %s", esp_err_to_name(err));
     }
+}
+
+// 创建行池中的一个订单行（左侧菜品容器 + 右侧出餐按钮），创建后隐藏等待绑定
+static bool list_create_row(order_row_t *slot) {
+    lv_obj_t *row = lv_obj_create(orders_container);
+    if (!row) return false;
 
     // 设置订单行样式
-    lv_obj_set_size(row, LV_PCT(100), 96);
+    lv_obj_set_size(row, LV_PCT(100), ROW_HEIGHT);
     lv_obj_set_flex_flow(row, LV_FLEX_FLOW_ROW);
     lv_obj_set_flex_align(row, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_SPACE_BETWEEN);
-    lv_obj_set_style_pad_all(row, 10, 0);
-    lv_obj_set_style_radius(row, 5, 0);
-    lv_obj_set_style_bg_color(row, lv_color_white(), 0);
+    lv_obj_add_style(row, &s_style_row, 0);
     lv_obj_clear_flag(row, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_move_to_index(row, 0);
+    lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
 
     // 左侧：菜品容器
     lv_obj_t *left_container = lv_obj_create(row);
     if (!left_container) {
-        free(order->dishes);
-        free(order->order_id);
-        free(order);
         lv_obj_del(row);
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "创建左侧容器失败");
-        return;
+        return false;
     }
     
     lv_obj_set_width(left_container, LV_PCT(70));
     lv_obj_set_height(left_container, LV_SIZE_CONTENT);
     lv_obj_set_flex_flow(left_container, LV_FLEX_FLOW_ROW_WRAP);
-    lv_obj_set_style_border_width(left_container, 0, 0);
-    lv_obj_set_style_pad_all(left_container, 0, 0);
-    
-    // 解析菜品信息（优化版）- 使用更高效的JSON解析
-    cJSON *root = cJSON_Parse(dishes);
-    if (root) {
-        cJSON *items = cJSON_GetObjectItem(root, "items");
-        if (items && cJSON_IsArray(items)) {
-            int item_count = cJSON_GetArraySize(items);
-            ESP_LOGD(TAG, "解析到 %d 个菜品", item_count);
-            
-            cJSON *item = NULL;
-            cJSON_ArrayForEach(item, items) {
-                cJSON *name = cJSON_GetObjectItem(item, "name");
-                if (name && cJSON_IsString(name) && name->valuestring) {
-                    // 限制菜品名称长度，防止内存溢出
-                    if (strlen(name->valuestring) < 48) {
-                        create_dish_card(left_container, name->valuestring);
-                    } else {
-                        ESP_LOGW(TAG, "菜品名称过长，已跳过: %s", name->valuestring);
-                    }
-                }
-            }
-        } else {
-            ESP_LOGW(TAG, "JSON中没有找到items数组");
-        }
-        cJSON_Delete(root);
-    } else {
-        ESP_LOGE(TAG, "JSON解析失败: %s", dishes);
-    }
-    
-    order->dish_label = left_container;
+    lv_obj_add_style(left_container, &s_style_dish_box, 0);
 
     // 右侧：已出餐按钮
     lv_obj_t *btn_ready = lv_btn_create(row);
     if (!btn_ready) {
-        free(order->dishes);
-        free(order->order_id);
-        free(order);
-        lv_obj_del(left_container);
         lv_obj_del(row);
-        bsp_display_unlock();
-        ESP_LOGE(TAG, "创建按钮失败");
-        return;
+        return false;
     }
     
     lv_obj_set_size(btn_ready, 143, 74);
     lv_obj_align(btn_ready, LV_ALIGN_RIGHT_MID, 0, 0);
-    lv_obj_set_style_bg_color(btn_ready, lv_color_hex(0x52E011), LV_PART_MAIN);
-    lv_obj_set_style_radius(btn_ready, 5, 0);
-    lv_obj_set_style_border_width(btn_ready, 0, 0);
+    lv_obj_add_style(btn_ready, &s_style_btn, LV_PART_MAIN);
+    lv_obj_add_style(btn_ready, &s_style_btn_served, LV_PART_MAIN | LV_STATE_DISABLED);
     lv_obj_clear_flag(btn_ready, LV_OBJ_FLAG_SCROLLABLE);
     
     lv_obj_t *btn_label = lv_label_create(btn_ready);
-    lv_label_set_text(btn_label, "出餐");
-    lv_obj_set_style_text_color(btn_label, lv_color_white(), 0);
-    lv_obj_set_style_text_font(btn_label, &lv_font_device, 0);
+    lv_label_set_text_static(btn_label, "出餐");
     lv_obj_center(btn_label);
-    lv_obj_add_event_cb(btn_ready, btn_ready_cb, LV_EVENT_CLICKED, NULL);
+    lv_obj_add_event_cb(btn_ready, btn_ready_cb, LV_EVENT_CLICKED, slot);
 
-    STAILQ_INSERT_TAIL(&order_list, order, entries);
-    bsp_display_unlock();
+    slot->row = row;
+    slot->dish_box = left_container;
+    slot->btn = btn_ready;
+    slot->rec = NULL;
+    return true;
 }
 
-// 创建订单行（动态添加到 UI）
-void create_dynamic_order_row(int order_num, const char *dishes) {
-    // 默认使用订单号作为ID
-    char default_id[32];
-    snprintf(default_id, sizeof(default_id), "order_%d", order_num);
-    create_dynamic_order_row_with_id(default_id, order_num, dishes);
+// LVGL堆已用字节数（仅内置分配器可统计）
+static uint32_t lvgl_heap_used(void) {
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+#else
+    return 0;
+#endif
 }
 
-// 根据订单ID删除订单（优化版）- 增强错误处理
-void remove_order_by_id(const char *order_id) {
-    if (!order_id) {
-        ESP_LOGW(TAG, "订单ID为空，无法删除");
-        return;
+// 按容器可见高度创建行池，行数与订单数无关
+static bool list_create_pool(void) {
+    lv_obj_update_layout(orders_container);
+    int32_t visible = lv_obj_get_content_height(orders_container) / ROW_PITCH + 2;
+    uint16_t pool = (uint16_t)(visible + 2 * ROW_OVERSCAN);
+    if (pool > ROW_POOL_MAX) pool = ROW_POOL_MAX;
+
+    // 记录每行创建耗时和行池占用的LVGL堆，用于对比样式改动前后的开销
+    uint32_t heap_before = lvgl_heap_used();
+    int64_t start = esp_timer_get_time();
+    for (s_pool_size = 0; s_pool_size < pool; s_pool_size++) {
+        if (!list_create_row(&s_rows[s_pool_size])) {
+            break;
+        }
     }
-    
-    bsp_display_lock(portMAX_DELAY);
+    if (s_pool_size == 0) return false;
 
-    order_info_t *order = find_order_by_id(order_id);
-    if (!order) {
-        bsp_display_unlock();
-        ESP_LOGW(TAG, "订单ID %s 不存在，无法删除", order_id);
-        return;
+    s_stats.rows = s_pool_size;
+    s_stats.row_create_us = (uint32_t)((esp_timer_get_time() - start) / s_pool_size);
+    s_stats.pool_heap = lvgl_heap_used() - heap_before;
+    DLOGI(TAG, "行池: %u 行, 每行创建 %lu us, LVGL堆 %lu 字节 (每行 %lu)",
+          s_pool_size, s_stats.row_create_us, s_stats.pool_heap, s_stats.pool_heap / s_pool_size);
+    return true;
+}
+
+// 出餐按钮外观：已出餐时变灰并禁用
+static void row_set_served(order_row_t *slot, bool served) {
+    if (served) {
+        lv_obj_add_state(slot->btn, LV_STATE_DISABLED);
+        lv_obj_clear_flag(slot->btn, LV_OBJ_FLAG_CLICKABLE);
+    } else {
+        lv_obj_clear_state(slot->btn, LV_STATE_DISABLED);
+        lv_obj_add_flag(slot->btn, LV_OBJ_FLAG_CLICKABLE);
+    }
+}
+
+// 解除订单行与订单的绑定，订单行回到空闲状态
+// 空闲期间订单可能被删除，菜品名淘汰后句柄会分配给别的菜品名、文本也会移走：
+// 清掉卡片的键和静态文本，不再引用驻留表，重新绑定时卡片改字复用
+static void row_unbind(order_row_t *slot) {
+    if (slot->rec) {
+        slot->rec->view = NULL;
+        slot->rec = NULL;
+    }
+    lv_obj_add_flag(slot->row, LV_OBJ_FLAG_HIDDEN);
+
+    uint32_t cards = lv_obj_get_child_count(slot->dish_box);
+    for (uint32_t i = 0; i < cards; i++) {
+        lv_obj_t *card = lv_obj_get_child(slot->dish_box, i);
+        lv_obj_set_user_data(card, (void *)(uintptr_t)DISH_ID_NONE);
+        lv_label_set_text_static(lv_obj_get_child(card, 0), "");
     }
+}
+
+// 把空闲订单行绑定到订单：按差异复用上一个订单留下的菜品卡片并同步出餐状态
+// 同步菜品卡片并立即完成菜品容器的布局，统计每行的布局耗时
+static void row_layout_dishes(order_row_t *slot, const order_rec_t *order) {
+    int64_t start = esp_timer_get_time();
+    sync_dish_cards(slot->dish_box, order);
+    lv_obj_update_layout(slot->dish_box);
+    s_stats.row_layout_us += (uint32_t)(esp_timer_get_time() - start);
+    s_stats.row_layouts++;
+}
+
+static void row_bind(order_row_t *slot, order_rec_t *order) {
+    row_layout_dishes(slot, order);
+    row_set_served(slot, order->status == ORDER_STATUS_COMPLETED);
+    lv_obj_clear_flag(slot->row, LV_OBJ_FLAG_HIDDEN);
 
-    // 从UI中移除订单行
-    if (order->row_widget && lv_obj_is_valid(order->row_widget)) {
-        lv_obj_del(order->row_widget);
-        order->row_widget = NULL;
+    slot->rec = order;
+    order->view = slot;
+    s_stats.binds++;
+}
+
+// 按滚动位置重新分配订单行：仍在可见范围内的订单只移动位置，其余订单行解绑后复用
+static void list_layout(void) {
+    if (!orders_container || !s_items) return;
+
+    // 滚动区域高度随订单数变化，订单行本身数量不变
+    lv_obj_set_height(s_spacer, s_item_count ? s_item_count * ROW_PITCH - ROW_GAP : 0);
+
+    if (s_item_count == 0) {
+        if (!waiting_label) {
+            waiting_label = lv_label_create(orders_container);
+            if (waiting_label) {
+                lv_obj_add_style(waiting_label, &s_style_hint, 0);
+                lv_label_set_text(waiting_label, s_model ? "已连接" : "等待连接...");
+                lv_obj_center(waiting_label);
+            }
+        }
+    } else if (waiting_label) {
+        lv_obj_del(waiting_label);
+        waiting_label = NULL;
     }
 
-    // 从队列中移除并安全释放内存
-    STAILQ_REMOVE(&order_list, order, order_info, entries);
-    safe_free_order(order);
+    int32_t top = lv_obj_get_scroll_y(orders_container) / ROW_PITCH - ROW_OVERSCAN;
+    uint16_t first = top > 0 ? (uint16_t)top : 0;
+    if (first > s_item_count) first = s_item_count;
+    uint16_t last = first + s_pool_size;
+    if (last > s_item_count) last = s_item_count;
+
+    // 先释放绑定在可见范围外的订单行
+    for (uint16_t i = 0; i < s_pool_size; i++) {
+        order_row_t *slot = &s_rows[i];
+        if (!slot->rec) continue;
+        bool visible = false;
+        for (uint16_t n = first; n < last; n++) {
+            if (item_at(n) == slot->rec) {
+                visible = true;
+                break;
+            }
+        }
+        if (!visible) {
+            row_unbind(slot);
+        }
+    }
 
-    // 如果删除后队列为空，恢复等待标签
-    if (STAILQ_EMPTY(&order_list) && orders_container && lv_obj_is_valid(orders_container) && !waiting_label) {
-        waiting_label = lv_label_create(orders_container);
-        if (waiting_label) {
-            lv_obj_set_style_text_font(waiting_label, &lv_font_device, 0);
-            lv_label_set_text(waiting_label, "已连接");
-            lv_obj_center(waiting_label);
+    // 再为可见范围内还没有订单行的订单分配空闲订单行
+    uint16_t free_slot = 0;
+    for (uint16_t n = first; n < last; n++) {
+        order_rec_t *order = item_at(n);
+        order_row_t *slot = order->view;
+        if (!slot) {
+            while (free_slot < s_pool_size && s_rows[free_slot].rec) free_slot++;
+            if (free_slot == s_pool_size) break;
+            slot = &s_rows[free_slot];
+            row_bind(slot, order);
         }
+        lv_obj_set_pos(slot->row, 0, n * ROW_PITCH);
     }
+}
 
+// 滚动时重新绑定订单行
+static void list_scroll_cb(lv_event_t *e) {
+    bsp_display_lock(portMAX_DELAY);
+    list_layout();
     bsp_display_unlock();
-    ESP_LOGI(TAG, "已删除订单: %s", order_id);
 }
 
-// 根据订单ID更新订单信息（优化版）- 增强错误处理
-void update_order_by_id(const char *order_id, int order_num, const char *dishes) {
-    if (!order_id || !dishes) {
-        ESP_LOGW(TAG, "订单ID或菜品信息为空");
-        return;
+// 新订单显示在最上面
+static void view_add_row(order_rec_t *order) {
+    if (!s_items || s_item_count >= s_item_cap) return;
+
+    order->view = NULL;
+    s_items[s_item_count++] = order;
+    list_layout();
+}
+
+// 从列表中删除订单，订单行回到行池
+static void view_remove_row(order_rec_t *order) {
+    if (order->view) {
+        row_unbind(order->view);
     }
-    
+    for (uint16_t i = 0; i < s_item_count; i++) {
+        if (s_items[i] == order) {
+            memmove(&s_items[i], &s_items[i + 1], (s_item_count - i - 1) * sizeof(order_rec_t *));
+            s_item_count--;
+            break;
+        }
+    }
+    list_layout();
+}
+
+// 更新菜品 - 只改动有差异的菜品卡片
+static void view_update_row(order_rec_t *order) {
+    row_layout_dishes(order->view, order);
+}
+
+// 订单模型变更通知（在发起变更的任务中调用）
+static void order_view_on_event(order_model_event_t event, order_rec_t *rec, void *arg) {
     bsp_display_lock(portMAX_DELAY);
 
-    order_info_t *order = find_order_by_id(order_id);
-    if (!order) {
-        bsp_display_unlock();
-        ESP_LOGW(TAG, "订单ID %s 不存在，无法更新", order_id);
-        return;
+    // 不可见的订单没有订单行，更新和出餐在滚动到可见时按记录重新绑定
+    switch (event) {
+    case ORDER_MODEL_ADDED:
+        warm_order_dishes(rec);
+        view_add_row(rec);
+        break;
+    case ORDER_MODEL_REMOVED:
+        view_remove_row(rec);
+        break;
+    case ORDER_MODEL_UPDATED:
+        warm_order_dishes(rec);
+        if (rec->view) view_update_row(rec);
+        break;
+    case ORDER_MODEL_SERVED:
+        if (rec->view) {
+            row_set_served(rec->view, true);
+            DLOGI(TAG, "✅ 订单 %s 已出餐，按钮已禁用", rec->order_id);
+        }
+        break;
+    default:
+        break;
     }
 
-    // 更新订单信息
-    order->order_num = order_num;
-    
-    // 安全更新菜品信息
-    char *new_dishes = strdup(dishes);
-    if (new_dishes) {
-        free(order->dishes);
-        order->dishes = new_dishes;
-    } else {
-        ESP_LOGE(TAG, "复制菜品信息失败");
-        bsp_display_unlock();
+    bsp_display_unlock();
+}
+
+void order_ui_get_stats(order_ui_stats_t *stats) {
+    if (!stats) return;
+    *stats = s_stats;
+    stats->orders = s_item_count;
+}
+
+void order_ui_sync_dish_font(void) {
+    // 订单界面尚未创建时，创建共享样式时直接取当时的菜品字体
+    if (!s_styles_ready) return;
+    ui_styles_sync_dish_font();
+}
+
+void order_ui_log_stats(void) {
+    // 在esp_timer任务中调用，读取LVGL堆需要持有显示锁；不能阻塞定时器任务，显示忙时跳过本次
+    if (!bsp_display_lock(0)) {
+        DLOGD(TAG, "显示锁被占用，跳过本次订单列表统计");
         return;
     }
-    
-    // 更新UI显示 - 清除旧的菜品卡片并创建新的
-    if (order->dish_label && lv_obj_is_valid(order->dish_label)) {
-        // 清除所有子对象（菜品卡片）
-        lv_obj_clean(order->dish_label);
-        
-        // 重新解析菜品信息并创建卡片
-        cJSON *root = cJSON_Parse(dishes);
-        if (root) {
-            cJSON *items = cJSON_GetObjectItem(root, "items");
-            if (items && cJSON_IsArray(items)) {
-                int item_count = cJSON_GetArraySize(items);
-                ESP_LOGD(TAG, "更新菜品数量: %d", item_count);
-                
-                cJSON *item = NULL;
-                cJSON_ArrayForEach(item, items) {
-                    cJSON *name = cJSON_GetObjectItem(item, "name");
-                    if (name && cJSON_IsString(name)) {
-                        // 限制菜品名称长度
-                        if (strlen(name->valuestring) < 48) {
-                            create_dish_card(order->dish_label, name->valuestring);
-                        } else {
-                            ESP_LOGW(TAG, "菜品名称过长，已跳过: %s", name->valuestring);
-                        }
-                    }
-                }
-            } else {
-                ESP_LOGW(TAG, "更新JSON中没有找到items数组");
-            }
-            cJSON_Delete(root);
-        } else {
-            ESP_LOGE(TAG, "JSON解析失败: %s", dishes);
-        }
-    }
-    
+    order_ui_stats_t stats;
+    order_ui_get_stats(&stats);
+    uint32_t heap_used = lvgl_heap_used();
+    text_measure_stats_t measure;
+    text_measure_get_stats(&measure);
     bsp_display_unlock();
-}
\ No newline at end of file
+
+    // 不用缓存时每次命中都要重新测量，按未命中的平均测量耗时估算
+    uint32_t layout_us = stats.row_layouts ? stats.row_layout_us / stats.row_layouts : 0;
+    uint32_t miss_us = measure.misses ? measure.measure_us / measure.misses : 0;
+    uint32_t saved_us = stats.row_layouts ? (uint32_t)((uint64_t)measure.hits * miss_us / stats.row_layouts) : 0;
+
+    DLOGI(TAG, "菜品布局: %lu 次, 每行 %lu us (不缓存测量约 %lu us), 测量缓存 命中 %lu/未命中 %lu (每次测量 %lu us)",
+          stats.row_layouts, layout_us, layout_us + saved_us, measure.hits, measure.misses, miss_us);
+    DLOGI(TAG, "订单列表: 订单 %u, 订单行 %u (每行创建 %lu us, 行池LVGL堆 %lu 字节), 绑定 %lu, "
+          "菜品卡片 新建 %lu/复用 %lu/删除 %lu, 弹窗 显示 %lu/合并 %lu/丢弃 %lu, LVGL堆已用 %lu 字节",
+          stats.orders, stats.rows, stats.row_create_us, stats.pool_heap, stats.binds,
+          stats.cards_created, stats.cards_reused, stats.cards_deleted,
+          stats.popups_shown, stats.popups_coalesced, stats.popups_dropped, heap_used);
+}
@@ -2,52 +2,83 @@
 #define ORDER_UI_H
 
 #include "lvgl.h"
+#include <stdint.h>
+#include "order_model.h"
 
-// 初始化订单UI容器（优化版）
-void order_ui_init(lv_obj_t *parent);
+/**
+ * @brief 订单列表统计信息
+ */
+typedef struct {
+    uint16_t orders;         // 列表中的订单数
+    uint16_t rows;           // 行池中的订单行数（与订单数无关）
+    uint32_t row_create_us;  // 平均每行创建耗时
+    uint32_t pool_heap;      // 行池占用的LVGL堆（不含菜品卡片）
+    uint32_t binds;          // 订单行绑定到订单的次数
+    uint32_t cards_created;  // 新建的菜品卡片数
+    uint32_t cards_reused;   // 复用的菜品卡片数（原样保留、移动或改字）
+    uint32_t cards_deleted;  // 删除的菜品卡片数
+    uint32_t popups_shown;   // 弹窗显示的消息数
+    uint32_t popups_coalesced; // 合并到已有弹窗消息中的消息数
+    uint32_t popups_dropped; // 弹窗队列满丢弃的消息数
+    uint32_t row_layouts;    // 订单行菜品布局次数（绑定和更新）
+    uint32_t row_layout_us;  // 订单行菜品布局总耗时
+} order_ui_stats_t;
+
+/**
+ * @brief 初始化订单UI容器并订阅订单模型
+ *
+ * 订单列表为虚拟列表：只有可见区域内的订单绑定订单行，订单行从固定大小的行池中复用，
+ * 滚动时重新绑定。界面创建前已有的订单会加入列表。
+ *
+ * @param parent 父容器
+ * @param model 订单模型
+ */
+void order_ui_init(lv_obj_t *parent, order_model_t *model);
 
 // 清理订单UI资源
 void order_ui_cleanup(void);
 
-// 初始化菜品字体预渲染
-void init_dish_font_prerender(void);
-
-// 创建动态订单行
-void create_dynamic_order_row(int order_num, const char *dishes);
-
-// 创建带订单ID的动态订单行（优化版）
-void create_dynamic_order_row_with_id(const char *order_id, int order_num, const char *dishes);
+/**
+ * @brief 获取订单列表统计信息
+ */
+void order_ui_get_stats(order_ui_stats_t *stats);
 
 /**
- * @brief 显示弹出消息
- * 
- * @param message 要显示的消息内容
- * @param duration_ms 显示持续时间(毫秒)
+ * @brief 打印订单列表统计信息
  */
-void show_popup_message(const char *message, uint32_t duration_ms);
+void order_ui_log_stats(void);
 
 /**
- * @brief 根据订单ID删除订单（优化版）
- * 
- * @param order_id 订单ID字符串
+ * @brief 菜品字体已替换，更新菜品卡片的共享样式并重新取宽（调用时需持有显示锁）
  */
-void remove_order_by_id(const char *order_id);
+void order_ui_sync_dish_font(void);
+
+// 初始化菜品字体预渲染
+void init_dish_font_prerender(void);
+
+// 订单变更弹窗类型
+typedef enum {
+    ORDER_POPUP_ADDED,
+    ORDER_POPUP_UPDATED,
+    ORDER_POPUP_REMOVED,
+} order_popup_t;
 
 /**
- * @brief 根据订单ID更新订单（优化版）
+ * @brief 显示弹出消息
+ *
+ * 所有消息共用一个常驻弹窗：与正在显示或排队中的相同消息合并并延长显示时间，
+ * 其他消息排队依次显示。
  * 
- * @param order_id 订单ID字符串
- * @param order_num 订单号
- * @param dishes 菜品内容
+ * @param message 要显示的消息内容（会被复制，过长时截断）
+ * @param duration_ms 显示持续时间(毫秒)
  */
-void update_order_by_id(const char *order_id, int order_num, const char *dishes);
+void show_popup_message(const char *message, uint32_t duration_ms);
 
 /**
- * @brief 发送蓝牙通知
- * 
- * @param json_str JSON格式的字符串
- * @return int 成功返回0，失败返回-1
+ * @brief 显示订单变更弹窗，连续的订单变更合并为一条汇总（如“已添加 3 个订单”）
+ *
+ * @param event 订单变更类型
  */
-int send_notification(const char *json_str);
+void show_order_popup(order_popup_t event);
 
 #endif // ORDER_UI_H
\ No newline at end of file
@@ -0,0 +1,280 @@
+/**
+ * @file order_wire.c
+ * @brief 订单消息二进制格式解码实现
+ */
+
+#include "order_wire.h"
+#include <string.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "order_log.h"
+#include "json_tok.h"
+#include "utf8_validator.h"
+
+static const char *TAG = "OrderWire";
+
+bool order_wire_is_binary(const uint8_t *data, size_t len)
+{
+    return data && len >= 2 && data[0] == ORDER_WIRE_MAGIC_V1;
+}
+
+bool order_wire_decode(const uint8_t *data, size_t len, order_msg_t *out)
+{
+    if (!order_wire_is_binary(data, len) || !out) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->type = (order_msg_type_t)data[1];
+    if (out->type < ORDER_MSG_ADD || out->type > ORDER_MSG_INFO) {
+        return false;
+    }
+
+    size_t pos = 2;
+    while (pos < len) {
+        if (len - pos < 2) {
+            return false;
+        }
+        uint8_t tag = data[pos];
+        uint8_t field_len = data[pos + 1];
+        pos += 2;
+        if (field_len > len - pos) {
+            return false;
+        }
+
+        order_str_t value = { (const char *)data + pos, field_len };
+        // 字符串字段必须是合法UTF-8，否则字体会渲染出方块
+        if ((tag == ORDER_WIRE_TAG_ITEM || tag == ORDER_WIRE_TAG_CONTENT) &&
+            !utf8_is_valid(data + pos, field_len)) {
+            return false;
+        }
+        switch (tag) {
+        case ORDER_WIRE_TAG_ORDER_ID:
+            out->order_id = value;
+            break;
+        case ORDER_WIRE_TAG_ITEM:
+            if (out->item_count < ORDER_MSG_MAX_ITEMS) {
+                out->items[out->item_count++] = value;
+            }
+            out->item_total++;
+            break;
+        case ORDER_WIRE_TAG_CONTENT:
+            out->content = value;
+            break;
+        default:
+            // 未知字段，跳过
+            break;
+        }
+        pos += field_len;
+    }
+
+    if (out->type == ORDER_MSG_INFO) {
+        return true;
+    }
+    return out->order_id.len > 0;
+}
+
+// 解析消息类型字符串
+static order_msg_type_t json_msg_type(const char *js, const json_tok_t *tok)
+{
+    if (json_tok_eq(js, tok, "add")) return ORDER_MSG_ADD;
+    if (json_tok_eq(js, tok, "update")) return ORDER_MSG_UPDATE;
+    if (json_tok_eq(js, tok, "remove")) return ORDER_MSG_REMOVE;
+    if (json_tok_eq(js, tok, "info")) return ORDER_MSG_INFO;
+    return ORDER_MSG_UNKNOWN;
+}
+
+static order_str_t json_str(const char *js, const json_tok_t *tok)
+{
+    order_str_t str = { js + tok->start, (uint16_t)(tok->end - tok->start) };
+    return str;
+}
+
+// 收集items数组中每个对象的name字段
+static void json_collect_items(const char *js, const json_tok_t *toks, int count,
+                               int array_index, order_msg_t *out)
+{
+    int i = array_index + 1;
+    for (int n = 0; n < toks[array_index].size && i < count; n++) {
+        int item = i;
+        i = json_tok_skip(toks, count, item);
+        if (toks[item].type != JSON_TOK_OBJECT) {
+            continue;
+        }
+
+        int k = item + 1;
+        for (int field = 0; field < toks[item].size && k + 1 < count; field++) {
+            const json_tok_t *key = &toks[k];
+            const json_tok_t *value = &toks[k + 1];
+            if (value->type == JSON_TOK_STRING && json_tok_eq(js, key, "name")) {
+                if (out->item_count < ORDER_MSG_MAX_ITEMS) {
+                    out->items[out->item_count++] = json_str(js, value);
+                }
+                out->item_total++;
+            }
+            k = json_tok_skip(toks, count, k + 1);
+        }
+    }
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return c - 'A' + 10;
+}
+
+static uint32_t json_u16(const char *p)
+{
+    return (uint32_t)(hex_digit(p[0]) << 12 | hex_digit(p[1]) << 8 | hex_digit(p[2]) << 4 | hex_digit(p[3]));
+}
+
+// 码点编码为UTF-8，返回字节数（不超过4，\uXXXX转义至少占6个字符，结果不会变长）
+static int utf8_put(char *out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | cp >> 6);
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | cp >> 12);
+        out[1] = (char)(0x80 | (cp >> 6 & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | cp >> 18);
+    out[1] = (char)(0x80 | (cp >> 12 & 0x3F));
+    out[2] = (char)(0x80 | (cp >> 6 & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// 原地反转义字符串字段并更新长度；转义序列的合法性已由json_tok检查
+// 不成对的代理项替换为U+FFFD，保证结果仍是合法UTF-8
+static void json_unescape(order_str_t *str)
+{
+    char *s = (char *)str->ptr;
+    if (!s || !memchr(s, '\\', str->len)) {
+        return;
+    }
+
+    const char *in = s;
+    const char *end = s + str->len;
+    char *out = s;
+    while (in < end) {
+        if (*in != '\\') {
+            *out++ = *in++;
+            continue;
+        }
+        char c = in[1];
+        in += 2;
+        switch (c) {
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u': {
+            uint32_t cp = json_u16(in);
+            in += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF && end - in >= 6 && in[0] == '\\' && in[1] == 'u') {
+                uint32_t lo = json_u16(in + 2);
+                if (lo >= 0xDC00 && lo <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                    in += 6;
+                }
+            }
+            if (cp >= 0xD800 && cp <= 0xDFFF) {
+                cp = 0xFFFD;
+            }
+            out += utf8_put(out, cp);
+            break;
+        }
+        default:
+            // '"'、'\\'、'/'
+            *out++ = c;
+            break;
+        }
+    }
+    str->len = (uint16_t)(out - s);
+}
+
+static void json_terminate(char *json, order_str_t *str)
+{
+    if (!str->ptr) return;
+    json_unescape(str);
+    json[str->ptr - json + str->len] = '\0';
+}
+
+// 在给定的token数组上解码
+static bool json_decode_tokens(char *json, size_t len, json_tok_t *toks, size_t max_tokens, order_msg_t *out)
+{
+    json_tok_parser_t parser;
+    json_tok_init(&parser);
+    int count = json_tok_parse(&parser, json, len, toks, max_tokens);
+    if (count == JSON_TOK_ERR_NOMEM) {
+        DLOGW(TAG, "JSON token不足 (%u 个, %u 字节)", (unsigned)max_tokens, (unsigned)len);
+        return false;
+    }
+    if (count < 1 || toks[0].type != JSON_TOK_OBJECT) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->hex_encoded = true;
+
+    int i = 1;
+    for (int field = 0; field < toks[0].size && i + 1 < count; field++) {
+        const json_tok_t *key = &toks[i];
+        const json_tok_t *value = &toks[i + 1];
+
+        if (value->type == JSON_TOK_STRING) {
+            if (json_tok_eq(json, key, "type")) {
+                out->type = json_msg_type(json, value);
+            } else if (json_tok_eq(json, key, "orderId")) {
+                out->order_id = json_str(json, value);
+            } else if (json_tok_eq(json, key, "content")) {
+                out->content = json_str(json, value);
+            }
+        } else if (value->type == JSON_TOK_ARRAY && json_tok_eq(json, key, "items")) {
+            json_collect_items(json, toks, count, i + 1, out);
+        }
+        i = json_tok_skip(toks, count, i + 1);
+    }
+
+    if (out->type == ORDER_MSG_UNKNOWN ||
+        (out->type == ORDER_MSG_INFO ? out->content.ptr == NULL : out->order_id.len == 0)) {
+        return false;
+    }
+
+    // 反转义后在字段末尾写'\0'（不晚于原来的结束引号），字符串字段可直接作为C字符串使用
+    json_terminate(json, &out->order_id);
+    json_terminate(json, &out->content);
+    for (uint16_t n = 0; n < out->item_count; n++) {
+        json_terminate(json, &out->items[n]);
+    }
+    return true;
+}
+
+bool order_wire_decode_json(char *json, size_t len, order_msg_t *out)
+{
+    if (!json || !out) {
+        return false;
+    }
+
+    // token数组按最长的消息一次性分配在PSRAM上（最大帧长下超过100 KB），之后每条消息复用，不在栈上也不逐条分配
+    static json_tok_t *s_toks = NULL;
+    if (!s_toks) {
+        s_toks = heap_caps_malloc(ORDER_JSON_MAX_TOKENS * sizeof(json_tok_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_toks) {
+            DLOGE(TAG, "JSON token数组分配失败 (%u 个)", (unsigned)ORDER_JSON_MAX_TOKENS);
+            return false;
+        }
+    }
+    return json_decode_tokens(json, len, s_toks, ORDER_JSON_MAX_TOKENS, out);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file order_wire.h
+ * @brief 订单消息的紧凑二进制格式
+ *
+ * 二进制消息（版本1）格式：
+ *   [0] 0xB1 魔数/版本号
+ *   [1] 消息类型（order_msg_type_t）
+ *   之后为若干TLV字段：[tag][len][value...]，len为1字节
+ *     0x01 订单ID
+ *     0x02 菜品名（原始UTF-8，可重复）
+ *     0x03 系统消息内容（原始UTF-8）
+ *   未知tag直接跳过，便于后续扩展。
+ * 解码结果直接引用输入缓冲区，不分配内存。
+ *
+ * JSON消息通过json_tok原地切分后解码为同样的order_msg_t，
+ * 其中菜品名和系统消息内容为十六进制编码（hex_encoded为true）。
+ */
+
+#ifndef ORDER_WIRE_H
+#define ORDER_WIRE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+#define ORDER_WIRE_MAGIC_V1     0xB1
+#define ORDER_WIRE_VERSION      1
+
+#define ORDER_WIRE_TAG_ORDER_ID 0x01
+#define ORDER_WIRE_TAG_ITEM     0x02
+#define ORDER_WIRE_TAG_CONTENT  0x03
+
+// 单条消息最多携带的菜品数
+#define ORDER_MSG_MAX_ITEMS     32
+
+// 消息类型
+typedef enum {
+    ORDER_MSG_UNKNOWN = 0,
+    ORDER_MSG_ADD     = 1,
+    ORDER_MSG_UPDATE  = 2,
+    ORDER_MSG_REMOVE  = 3,
+    ORDER_MSG_INFO    = 4,
+} order_msg_type_t;
+
+// 指向接收缓冲区的字符串片段（不以'\0'结尾）
+typedef struct {
+    const char *ptr;
+    uint16_t len;
+} order_str_t;
+
+// JSON解码时可用的最大token数：最长的消息每两个字符一个token
+#define ORDER_JSON_MAX_TOKENS   (CONFIG_ORDER_FRAME_MAX_LEN / 2 + 2)
+
+// 解码后的订单消息
+typedef struct {
+    order_msg_type_t type;
+    uint16_t conn_handle;    // 消息来自的连接，解码后由调用者填写（拒绝通知只发给这个连接）
+    bool hex_encoded;        // 菜品名和内容是否可能为十六进制编码
+    order_str_t order_id;
+    order_str_t content;
+    uint16_t item_count;
+    uint16_t item_total;     // 报文中的菜品总数，大于ORDER_MSG_MAX_ITEMS时items只保存前面的，由调用者拒绝
+    order_str_t items[ORDER_MSG_MAX_ITEMS];
+} order_msg_t;
+
+/**
+ * @brief 判断消息是否为二进制格式
+ *
+ * @param data 消息数据
+ * @param len 数据长度
+ * @return true 是二进制格式
+ */
+bool order_wire_is_binary(const uint8_t *data, size_t len);
+
+/**
+ * @brief 原地解码二进制订单消息
+ *
+ * @param data 消息数据
+ * @param len 数据长度
+ * @param out 输出消息，字符串字段指向data；菜品数超限时item_total大于item_count
+ * @return true 解码成功
+ * @return false 格式错误（包括字符串字段不是合法UTF-8）
+ */
+bool order_wire_decode(const uint8_t *data, size_t len, order_msg_t *out);
+
+/**
+ * @brief 原地解码JSON订单消息
+ *
+ * 解码成功时会原地反转义用到的字符串字段（\"、\\、\uXXXX等，\uXXXX编码为UTF-8），
+ * 并在字段末尾写入'\0'，因此字符串字段同时也是以'\0'结尾的C字符串；失败时不修改输入。
+ * token数组在第一次调用时按最长的消息分配并一直复用，因此不可重入，只在接入工作任务中调用；
+ * 分配失败时记录日志并返回false。
+ *
+ * @param json JSON文本（可写）
+ * @param len 文本长度
+ * @param out 输出消息，字符串字段指向json；菜品数超限时item_total大于item_count
+ * @return true 解码成功
+ * @return false 格式错误或缺少必要字段
+ */
+bool order_wire_decode_json(char *json, size_t len, order_msg_t *out);
+
+#endif // ORDER_WIRE_H
@@ -0,0 +1,81 @@
+/**
+ * @file text_measure.c
+ * @brief 菜品名文字测量缓存实现
+ */
+
+#include "text_measure.h"
+#include <string.h>
+#include "esp_timer.h"
+
+#define MEASURE_SLOTS   256          // 2的幂
+
+typedef struct {
+    const lv_font_t *font;
+    const lv_font_t *fallback;
+    uint32_t hash;
+    dish_id_t id;
+    uint16_t len;
+    int32_t max_width;
+    text_metrics_t metrics;
+} measure_slot_t;
+
+static measure_slot_t s_slots[MEASURE_SLOTS];
+static text_measure_stats_t s_stats;
+
+static inline uint32_t slot_of(dish_id_t id, const lv_font_t *font, int32_t max_width)
+{
+    uint32_t h = id * 2654435761u ^ (uint32_t)(uintptr_t)font ^ (uint32_t)max_width * 40503u;
+    return (h ^ (h >> 16)) & (MEASURE_SLOTS - 1);
+}
+
+bool text_measure_dish(dish_id_t id, const lv_font_t *font, int32_t max_width, text_metrics_t *out)
+{
+    uint16_t len = dish_intern_len(id);
+    if (!font || len == 0) {
+        return false;
+    }
+
+    uint32_t hash = dish_intern_hash(id);
+    measure_slot_t *slot = &s_slots[slot_of(id, font, max_width)];
+    if (slot->font == font && slot->fallback == font->fallback && slot->id == id &&
+        slot->hash == hash && slot->len == len && slot->max_width == max_width) {
+        s_stats.hits++;
+        *out = slot->metrics;
+        return true;
+    }
+
+    int64_t start = esp_timer_get_time();
+    const char *text = dish_intern_str(id);
+    lv_point_t line;
+    lv_point_t wrapped;
+    lv_text_get_size(&line, text, font, 0, 0, LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    if (line.x <= max_width) {
+        wrapped = line;
+    } else {
+        lv_text_get_size(&wrapped, text, font, 0, 0, max_width, LV_TEXT_FLAG_NONE);
+    }
+    int32_t line_height = lv_font_get_line_height(font);
+
+    slot->font = font;
+    slot->fallback = font->fallback;
+    slot->hash = hash;
+    slot->id = id;
+    slot->len = len;
+    slot->max_width = max_width;
+    slot->metrics.width = (uint16_t)line.x;
+    slot->metrics.wrap_width = (uint16_t)wrapped.x;
+    slot->metrics.height = (uint16_t)wrapped.y;
+    slot->metrics.lines = (uint8_t)(line_height > 0 ? (wrapped.y + line_height - 1) / line_height : 1);
+    s_stats.misses++;
+    s_stats.measure_us += (uint32_t)(esp_timer_get_time() - start);
+
+    *out = slot->metrics;
+    return true;
+}
+
+void text_measure_get_stats(text_measure_stats_t *stats)
+{
+    if (stats) {
+        *stats = s_stats;
+    }
+}
@@ -0,0 +1,55 @@
+/**
+ * @file text_measure.h
+ * @brief 菜品名文字测量缓存
+ *
+ * 同一个菜品名反复出现在不同订单中，每次创建或改字都要逐字查字宽、扫描换行。
+ * 这里按（驻留的菜品名, 字体, 换行宽度）缓存测量结果：
+ *   - 直接映射的固定大小表，冲突时覆盖旧结果；
+ *   - 键中包含菜品名哈希和字体的fallback，句柄复用或后备字体挂上后自动失效；
+ *   - 不加锁，与菜品卡片一样在持有显示锁时使用。
+ */
+
+#ifndef TEXT_MEASURE_H
+#define TEXT_MEASURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lvgl.h"
+#include "dish_intern.h"
+
+/**
+ * @brief 测量结果
+ */
+typedef struct {
+    uint16_t width;          // 不换行时的宽度
+    uint16_t wrap_width;     // 按max_width换行后最宽一行的宽度
+    uint16_t height;         // 换行后的高度
+    uint8_t lines;           // 换行后的行数
+} text_metrics_t;
+
+/**
+ * @brief 测量统计
+ */
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t measure_us;     // 未命中时实际测量的总耗时
+} text_measure_stats_t;
+
+/**
+ * @brief 测量菜品名（命中缓存时不访问字体）
+ *
+ * @param id 菜品名句柄
+ * @param font 字体
+ * @param max_width 换行宽度
+ * @param out 测量结果
+ * @return false 句柄无效
+ */
+bool text_measure_dish(dish_id_t id, const lv_font_t *font, int32_t max_width, text_metrics_t *out);
+
+/**
+ * @brief 获取统计信息
+ */
+void text_measure_get_stats(text_measure_stats_t *stats);
+
+#endif // TEXT_MEASURE_H
@@ -0,0 +1,430 @@
+/**
+ * @file ttf_fallback.c
+ * @brief 菜品字体的TTF后备字体实现
+ */
+
+#include "ttf_fallback.h"
+#include <stdbool.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "bsp/display.h"
+#include "bsp/esp-bsp.h"
+#include "order_log.h"
+
+static const char *TAG = "TtfFallback";
+
+#define CACHE_BUCKETS       64           // 2的幂
+#define RASTER_QUEUE_LEN    32
+#define RASTER_TASK_STACK   8192         // stb_truetype光栅化需要较大的栈
+#define RASTER_TASK_PRIO    1
+#define TTF_CACHE_ENTRIES   4            // Tiny TTF自身的位图缓存，光栅化后立即拷出，保持很小
+
+// 光栅化的字形：条目头后紧跟A8位图
+typedef struct ttf_entry {
+    uint32_t letter;
+    uint16_t refs;                       // 正在绘制的次数，非0时不淘汰
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    struct ttf_entry *hnext;
+    struct ttf_entry *prev;              // LRU链表，头部最久未使用
+    struct ttf_entry *next;
+    uint32_t size;
+    lv_draw_buf_t buf;
+} ttf_entry_t;
+
+static lv_font_t *s_ttf;                 // Tiny TTF字体，只在持有s_ttf_lock时访问（光栅化任务）
+static lv_font_t *s_metrics;             // 同一TTF的第二个实例，只查询度量，只在持有s_metrics_lock时访问（绘制路径）
+static lv_font_t s_font;
+static SemaphoreHandle_t s_ttf_lock;
+static SemaphoreHandle_t s_metrics_lock;
+static SemaphoreHandle_t s_lock;         // 缓存、待光栅化列表和统计
+static QueueHandle_t s_queue;
+static ttf_entry_t *s_buckets[CACHE_BUCKETS];
+static ttf_entry_t *s_lru_head;
+static ttf_entry_t *s_lru_tail;
+static uint32_t s_pending[RASTER_QUEUE_LEN];
+static uint32_t s_recent_pos;
+static ttf_fallback_stats_t s_stats;
+
+static inline uint32_t bucket_of(uint32_t letter)
+{
+    return (letter * 2654435761u) >> 26 & (CACHE_BUCKETS - 1);
+}
+
+static ttf_entry_t *cache_find(uint32_t letter)
+{
+    for (ttf_entry_t *e = s_buckets[bucket_of(letter)]; e; e = e->hnext) {
+        if (e->letter == letter) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void lru_unlink(ttf_entry_t *e)
+{
+    if (e->prev) e->prev->next = e->next; else s_lru_head = e->next;
+    if (e->next) e->next->prev = e->prev; else s_lru_tail = e->prev;
+    e->prev = e->next = NULL;
+}
+
+static void lru_append(ttf_entry_t *e)
+{
+    e->prev = s_lru_tail;
+    e->next = NULL;
+    if (s_lru_tail) s_lru_tail->next = e; else s_lru_head = e;
+    s_lru_tail = e;
+}
+
+static void cache_remove(ttf_entry_t *e)
+{
+    ttf_entry_t **pp = &s_buckets[bucket_of(e->letter)];
+    while (*pp != e) {
+        pp = &(*pp)->hnext;
+    }
+    *pp = e->hnext;
+    lru_unlink(e);
+    s_stats.glyphs--;
+    s_stats.bytes -= e->size;
+    heap_caps_free(e);
+}
+
+static bool cache_make_room(uint32_t size)
+{
+    ttf_entry_t *e = s_lru_head;
+    while (s_stats.bytes + size > s_stats.budget && e) {
+        ttf_entry_t *next = e->next;
+        if (e->refs == 0) {
+            cache_remove(e);
+            s_stats.evictions++;
+        }
+        e = next;
+    }
+    return s_stats.bytes + size <= s_stats.budget;
+}
+
+static bool pending_has(uint32_t letter)
+{
+    for (int i = 0; i < RASTER_QUEUE_LEN; i++) {
+        if (s_pending[i] == letter) return true;
+    }
+    return false;
+}
+
+static void pending_set(uint32_t from, uint32_t to)
+{
+    for (int i = 0; i < RASTER_QUEUE_LEN; i++) {
+        if (s_pending[i] == from) {
+            s_pending[i] = to;
+            return;
+        }
+    }
+}
+
+static void recent_add(uint32_t letter)
+{
+    for (int i = 0; i < TTF_FALLBACK_RECENT_MAX; i++) {
+        if (s_stats.recent[i] == letter) return;
+    }
+    s_stats.recent[s_recent_pos] = letter;
+    s_recent_pos = (s_recent_pos + 1) % TTF_FALLBACK_RECENT_MAX;
+}
+
+// 把缺字放入光栅化队列（已在缓存或队列中时不重复放入），需持有s_lock
+static void raster_request(uint32_t letter)
+{
+    if (pending_has(letter)) return;
+    if (!pending_has(0) || xQueueSend(s_queue, &letter, 0) != pdTRUE) {
+        s_stats.dropped++;
+        return;
+    }
+    pending_set(0, letter);
+    recent_add(letter);
+}
+
+static bool fallback_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc, uint32_t letter, uint32_t letter_next)
+{
+    // 已光栅化的字形直接用缓存的度量；未光栅化的从只查度量的实例获取，都不等待正在光栅化的后台任务
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    s_stats.misses++;
+    ttf_entry_t *e = cache_find(letter);
+    if (e) {
+        dsc->adv_w = e->adv_w;
+        dsc->box_w = e->box_w;
+        dsc->box_h = e->box_h;
+        dsc->ofs_x = e->ofs_x;
+        dsc->ofs_y = e->ofs_y;
+        xSemaphoreGive(s_lock);
+    } else {
+        xSemaphoreGive(s_lock);
+
+        xSemaphoreTake(s_metrics_lock, portMAX_DELAY);
+        bool found = s_metrics->get_glyph_dsc(s_metrics, dsc, letter, 0);
+        xSemaphoreGive(s_metrics_lock);
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        if (!found) {
+            s_stats.not_found++;
+            xSemaphoreGive(s_lock);
+            return false;
+        }
+        if (dsc->box_w && dsc->box_h) {
+            raster_request(letter);
+        }
+        xSemaphoreGive(s_lock);
+    }
+
+    // 位图按Unicode在缓存中查找
+    dsc->format = LV_FONT_GLYPH_FORMAT_A8;
+    dsc->is_placeholder = false;
+    dsc->gid.index = letter;
+    dsc->entry = NULL;
+    return true;
+}
+
+static const void *fallback_get_glyph_bitmap(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf)
+{
+    const void *bitmap = NULL;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    ttf_entry_t *e = cache_find(g_dsc->gid.index);
+    if (e) {
+        s_stats.hits++;
+        lru_unlink(e);
+        lru_append(e);
+        e->refs++;
+        g_dsc->entry = (lv_cache_entry_t *)e;
+        bitmap = &e->buf;
+    } else {
+        // 尚未光栅化（或已被淘汰），本次留空，光栅化完成后刷新
+        s_stats.pending++;
+        raster_request(g_dsc->gid.index);
+    }
+    xSemaphoreGive(s_lock);
+    return bitmap;
+}
+
+static void fallback_release_glyph(const lv_font_t *font, lv_font_glyph_dsc_t *g_dsc)
+{
+    ttf_entry_t *e = (ttf_entry_t *)g_dsc->entry;
+    if (!e) return;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (e->refs) e->refs--;
+    xSemaphoreGive(s_lock);
+    g_dsc->entry = NULL;
+}
+
+// 光栅化一个字符并放入缓存，返回是否新增了字形
+static bool raster_letter(uint32_t letter)
+{
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool cached = cache_find(letter) != NULL;
+    xSemaphoreGive(s_lock);
+    if (cached) return false;
+
+    bool added = false;
+    lv_font_glyph_dsc_t g;
+    memset(&g, 0, sizeof(g));
+
+    xSemaphoreTake(s_ttf_lock, portMAX_DELAY);
+    int64_t start = esp_timer_get_time();
+    if (!s_ttf->get_glyph_dsc(s_ttf, &g, letter, 0) || g.box_w == 0 || g.box_h == 0) {
+        xSemaphoreGive(s_ttf_lock);
+        return false;
+    }
+    g.resolved_font = s_ttf;
+    const lv_draw_buf_t *src = s_ttf->get_glyph_bitmap(&g, NULL);
+    uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start);
+
+    if (src) {
+        uint32_t stride = lv_draw_buf_width_to_stride(g.box_w, LV_COLOR_FORMAT_A8);
+        uint32_t data_size = stride * g.box_h;
+        uint32_t size = sizeof(ttf_entry_t) + data_size;
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        s_stats.rasterized++;
+        s_stats.raster_us_total += elapsed;
+        if (elapsed > s_stats.raster_us_max) s_stats.raster_us_max = elapsed;
+
+        ttf_entry_t *e = NULL;
+        if (cache_make_room(size)) {
+            e = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+        if (e) {
+            memset(e, 0, sizeof(*e));
+            lv_draw_buf_init(&e->buf, g.box_w, g.box_h, LV_COLOR_FORMAT_A8, stride, e + 1, data_size);
+            for (uint32_t y = 0; y < g.box_h; y++) {
+                memcpy(e->buf.data + y * stride, src->data + y * src->header.stride, g.box_w);
+            }
+            e->letter = letter;
+            e->adv_w = g.adv_w;
+            e->box_w = g.box_w;
+            e->box_h = g.box_h;
+            e->ofs_x = g.ofs_x;
+            e->ofs_y = g.ofs_y;
+            e->size = size;
+            uint32_t b = bucket_of(letter);
+            e->hnext = s_buckets[b];
+            s_buckets[b] = e;
+            lru_append(e);
+            s_stats.glyphs++;
+            s_stats.bytes += size;
+            added = true;
+        }
+        xSemaphoreGive(s_lock);
+    }
+    if (s_ttf->release_glyph) {
+        s_ttf->release_glyph(s_ttf, &g);
+    }
+    xSemaphoreGive(s_ttf_lock);
+    return added;
+}
+
+static void raster_task(void *arg)
+{
+    bool dirty = false;
+    for (;;) {
+        uint32_t letter;
+        // 队列清空后再统一刷新屏幕，连续的缺字只重绘一次
+        if (xQueueReceive(s_queue, &letter, dirty ? 0 : portMAX_DELAY) != pdTRUE) {
+            bsp_display_lock(portMAX_DELAY);
+            lv_obj_invalidate(lv_screen_active());
+            bsp_display_unlock();
+            dirty = false;
+            continue;
+        }
+
+        if (raster_letter(letter)) {
+            dirty = true;
+        }
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        pending_set(letter, 0);
+        xSemaphoreGive(s_lock);
+    }
+}
+
+lv_font_t *ttf_fallback_create(const void *data, size_t size, int32_t font_size)
+{
+#if !CONFIG_ORDER_TTF_FALLBACK || !LV_USE_TINY_TTF
+    return NULL;
+#else
+    if (!data || size == 0 || s_ttf) {
+        return NULL;
+    }
+
+    // 两个实例共用TTF数据，各自只有很小的缓存
+    s_ttf = lv_tiny_ttf_create_data_ex(data, size, font_size, LV_FONT_KERNING_NONE, TTF_CACHE_ENTRIES);
+    s_metrics = s_ttf ? lv_tiny_ttf_create_data_ex(data, size, font_size, LV_FONT_KERNING_NONE, TTF_CACHE_ENTRIES)
+                      : NULL;
+    if (!s_metrics) {
+        DLOGE(TAG, "解析TTF失败");
+        if (s_ttf) lv_tiny_ttf_destroy(s_ttf);
+        s_ttf = NULL;
+        return NULL;
+    }
+
+    s_lock = xSemaphoreCreateMutex();
+    s_ttf_lock = xSemaphoreCreateMutex();
+    s_metrics_lock = xSemaphoreCreateMutex();
+    s_queue = xQueueCreate(RASTER_QUEUE_LEN, sizeof(uint32_t));
+    if (!s_lock || !s_ttf_lock || !s_metrics_lock || !s_queue ||
+        xTaskCreate(raster_task, "ttf_raster", RASTER_TASK_STACK, NULL, RASTER_TASK_PRIO, NULL) != pdPASS) {
+        DLOGE(TAG, "创建后备字体失败");
+        if (s_queue) vQueueDelete(s_queue);
+        if (s_metrics_lock) vSemaphoreDelete(s_metrics_lock);
+        if (s_ttf_lock) vSemaphoreDelete(s_ttf_lock);
+        if (s_lock) vSemaphoreDelete(s_lock);
+        s_queue = NULL;
+        s_metrics_lock = NULL;
+        s_ttf_lock = NULL;
+        s_lock = NULL;
+        lv_tiny_ttf_destroy(s_metrics);
+        lv_tiny_ttf_destroy(s_ttf);
+        s_metrics = NULL;
+        s_ttf = NULL;
+        return NULL;
+    }
+
+    s_font.get_glyph_dsc = fallback_get_glyph_dsc;
+    s_font.get_glyph_bitmap = fallback_get_glyph_bitmap;
+    s_font.release_glyph = fallback_release_glyph;
+    s_font.line_height = s_ttf->line_height;
+    s_font.base_line = s_ttf->base_line;
+    s_font.kerning = LV_FONT_KERNING_NONE;
+    s_stats.budget = (uint32_t)CONFIG_ORDER_TTF_FALLBACK_CACHE_KB * 1024;
+
+    DLOGI(TAG, "TTF后备字体已启用: %d px, 预算 %lu KB", (int)font_size, s_stats.budget / 1024);
+    return &s_font;
+#endif
+}
+
+static size_t utf8_encode(uint32_t cp, char *out)
+{
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+void ttf_fallback_get_stats(ttf_fallback_stats_t *stats)
+{
+    if (!stats) return;
+    if (!s_lock) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    *stats = s_stats;
+    xSemaphoreGive(s_lock);
+}
+
+void ttf_fallback_log_stats(void)
+{
+    if (!s_lock) return;
+
+    ttf_fallback_stats_t stats;
+    ttf_fallback_get_stats(&stats);
+    uint32_t avg_us = stats.rasterized ? (uint32_t)(stats.raster_us_total / stats.rasterized) : 0;
+    DLOGI(TAG, "后备字体: 缺字查找 %lu, TTF也没有 %lu, 命中 %lu, 留空 %lu, 光栅化 %lu (平均 %lu us, 最长 %lu us), "
+          "丢弃 %lu, 淘汰 %lu, 字形 %lu, 占用 %lu/%lu 字节",
+          stats.misses, stats.not_found, stats.hits, stats.pending, stats.rasterized, avg_us,
+          stats.raster_us_max, stats.dropped, stats.evictions, stats.glyphs, stats.bytes, stats.budget);
+
+    // 最近缺少的字符，出现较多时应重新生成菜品字体子集
+    char recent[TTF_FALLBACK_RECENT_MAX * 4 + 1];
+    size_t len = 0;
+    for (int i = 0; i < TTF_FALLBACK_RECENT_MAX; i++) {
+        uint32_t cp = stats.recent[i];
+        if (cp == 0) continue;
+        len += utf8_encode(cp, recent + len);
+    }
+    if (len) {
+        recent[len] = '\0';
+        DLOGI(TAG, "最近缺少的字符: %s", recent);
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file ttf_fallback.h
+ * @brief 菜品字体的TTF后备字体（Tiny TTF，后台光栅化）
+ *
+ * 菜品的位图字体只包含菜单中出现过的字符，新菜品中的生僻字会显示为空白方框。
+ * 这里用font分区中的TTF（直接读取映射的数据）创建一个后备字体，挂到菜品字体的fallback上：
+ *   - 位图字体中没有的字符由LVGL转到后备字体查找；
+ *   - 字形度量由单独的TTF实例同步获取（不等待光栅化），位图在后台任务中光栅化，完成前该字符暂时留空，完成后刷新屏幕；
+ *   - 光栅化结果保存在PSRAM中，总量受预算限制，超出时淘汰最久未使用且未在绘制中的字形。
+ * 统计中的缺字数和最近缺少的字符用于判断何时需要重新生成位图字体子集。
+ */
+
+#ifndef TTF_FALLBACK_H
+#define TTF_FALLBACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "lvgl.h"
+
+#define TTF_FALLBACK_RECENT_MAX  16  // 统计中保留的最近缺少的字符数
+
+/**
+ * @brief 后备字体统计信息
+ */
+typedef struct {
+    uint32_t misses;         // 位图字体缺字、转到后备字体的查找次数
+    uint32_t not_found;      // TTF中也没有的字符查找次数
+    uint32_t hits;           // 绘制时已光栅化
+    uint32_t pending;        // 绘制时尚未光栅化（本次留空）
+    uint32_t rasterized;     // 光栅化的字形数（淘汰后再次光栅化会重复计数）
+    uint32_t raster_us_max;  // 单个字形最长光栅化耗时
+    uint64_t raster_us_total;// 光栅化总耗时
+    uint32_t dropped;        // 光栅化队列满丢弃的次数
+    uint32_t evictions;      // 淘汰的字形数
+    uint32_t glyphs;         // 当前缓存的字形数
+    uint32_t bytes;          // 当前缓存占用
+    uint32_t budget;         // 缓存预算
+    uint32_t recent[TTF_FALLBACK_RECENT_MAX]; // 最近缺少的字符（Unicode），0表示空
+} ttf_fallback_stats_t;
+
+/**
+ * @brief 由TTF数据创建后备字体并启动光栅化任务（只能调用一次）
+ *
+ * @param data TTF数据，需在字体存在期间保持有效（通常为映射的分区数据）
+ * @param size 数据大小
+ * @param font_size 字号（像素）
+ * @return lv_font_t* 后备字体，失败返回NULL
+ */
+lv_font_t *ttf_fallback_create(const void *data, size_t size, int32_t font_size);
+
+/**
+ * @brief 获取统计信息
+ */
+void ttf_fallback_get_stats(ttf_fallback_stats_t *stats);
+
+/**
+ * @brief 打印统计信息
+ */
+void ttf_fallback_log_stats(void);
+
+#endif // TTF_FALLBACK_H
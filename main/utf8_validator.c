@@ -1,63 +1,133 @@
 /**
  * @file utf8_validator.c
  * @brief UTF-8编码验证工具实现
+ *
+ * 多字节序列使用Björn Höhrmann的DFA：先按字节查字符类别，再按(状态, 类别)查下一状态。
+ * 状态值预乘12，直接作为转移表的行偏移。
  */
 
 #include "utf8_validator.h"
-#include "esp_log.h"
+#include <string.h>
+#include "hex_utils.h"
 
-static const char *TAG = "UTF8_VALIDATOR";
+// 与hex_decode配合时每次解码的字符数，解码结果在缓存中热时立即校验
+#define UTF8_HEX_CHUNK 64
 
-/**
- * @brief 验证字符串是否为有效的UTF-8编码
- * 
- * UTF-8编码规则：
- * - 单字节字符: 0xxxxxxx (ASCII范围: 0x00-0x7F)
- * - 双字节字符: 110xxxxx 10xxxxxx (范围: 0xC0-0xDF 0x80-0xBF)
- * - 三字节字符: 1110xxxx 10xxxxxx 10xxxxxx (范围: 0xE0-0xEF 0x80-0xBF 0x80-0xBF)
- * - 四字节字符: 11110xxx 10xxxxxx 10xxxxxx 10xxxxxx (范围: 0xF0-0xF7 0x80-0xBF 0x80-0xBF 0x80-0xBF)
- * 
- * @param data 要验证的数据
- * @param length 数据长度
- * @return true 如果是有效的UTF-8编码
- * @return false 如果不是有效的UTF-8编码
- */
-bool utf8_is_valid(const uint8_t *data, size_t length) {
-    bool is_valid_utf8 = true;
-    
-    for (size_t i = 0; i < length; i++) {
-        uint8_t c = data[i];
-        if (c > 0x7F) { // 非ASCII字符
-            // 检查UTF-8编码有效性
-            if ((c & 0xE0) == 0xC0) { // 2字节UTF-8
-                if (i + 1 >= length || (data[i+1] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
-                    break;
-                }
-                i++; // 跳过下一个字节
-            } else if ((c & 0xF0) == 0xE0) { // 3字节UTF-8
-                if (i + 2 >= length || 
-                    (data[i+1] & 0xC0) != 0x80 ||
-                    (data[i+2] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
-                    break;
-                }
-                i += 2; // 跳过两个字节
-            } else if ((c & 0xF8) == 0xF0) { // 4字节UTF-8
-                if (i + 3 >= length || 
-                    (data[i+1] & 0xC0) != 0x80 ||
-                    (data[i+2] & 0xC0) != 0x80 ||
-                    (data[i+3] & 0xC0) != 0x80) {
-                    is_valid_utf8 = false;
+static const uint8_t s_utf8_dfa[256 + 108] = {
+    // 字符类别：0x00-0x7F
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+    // 0x80-0xBF：续字节，按可跟随的首字节范围分为三类
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1, 9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+    7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7, 7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+    // 0xC0-0xDF：C0/C1只能构成超长编码
+    8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2, 2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+    // 0xE0-0xEF：E0需排除超长编码，ED需排除代理区
+    10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3,
+    // 0xF0-0xFF：F0需排除超长编码，F4需限制在U+10FFFF以内
+    11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
+
+    // 状态转移表
+     0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+    12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+    12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+    12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+    12,36,12,12,12,12,12,12,12,12,12,12,
+};
+
+static inline utf8_state_t utf8_step(utf8_state_t state, uint8_t byte)
+{
+    return s_utf8_dfa[256 + state + s_utf8_dfa[byte]];
+}
+
+utf8_state_t utf8_validate_chunk(utf8_state_t state, const uint8_t *data, size_t length)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+
+    while (p < end) {
+        // 位于字符边界时按字（4字节）跳过纯ASCII段
+        if (state == UTF8_ACCEPT) {
+            while (p < end && ((uintptr_t)p & 3) != 0 && *p < 0x80) {
+                p++;
+            }
+            while (end - p >= 4) {
+                uint32_t word;
+                memcpy(&word, p, sizeof(word));
+                if (word & 0x80808080u) {
                     break;
                 }
-                i += 3; // 跳过三个字节
-            } else {
-                is_valid_utf8 = false;
+                p += 4;
+            }
+            while (p < end && *p < 0x80) {
+                p++;
+            }
+            if (p == end) {
                 break;
             }
         }
+
+        state = utf8_step(state, *p++);
+        if (state == UTF8_REJECT) {
+            break;
+        }
     }
-    
-    return is_valid_utf8;
-}
\ No newline at end of file
+
+    return state;
+}
+
+bool utf8_is_valid(const uint8_t *data, size_t length)
+{
+    return utf8_validate_chunk(UTF8_ACCEPT, data, length) == UTF8_ACCEPT;
+}
+
+int utf8_hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size)
+{
+    if (hex_len % 2 != 0) {
+        return HEX_ERR_ODD_LENGTH;
+    }
+    if (out_size < hex_len / 2) {
+        return HEX_ERR_NO_SPACE;
+    }
+
+    // 原地解码时先逐块解码到栈上校验，全部通过后直接解码写出（不再重复校验），失败不改写输入
+    uintptr_t in_addr = (uintptr_t)hex;
+    uintptr_t out_addr = (uintptr_t)out;
+    if (out_addr < in_addr + hex_len && in_addr < out_addr + hex_len / 2) {
+        uint8_t scratch[UTF8_HEX_CHUNK / 2];
+        utf8_state_t state = UTF8_ACCEPT;
+        for (size_t i = 0; i < hex_len; i += UTF8_HEX_CHUNK) {
+            size_t chunk = hex_len - i < UTF8_HEX_CHUNK ? hex_len - i : UTF8_HEX_CHUNK;
+            int decoded = hex_decode(hex + i, chunk, scratch, sizeof(scratch));
+            if (decoded < 0) {
+                return decoded;
+            }
+            state = utf8_validate_chunk(state, scratch, decoded);
+            if (state == UTF8_REJECT) {
+                return UTF8_ERR_INVALID;
+            }
+        }
+        if (state != UTF8_ACCEPT) {
+            return UTF8_ERR_INVALID;
+        }
+        hex_decode_unchecked(hex, hex_len, out);
+        return (int)(hex_len / 2);
+    }
+
+    utf8_state_t state = UTF8_ACCEPT;
+    for (size_t i = 0; i < hex_len; i += UTF8_HEX_CHUNK) {
+        size_t chunk = hex_len - i < UTF8_HEX_CHUNK ? hex_len - i : UTF8_HEX_CHUNK;
+        int decoded = hex_decode(hex + i, chunk, out + i / 2, chunk / 2);
+        if (decoded < 0) {
+            return decoded;
+        }
+        state = utf8_validate_chunk(state, out + i / 2, decoded);
+        if (state == UTF8_REJECT) {
+            return UTF8_ERR_INVALID;
+        }
+    }
+
+    return state == UTF8_ACCEPT ? (int)(hex_len / 2) : UTF8_ERR_INVALID;
+}
@@ -1,6 +1,9 @@
 /**
  * @file utf8_validator.h
  * @brief UTF-8编码验证工具
+ *
+ * 基于DFA的严格校验：拒绝超长编码、代理区（U+D800~U+DFFF）和超过U+10FFFF的码点。
+ * 校验状态可跨分片保存，用于分片到达的BLE数据增量校验。
  */
 
 #ifndef UTF8_VALIDATOR_H
@@ -10,6 +13,15 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 校验状态
+typedef uint8_t utf8_state_t;
+
+#define UTF8_ACCEPT        0   // 位于完整字符边界
+#define UTF8_REJECT        12  // 已出现非法序列（之后保持不变）
+
+// utf8_hex_decode错误码（与HEX_ERR_*共用编号空间）
+#define UTF8_ERR_INVALID   (-4)
+
 /**
  * @brief 验证字符串是否为有效的UTF-8编码
  * 
@@ -20,4 +32,31 @@
  */
 bool utf8_is_valid(const uint8_t *data, size_t length);
 
-#endif /* UTF8_VALIDATOR_H */
\ No newline at end of file
+/**
+ * @brief 增量校验一段数据
+ *
+ * 首段传入UTF8_ACCEPT，之后传入上一段的返回值。
+ * 全部数据结束时返回UTF8_ACCEPT才表示有效；中间状态表示字符被截断在分段处。
+ *
+ * @param state 上一段结束时的状态
+ * @param data 数据
+ * @param length 数据长度
+ * @return utf8_state_t 本段结束时的状态，UTF8_REJECT表示已发现非法序列
+ */
+utf8_state_t utf8_validate_chunk(utf8_state_t state, const uint8_t *data, size_t length);
+
+/**
+ * @brief 十六进制解码并校验结果为有效UTF-8
+ *
+ * 输出不追加'\0'。允许原地解码（out == hex）：此时先在栈上逐块解码校验，
+ * 全部通过后再解码写出（共两遍），失败时输入保持不变；不重叠时单次遍历，失败时out的内容不确定。
+ *
+ * @param hex 十六进制字符
+ * @param hex_len 字符数
+ * @param out 输出缓冲区
+ * @param out_size 输出缓冲区大小
+ * @return int 成功返回解码字节数，失败返回HEX_ERR_*或UTF8_ERR_INVALID
+ */
+int utf8_hex_decode(const char *hex, size_t hex_len, uint8_t *out, size_t out_size);
+
+#endif /* UTF8_VALIDATOR_H */
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""
+按菜单生成菜品字体子集，并输出大小和覆盖率报告。
+
+菜单文件为UTF-8文本，每行一个菜品名，空行和以 # 开头的行忽略，
+制表符之后的内容（价格、备注等）忽略。
+
+    font_subset.py --menu menu/menu.txt --font dish.ttf --out build/fonts/lv_font_dishes.bin \
+                   --size 26 --bpp 2 --report build/font_report.txt
+
+不指定 --font 时只检查 --out 指向的已有字体对菜单的覆盖情况。
+"""
+
+import argparse
+import os
+import shutil
+import struct
+import subprocess
+import sys
+
+# cmap子表格式，与lv_font_fmt_txt_cmap_type_t一致
+CMAP_FORMAT0_FULL = 0
+CMAP_SPARSE_FULL = 1
+CMAP_FORMAT0_TINY = 2
+CMAP_SPARSE_TINY = 3
+
+
+def read_menu(path):
+    dishes = []
+    with open(path, encoding='utf-8-sig') as f:
+        for line in f:
+            name = line.split('\t', 1)[0].strip()
+            if name and not name.startswith('#'):
+                dishes.append(name)
+    return dishes
+
+
+def parse_ranges(text):
+    points = set()
+    for part in filter(None, (p.strip() for p in text.split(','))):
+        lo, _, hi = part.partition('-')
+        lo = int(lo, 0)
+        hi = int(hi, 0) if hi else lo
+        points.update(range(lo, hi + 1))
+    return points
+
+
+def menu_code_points(dishes):
+    points = set()
+    for name in dishes:
+        points.update(ord(c) for c in name if not c.isspace() and ord(c) >= 0x20)
+    return points
+
+
+def run_lv_font_conv(tool, font, size, bpp, points, out, compress):
+    symbols = ''.join(chr(c) for c in sorted(points))
+    cmd = tool + ['--font', font, '--size', str(size), '--bpp', str(bpp),
+                  '--symbols', symbols, '--format', 'bin', '-o', out]
+    if not compress:
+        cmd.append('--no-compress')
+    os.makedirs(os.path.dirname(os.path.abspath(out)), exist_ok=True)
+    subprocess.run(cmd, check=True)
+
+
+def read_bits(data, bit, n):
+    value = 0
+    for _ in range(n):
+        value = (value << 1) | ((data[bit >> 3] >> (7 - (bit & 7))) & 1)
+        bit += 1
+    return value, bit
+
+
+def parse_binfont(data):
+    """解析lv_font_conv的bin格式，返回字体信息和码点→字形序号"""
+    def table(offset, tag):
+        length, name = struct.unpack_from('<I4s', data, offset)
+        if name != tag:
+            raise ValueError('missing %s table' % tag.decode())
+        return length
+
+    head_len = table(0, b'head')
+    (_, tables, size, ascent, descent, _, _, _, _, _, default_adv, _,
+     loca_fmt, _, adv_fmt, bpp, xy_bits, wh_bits, adv_bits, compression,
+     _, _, _, _) = struct.unpack_from('<IHHHhHhHhhHHBBBBBBBBBBhH', data, 8)
+
+    cmap = head_len
+    cmap_len = table(cmap, b'cmap')
+    (count,) = struct.unpack_from('<I', data, cmap + 8)
+    glyphs = {}
+    for i in range(count):
+        ofs, start, length, gid_start, entries, fmt, _ = struct.unpack_from(
+            '<IIHHHBB', data, cmap + 12 + i * 16)
+        sub = cmap + ofs
+        if fmt == CMAP_FORMAT0_TINY:
+            for r in range(length):
+                glyphs[start + r] = gid_start + r
+        elif fmt == CMAP_FORMAT0_FULL:
+            for r in range(min(length, entries)):
+                glyphs[start + r] = gid_start + data[sub + r]
+        else:
+            rcps = struct.unpack_from('<%dH' % entries, data, sub)
+            if fmt == CMAP_SPARSE_FULL:
+                ids = struct.unpack_from('<%dH' % entries, data, sub + entries * 2)
+            else:
+                ids = range(entries)
+            for rcp, gid in zip(rcps, ids):
+                glyphs[start + rcp] = gid_start + gid
+
+    loca = cmap + cmap_len
+    loca_len = table(loca, b'loca')
+    (loca_count,) = struct.unpack_from('<I', data, loca + 8)
+    offsets = struct.unpack_from('<%d%s' % (loca_count, 'I' if loca_fmt else 'H'), data, loca + 12)
+    glyf = loca + loca_len
+    glyf_len = table(glyf, b'glyf')
+
+    # 各字形未压缩的位图大小，用于估算压缩率
+    raw_bits = 0
+    for gid in range(1, loca_count):
+        bit = (glyf + offsets[gid]) * 8
+        if adv_bits:
+            _, bit = read_bits(data, bit, adv_bits)
+        _, bit = read_bits(data, bit, 2 * xy_bits)
+        w, bit = read_bits(data, bit, wh_bits)
+        h, bit = read_bits(data, bit, wh_bits)
+        raw_bits += w * h * bpp
+
+    return {
+        'size': size,
+        'bpp': bpp,
+        'line_height': ascent - descent,
+        'compression': compression,
+        'glyph_count': max(loca_count - 1, 0),
+        'glyf_bytes': glyf_len,
+        'raw_bitmap_bytes': (raw_bits + 7) // 8,
+        'kern': tables >= 4,
+        'glyphs': glyphs,
+    }
+
+
+def fmt_points(points):
+    return ' '.join('%s(U+%04X)' % (chr(c), c) for c in sorted(points))
+
+
+def write_report(path, menu, dishes, requested, font_path, info, generated):
+    covered = set(info['glyphs'])
+    missing = requested - covered
+    unused = covered - requested
+    file_size = os.path.getsize(font_path)
+    lines = [
+        '菜品字体报告',
+        '  菜单: %s (%d 个菜品, %d 个码点)' % (menu, len(dishes), len(requested)),
+        '  字体: %s (%s)' % (font_path, '本次生成' if generated else '已有字体，未重新生成'),
+        '  字号 %d px, %d bpp, %s, 行高 %d' % (
+            info['size'], info['bpp'],
+            ['未压缩', '压缩', '压缩(无预过滤)'][info['compression']] if info['compression'] < 3 else '未知',
+            info['line_height']),
+        '  字形 %d 个, 文件 %d 字节, 位图表 %d 字节 (未压缩约 %d 字节), 平均每字形 %.1f 字节' % (
+            info['glyph_count'], file_size, info['glyf_bytes'], info['raw_bitmap_bytes'],
+            file_size / info['glyph_count'] if info['glyph_count'] else 0),
+        '  覆盖率 %.1f%% (%d/%d)' % (
+            100.0 * len(requested & covered) / len(requested) if requested else 100.0,
+            len(requested & covered), len(requested)),
+    ]
+    if missing:
+        lines.append('  缺少 %d 个字符: %s' % (len(missing), fmt_points(missing)))
+        for name in dishes:
+            absent = {ord(c) for c in name} & missing
+            if absent:
+                lines.append('    %s: 缺 %s' % (name, ''.join(chr(c) for c in sorted(absent))))
+    if unused:
+        lines.append('  菜单未用到的字形 %d 个: %s' % (len(unused), fmt_points(unused)))
+
+    text = '\n'.join(lines) + '\n'
+    if path:
+        os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+        with open(path, 'w', encoding='utf-8') as f:
+            f.write(text)
+    sys.stdout.write(text)
+    return missing
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--menu', required=True, help='菜单文件')
+    parser.add_argument('--out', required=True, help='输出（或待检查）的bin字体')
+    parser.add_argument('--font', help='源字体（TTF/OTF/WOFF），不指定时只检查覆盖率')
+    parser.add_argument('--size', type=int, default=26)
+    parser.add_argument('--bpp', type=int, default=2, choices=(1, 2, 3, 4, 8))
+    parser.add_argument('--range', default='0x20-0x7E', help='菜单之外始终包含的码点范围')
+    parser.add_argument('--no-compress', action='store_true')
+    parser.add_argument('--lv-font-conv', default='lv_font_conv', help='lv_font_conv命令（可为 "npx lv_font_conv"）')
+    parser.add_argument('--report', help='报告输出文件')
+    parser.add_argument('--strict', action='store_true', help='有字符缺失时返回错误')
+    args = parser.parse_args()
+
+    dishes = read_menu(args.menu)
+    requested = menu_code_points(dishes)
+    points = requested | parse_ranges(args.range)
+
+    generated = False
+    if args.font:
+        tool = args.lv_font_conv.split()
+        if not shutil.which(tool[0]):
+            sys.exit('font_subset: %s not found' % tool[0])
+        run_lv_font_conv(tool, args.font, args.size, args.bpp, points, args.out, not args.no_compress)
+        generated = True
+
+    with open(args.out, 'rb') as f:
+        info = parse_binfont(f.read())
+    missing = write_report(args.report, args.menu, dishes, requested, args.out, info, generated)
+    if missing and args.strict:
+        sys.exit('font_subset: %d menu characters are missing from the font' % len(missing))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,188 @@
+/**
+ * @file bench_hex_decode.c
+ * @brief 十六进制解码微基准（Linux主机）
+ *
+ * 在菜品名、长备注、整条大消息三种长度下比较hex_decode与旧的解码流程
+ * （先逐字符isxdigit校验，再逐半字节分支转换）以及原地解码（先整体校验再解码），另外对抓包日志（或合成流量）
+ * 中的全部菜品名各解码一遍，既测不重叠的输出，也测原地解码。
+ *
+ *   bench_hex_decode [-c 抓包日志] [-n 合成订单数] [-r 轮数]
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+#include "hex_utils.h"
+#include "order_wire.h"
+
+static volatile int s_sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// 旧版解码流程作为对照
+static int hex_decode_legacy(const char *hex, size_t hex_len, uint8_t *out, size_t out_size)
+{
+    if (hex_len % 2 != 0 || out_size < hex_len / 2) return -1;
+    for (size_t i = 0; i < hex_len; i++) {
+        if (!isxdigit((unsigned char)hex[i])) return -1;
+    }
+    for (size_t i = 0, j = 0; i < hex_len; i += 2, j++) {
+        char c[2] = {hex[i], hex[i + 1]};
+        uint8_t v[2];
+        for (int k = 0; k < 2; k++) {
+            if (c[k] >= '0' && c[k] <= '9') v[k] = c[k] - '0';
+            else if (c[k] >= 'a' && c[k] <= 'f') v[k] = c[k] - 'a' + 10;
+            else v[k] = c[k] - 'A' + 10;
+        }
+        out[j] = (v[0] << 4) | v[1];
+    }
+    return hex_len / 2;
+}
+
+// 固定长度：每种长度重复解码同一段输入
+static void bench_lengths(int rounds)
+{
+    static const size_t lengths[] = {24, 256, 2048};
+    static const char digits[] = "0123456789ABCDEFabcdef";
+    static char hex[2048];
+    static char work[2048];
+    static uint8_t out[1024];
+
+    for (size_t i = 0; i < sizeof(hex); i++) {
+        hex[i] = digits[(i * 7) % (sizeof(digits) - 1)];
+    }
+
+    for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+        size_t len = lengths[n];
+        int iters = rounds * 1000;
+
+        uint64_t start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            s_sink += hex_decode_legacy(hex, len, out, sizeof(out));
+        }
+        double legacy_ns = (double)(now_ns() - start) / iters;
+
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            s_sink += hex_decode(hex, len, out, sizeof(out));
+        }
+        double fused_ns = (double)(now_ns() - start) / iters;
+
+        // 原地解码会改写输入，每次先恢复，扣除单独测得的拷贝耗时
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            memcpy(work, hex, len);
+            s_sink += work[len - 1];
+        }
+        uint64_t copy_ns = now_ns() - start;
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            memcpy(work, hex, len);
+            s_sink += hex_decode(work, len, (uint8_t *)work, len);
+        }
+        uint64_t in_place_total = now_ns() - start;
+        double in_place_ns = in_place_total > copy_ns ? (double)(in_place_total - copy_ns) / iters : 0.0;
+
+        printf("%5zu 字符: 旧实现 %7.1f ns, hex_decode %7.1f ns (%.2f ns/字节), 原地 %7.1f ns\n",
+               len, legacy_ns, fused_ns, fused_ns * 2 / len, in_place_ns);
+    }
+}
+
+// 报文中的菜品名：与设备一样原地解码
+static void bench_dish_names(const capture_t *cap, int rounds)
+{
+    capture_t names = {0};
+    char *work = malloc(cap->max_len + 1);
+    if (!work) return;
+
+    for (size_t i = 0; i < cap->count; i++) {
+        order_msg_t msg;
+        memcpy(work, cap->msgs[i].data, cap->msgs[i].len + 1);
+        if (order_wire_is_binary(cap->msgs[i].data, cap->msgs[i].len) ||
+            !order_wire_decode_json(work, cap->msgs[i].len, &msg)) {
+            continue;
+        }
+        for (uint16_t n = 0; n < msg.item_count; n++) {
+            capture_append(&names, msg.items[n].ptr, msg.items[n].len);
+        }
+    }
+    if (names.count == 0) {
+        printf("报文中没有菜品名\n");
+        goto out;
+    }
+
+    static uint8_t out[4096];
+    uint64_t legacy_ns = 0, separate_ns = 0, in_place_ns = 0;
+    uint32_t invalid = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < names.count; i++) {
+            const char *hex = (const char *)names.msgs[i].data;
+            size_t len = names.msgs[i].len;
+
+            uint64_t start = now_ns();
+            s_sink += hex_decode_legacy(hex, len, out, sizeof(out));
+            legacy_ns += now_ns() - start;
+
+            start = now_ns();
+            s_sink += hex_decode(hex, len, out, sizeof(out));
+            separate_ns += now_ns() - start;
+
+            // 原地解码会改写输入，拷贝耗时不计入
+            memcpy(work, hex, len);
+            start = now_ns();
+            int rc = hex_decode(work, len, (uint8_t *)work, len);
+            in_place_ns += now_ns() - start;
+            invalid += round == 0 && rc < 0;
+        }
+    }
+
+    uint64_t count = (uint64_t)names.count * rounds;
+    printf("菜品名 %zu 个, %zu 字符 (非十六进制 %u 个): 旧实现 %.1f ns/个, hex_decode %.1f ns/个, 原地 %.1f ns/个\n",
+           names.count, names.bytes, invalid, (double)legacy_ns / count,
+           (double)separate_ns / count, (double)in_place_ns / count);
+
+out:
+    free(work);
+    capture_free(&names);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capture_path = NULL;
+    int orders = 500;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:")) != -1) {
+        switch (opt) {
+        case 'c': capture_path = optarg; break;
+        case 'n': orders = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "用法: %s [-c 抓包日志] [-n 合成订单数] [-r 轮数]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    capture_t cap;
+    if (capture_path ? capture_load(capture_path, &cap) : capture_synth(&cap, orders, 8)) {
+        fprintf(stderr, "无法读取报文: %s\n", capture_path ? capture_path : "(合成)");
+        return 1;
+    }
+
+    bench_lengths(rounds);
+    printf("报文: %zu 条 (%s)\n", cap.count, cap.synthetic ? "合成流量" : capture_path);
+    bench_dish_names(&cap, rounds);
+
+    capture_free(&cap);
+    return 0;
+}
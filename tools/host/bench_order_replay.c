@@ -0,0 +1,166 @@
+/**
+ * @file bench_order_replay.c
+ * @brief 订单模型回放基准（Linux主机）
+ *
+ * 把抓包日志（或合成流量）中的报文按设备上的处理方式解码并写入订单模型，
+ * 不经过界面和蓝牙：JSON/二进制解码 → 十六进制菜品名原地解码 → 添加/更新/删除。
+ * 每轮结束时把剩余订单逐个出餐并删除，模型回到空状态后开始下一轮。
+ *
+ *   bench_order_replay [-c 抓包日志] [-n 合成订单数] [-r 轮数]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+#include "order_model.h"
+#include "order_wire.h"
+#include "utf8_validator.h"
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void replay_observer(order_model_event_t event, order_rec_t *rec, void *arg)
+{
+    uint32_t *counts = arg;
+    counts[event]++;
+}
+
+// 与main.c中apply_order_msg的模型部分一致
+static esp_err_t replay_message(order_model_t *model, char *msg, size_t len)
+{
+    order_msg_t m;
+    bool ok = order_wire_is_binary((const uint8_t *)msg, len) ?
+              order_wire_decode((const uint8_t *)msg, len, &m) :
+              order_wire_decode_json(msg, len, &m);
+    if (!ok) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (m.type == ORDER_MSG_INFO) {
+        return ESP_OK;
+    }
+
+    char order_id[ORDER_STORE_ID_MAX + 1];
+    if (m.order_id.len == 0 || m.order_id.len > ORDER_STORE_ID_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(order_id, m.order_id.ptr, m.order_id.len);
+    order_id[m.order_id.len] = '\0';
+
+    if (m.type == ORDER_MSG_REMOVE) {
+        return order_model_remove(model, order_id);
+    }
+
+    dish_t dishes[ORDER_MSG_MAX_ITEMS];
+    for (uint16_t i = 0; i < m.item_count; i++) {
+        char *text = (char *)m.items[i].ptr;
+        int decoded = m.hex_encoded ? utf8_hex_decode(text, m.items[i].len, (uint8_t *)text, m.items[i].len) : -1;
+        dishes[i].name = text;
+        dishes[i].name_len = decoded > 0 ? decoded : m.items[i].len;
+    }
+
+    order_t order = {
+        .order_id = order_id,
+        .order_num = 1,
+        .dish_count = m.item_count,
+        .dishes = dishes,
+    };
+    return m.type == ORDER_MSG_ADD ? order_model_add(model, &order) : order_model_update(model, &order);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capture_path = NULL;
+    int orders = 500;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:")) != -1) {
+        switch (opt) {
+        case 'c': capture_path = optarg; break;
+        case 'n': orders = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "用法: %s [-c 抓包日志] [-n 合成订单数] [-r 轮数]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    capture_t cap;
+    if (capture_path ? capture_load(capture_path, &cap) : capture_synth(&cap, orders, 8)) {
+        fprintf(stderr, "无法读取报文: %s\n", capture_path ? capture_path : "(合成)");
+        return 1;
+    }
+    if (cap.count == 0) {
+        fprintf(stderr, "%s 中没有订单报文\n", capture_path);
+        return 1;
+    }
+
+    order_model_t *model = order_model_create(1024);
+    char *work = malloc(cap.max_len + 1);
+    if (!model || !work) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+    uint32_t counts[ORDER_MODEL_REMOVED + 1] = {0};
+    order_model_subscribe(model, replay_observer, counts);
+
+    uint64_t ingest_ns = 0, ingest_max_ns = 0, close_ns = 0;
+    uint32_t errors = 0, closed = 0;
+    uint16_t peak = 0;
+
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < cap.count; i++) {
+            // 原地解码会改写报文，拷贝耗时计入（设备上由重组缓冲区承担）
+            uint64_t start = now_ns();
+            memcpy(work, cap.msgs[i].data, cap.msgs[i].len + 1);
+            errors += replay_message(model, work, cap.msgs[i].len) != ESP_OK;
+            uint64_t elapsed = now_ns() - start;
+            ingest_ns += elapsed;
+            if (elapsed > ingest_max_ns) {
+                ingest_max_ns = elapsed;
+            }
+        }
+        if (order_model_count(model) > peak) {
+            peak = order_model_count(model);
+        }
+
+        uint64_t start = now_ns();
+        order_rec_t *rec;
+        while ((rec = order_model_next(model, NULL)) != NULL) {
+            char order_id[ORDER_STORE_ID_MAX + 1];
+            strcpy(order_id, rec->order_id);
+            order_model_mark_served(model, rec);
+            order_model_remove(model, order_id);
+            closed++;
+        }
+        close_ns += now_ns() - start;
+    }
+
+    uint64_t messages = (uint64_t)cap.count * rounds;
+    printf("报文: %zu 条, %zu 字节 (%s)\n", cap.count, cap.bytes,
+           cap.synthetic ? "合成流量" : capture_path);
+    printf("回放 %d 轮: 解码+写入 平均 %.0f ns/条, 最长 %llu ns, 错误 %u\n",
+           rounds, (double)ingest_ns / messages, (unsigned long long)ingest_max_ns, errors);
+    printf("出餐+删除 平均 %.0f ns/单, 订单数峰值 %u\n",
+           closed ? (double)close_ns / closed : 0.0, peak);
+    printf("通知: 添加 %u, 更新 %u, 出餐 %u, 删除 %u\n",
+           counts[ORDER_MODEL_ADDED], counts[ORDER_MODEL_UPDATED],
+           counts[ORDER_MODEL_SERVED], counts[ORDER_MODEL_REMOVED]);
+
+    dish_intern_stats_t intern;
+    dish_intern_get_stats(&intern);
+    printf("菜品名驻留: 请求 %u, 命中 %u, 淘汰 %u, 失败 %u\n",
+           intern.lookups, intern.hits, intern.evictions, intern.failures);
+
+    free(work);
+    order_model_destroy(model);
+    capture_free(&cap);
+    return 0;
+}
@@ -0,0 +1,275 @@
+/**
+ * @file bench_order_wire.c
+ * @brief 订单报文解码基准（Linux主机）
+ *
+ * 对抓包日志（或合成流量）中的每条JSON报文比较三种解码路径的耗时和堆峰值：
+ *   - cJSON：构建DOM后遍历菜品并解码十六进制菜品名（旧的接收路径，找到cJSON源码时才编译）；
+ *   - json_tok：order_wire_decode_json原地切分后解码菜品名；
+ *   - 二进制：同一内容转换为二进制格式后用order_wire_decode解码。
+ * 堆峰值通过链接时包装malloc/calloc/free统计（-Wl,--wrap）。
+ *
+ *   bench_order_wire [-c 抓包日志] [-n 合成订单数] [-r 轮数]
+ */
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+#include "json_tok.h"
+#include "order_wire.h"
+#include "utf8_validator.h"
+#if ORDER_HOST_CJSON
+#include "cJSON.h"
+#endif
+
+typedef struct {
+    uint64_t ns;
+    size_t heap_peak;        // 单条报文的最大堆峰值
+    uint32_t ok;
+} path_stats_t;
+
+// 从heap_mark开始计算的堆用量（其他时间的分配和释放不影响结果）
+static long s_heap_now;
+static long s_heap_peak;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void __real_free(void *ptr);
+
+static void *heap_count(void *ptr)
+{
+    if (ptr) {
+        s_heap_now += (long)malloc_usable_size(ptr);
+        if (s_heap_now > s_heap_peak) {
+            s_heap_peak = s_heap_now;
+        }
+    }
+    return ptr;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    return heap_count(__real_malloc(size));
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    return heap_count(__real_calloc(n, size));
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr) {
+        s_heap_now -= (long)malloc_usable_size(ptr);
+    }
+    __real_free(ptr);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void heap_mark(void)
+{
+    s_heap_now = 0;
+    s_heap_peak = 0;
+}
+
+static void heap_record(path_stats_t *stats)
+{
+    if ((size_t)s_heap_peak > stats->heap_peak) {
+        stats->heap_peak = (size_t)s_heap_peak;
+    }
+}
+
+#if ORDER_HOST_CJSON
+// 旧路径：DOM上取字段，菜品名解码到栈缓冲区
+static bool decode_cjson(const char *json)
+{
+    char decoded[256];
+    cJSON *root = cJSON_Parse(json);
+    if (!root) {
+        return false;
+    }
+    bool ok = cJSON_IsString(cJSON_GetObjectItem(root, "type"));
+    cJSON *item = NULL;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(root, "items")) {
+        cJSON *name = cJSON_GetObjectItem(item, "name");
+        if (cJSON_IsString(name)) {
+            utf8_hex_decode(name->valuestring, strlen(name->valuestring), (uint8_t *)decoded, sizeof(decoded));
+        }
+    }
+    cJSON_Delete(root);
+    return ok;
+}
+#endif
+
+// 新路径：原地切分，菜品名原地解码
+static bool decode_tok(char *json, size_t len)
+{
+    order_msg_t msg;
+    if (!order_wire_decode_json(json, len, &msg)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < msg.item_count; i++) {
+        char *text = (char *)msg.items[i].ptr;
+        utf8_hex_decode(text, msg.items[i].len, (uint8_t *)text, msg.items[i].len);
+    }
+    return true;
+}
+
+// 把解码后的JSON报文转换为相同内容的二进制报文，返回长度（无法表示时返回0）
+static size_t encode_binary(const order_msg_t *msg, uint8_t *out, size_t out_size)
+{
+    size_t pos = 0;
+    out[pos++] = ORDER_WIRE_MAGIC_V1;
+    out[pos++] = msg->type;
+
+    const order_str_t *fields[ORDER_MSG_MAX_ITEMS + 2];
+    uint8_t tags[ORDER_MSG_MAX_ITEMS + 2];
+    int n = 0;
+    if (msg->order_id.ptr) { tags[n] = ORDER_WIRE_TAG_ORDER_ID; fields[n++] = &msg->order_id; }
+    if (msg->content.ptr) { tags[n] = ORDER_WIRE_TAG_CONTENT; fields[n++] = &msg->content; }
+    for (uint16_t i = 0; i < msg->item_count; i++) {
+        tags[n] = ORDER_WIRE_TAG_ITEM;
+        fields[n++] = &msg->items[i];
+    }
+
+    for (int i = 0; i < n; i++) {
+        // 二进制格式的字符串字段是解码后的UTF-8
+        uint8_t value[255];
+        int len = fields[i]->len;
+        if (tags[i] != ORDER_WIRE_TAG_ORDER_ID) {
+            len = utf8_hex_decode(fields[i]->ptr, fields[i]->len, value, sizeof(value));
+            if (len < 0) {
+                len = fields[i]->len;
+                if (len > 255) return 0;
+                memcpy(value, fields[i]->ptr, len);
+            }
+        } else {
+            if (len > 255) return 0;
+            memcpy(value, fields[i]->ptr, len);
+        }
+        if (pos + 2 + len > out_size) return 0;
+        out[pos++] = tags[i];
+        out[pos++] = (uint8_t)len;
+        memcpy(out + pos, value, len);
+        pos += len;
+    }
+    return pos;
+}
+
+static void print_path(const char *name, const path_stats_t *stats, uint64_t messages)
+{
+    printf("  %-8s 平均 %6.0f ns/条, 单条堆峰值 %5zu 字节, 成功 %u\n",
+           name, messages ? (double)stats->ns / messages : 0.0, stats->heap_peak, stats->ok);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capture_path = NULL;
+    int orders = 500;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:")) != -1) {
+        switch (opt) {
+        case 'c': capture_path = optarg; break;
+        case 'n': orders = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "用法: %s [-c 抓包日志] [-n 合成订单数] [-r 轮数]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    capture_t cap;
+    if (capture_path ? capture_load(capture_path, &cap) : capture_synth(&cap, orders, 8)) {
+        fprintf(stderr, "无法读取报文: %s\n", capture_path ? capture_path : "(合成)");
+        return 1;
+    }
+
+    // 只比较JSON报文；同时准备对应的二进制报文
+    capture_t json = {0}, bin = {0};
+    char *work = malloc(cap.max_len + 1);
+    uint8_t *bin_buf = malloc(cap.max_len + 2);
+    if (!work || !bin_buf) {
+        fprintf(stderr, "内存不足\n");
+        return 1;
+    }
+    for (size_t i = 0; i < cap.count; i++) {
+        order_msg_t msg;
+        if (order_wire_is_binary(cap.msgs[i].data, cap.msgs[i].len)) {
+            continue;
+        }
+        memcpy(work, cap.msgs[i].data, cap.msgs[i].len + 1);
+        if (!order_wire_decode_json(work, cap.msgs[i].len, &msg)) {
+            continue;
+        }
+        capture_append(&json, cap.msgs[i].data, cap.msgs[i].len);
+        size_t bin_len = encode_binary(&msg, bin_buf, cap.max_len + 2);
+        if (bin_len) {
+            capture_append(&bin, bin_buf, bin_len);
+        }
+    }
+    if (json.count == 0) {
+        fprintf(stderr, "%s 中没有可解码的JSON订单报文\n", capture_path ? capture_path : "(合成)");
+        return 1;
+    }
+
+    path_stats_t cjson = {0}, tok = {0}, binary = {0};
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < json.count; i++) {
+            const capture_msg_t *m = &json.msgs[i];
+#if ORDER_HOST_CJSON
+            heap_mark();
+            uint64_t start = now_ns();
+            cjson.ok += decode_cjson((const char *)m->data);
+            cjson.ns += now_ns() - start;
+            heap_record(&cjson);
+#endif
+
+            // 原地解码会改写输入，每轮先恢复副本，拷贝耗时不计入
+            memcpy(work, m->data, m->len + 1);
+            heap_mark();
+            uint64_t tok_start = now_ns();
+            tok.ok += decode_tok(work, m->len);
+            tok.ns += now_ns() - tok_start;
+            heap_record(&tok);
+        }
+        for (size_t i = 0; i < bin.count; i++) {
+            order_msg_t msg;
+            uint64_t start = now_ns();
+            binary.ok += order_wire_decode(bin.msgs[i].data, bin.msgs[i].len, &msg);
+            binary.ns += now_ns() - start;
+        }
+    }
+
+    printf("报文: %zu 条JSON, %zu 字节 (%s)\n", json.count, json.bytes,
+           cap.synthetic ? "合成流量" : capture_path);
+    printf("解码 %d 轮:\n", rounds);
+#if ORDER_HOST_CJSON
+    print_path("cJSON", &cjson, (uint64_t)json.count * rounds);
+#else
+    printf("  cJSON    未编译（设置 -DCJSON_DIR=<cJSON源码目录> 后对比）\n");
+#endif
+    print_path("json_tok", &tok, (uint64_t)json.count * rounds);
+    printf("  json_tok 另有启动时分配一次的token数组 %zu 字节\n",
+           (size_t)ORDER_JSON_MAX_TOKENS * sizeof(json_tok_t));
+    print_path("二进制", &binary, (uint64_t)bin.count * rounds);
+    printf("  二进制报文 %zu 条, %zu 字节\n", bin.count, bin.bytes);
+    int rc = tok.ok == (uint64_t)json.count * rounds ? 0 : 1;
+
+    free(work);
+    free(bin_buf);
+    capture_free(&json);
+    capture_free(&bin);
+    capture_free(&cap);
+    return rc;
+}
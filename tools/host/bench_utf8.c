@@ -0,0 +1,272 @@
+/**
+ * @file bench_utf8.c
+ * @brief UTF-8校验吞吐量基准（Linux主机）
+ *
+ * 纯ASCII（JSON骨架）、纯中文、中英混合三种文本上比较DFA与旧的逐字节分支实现；
+ * 对抓包日志（或合成流量）中的报文比较整条校验和按分片增量校验，
+ * 对其中的菜品名比较“先解码再校验”和utf8_hex_decode的同步校验；
+ * 另在几种长度的中文十六进制上比较utf8_hex_decode输出到独立缓冲区与原地解码。
+ *
+ *   bench_utf8 [-c 抓包日志] [-n 合成订单数] [-r 轮数]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture.h"
+#include "hex_utils.h"
+#include "order_wire.h"
+#include "utf8_validator.h"
+
+#define TEXT_LEN       4096
+#define FRAGMENT_LEN   240     // MTU 247时单个分片的数据长度
+
+static volatile int s_sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// 旧版UTF-8校验作为对照：逐字节分支判断，不检查超长编码和代理区
+static bool utf8_legacy(const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (c <= 0x7F) continue;
+        size_t extra;
+        if ((c & 0xE0) == 0xC0) extra = 1;
+        else if ((c & 0xF0) == 0xE0) extra = 2;
+        else if ((c & 0xF8) == 0xF0) extra = 3;
+        else return false;
+        if (i + extra >= length) return false;
+        for (size_t k = 1; k <= extra; k++) {
+            if ((data[i + k] & 0xC0) != 0x80) return false;
+        }
+        i += extra;
+    }
+    return true;
+}
+
+// 用样本循环填满缓冲区，末尾不截断多字节字符
+static size_t fill_text(uint8_t *buf, size_t size, const char *sample)
+{
+    size_t sample_len = strlen(sample);
+    size_t pos = 0;
+    while (pos + sample_len <= size) {
+        memcpy(buf + pos, sample, sample_len);
+        pos += sample_len;
+    }
+    return pos;
+}
+
+static void bench_texts(int rounds)
+{
+    static const struct {
+        const char *name;
+        const char *sample;
+    } texts[] = {
+        {"ascii", "{\"type\":\"add\",\"orderId\":\"202509230012\",\"qty\":1}"},
+        {"cjk",   "宫保鸡丁麻婆豆腐陈醋花生酸菜鱼香菇油菜米饭"},
+        {"mixed", "A12 宫保鸡丁 x2, 米饭 x1; "},
+    };
+    static uint8_t buf[TEXT_LEN];
+    int iters = rounds * 100;
+
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++) {
+        size_t len = fill_text(buf, sizeof(buf), texts[t].sample);
+
+        uint64_t start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            s_sink += utf8_legacy(buf, len);
+        }
+        double legacy_ns = (double)(now_ns() - start) / iters;
+
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            s_sink += utf8_is_valid(buf, len);
+        }
+        double dfa_ns = (double)(now_ns() - start) / iters;
+
+        printf("%-5s %zu 字节: 旧实现 %6.0f ns (%.0f MB/s), DFA %6.0f ns (%.0f MB/s)\n",
+               texts[t].name, len, legacy_ns, len * 1000.0 / legacy_ns, dfa_ns, len * 1000.0 / dfa_ns);
+    }
+}
+
+// 固定长度的中文十六进制：输出到独立缓冲区（单遍）与原地解码（栈上校验一遍、再解码一遍）
+static void bench_hex_lengths(int rounds)
+{
+    static const size_t lengths[] = {24, 256, 2048};
+    static const char sample[] = "宫保鸡丁麻婆豆腐陈醋花生酸菜鱼";
+    static const char digits[] = "0123456789ABCDEF";
+    static char hex[2048];
+    static char work[2048];
+    static uint8_t out[1024];
+    int iters = rounds * 1000;
+
+    // 按整字节生成，长度取3的倍数个字节时不截断中文
+    for (size_t i = 0; i < sizeof(hex) / 2; i++) {
+        uint8_t b = (uint8_t)sample[i % (sizeof(sample) - 1)];
+        hex[i * 2] = digits[b >> 4];
+        hex[i * 2 + 1] = digits[b & 0x0F];
+    }
+
+    for (size_t n = 0; n < sizeof(lengths) / sizeof(lengths[0]); n++) {
+        size_t len = lengths[n] / 6 * 6;
+
+        uint64_t start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            s_sink += utf8_hex_decode(hex, len, out, sizeof(out));
+        }
+        double separate_ns = (double)(now_ns() - start) / iters;
+
+        // 原地解码会改写输入，每次先恢复，扣除单独测得的拷贝耗时
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            memcpy(work, hex, len);
+            s_sink += work[len - 1];
+        }
+        uint64_t copy_ns = now_ns() - start;
+        start = now_ns();
+        for (int i = 0; i < iters; i++) {
+            memcpy(work, hex, len);
+            s_sink += utf8_hex_decode(work, len, (uint8_t *)work, len);
+        }
+        uint64_t in_place_total = now_ns() - start;
+        double in_place_ns = in_place_total > copy_ns ? (double)(in_place_total - copy_ns) / iters : 0.0;
+
+        printf("%5zu 字符: utf8_hex_decode %7.1f ns, 原地 %7.1f ns (%.2fx)\n",
+               len, separate_ns, in_place_ns, separate_ns > 0 ? in_place_ns / separate_ns : 0.0);
+    }
+}
+
+// 报文：整条校验与按分片增量校验（设备上在分片到达时校验）
+static void bench_messages(const capture_t *cap, int rounds)
+{
+    uint64_t whole_ns = 0, streamed_ns = 0, bytes = 0;
+    uint32_t rejected = 0;
+
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < cap->count; i++) {
+            const uint8_t *data = cap->msgs[i].data;
+            size_t len = cap->msgs[i].len;
+            if (order_wire_is_binary(data, len)) {
+                continue;
+            }
+
+            bytes += len;
+            uint64_t start = now_ns();
+            bool ok = utf8_is_valid(data, len);
+            whole_ns += now_ns() - start;
+            rejected += round == 0 && !ok;
+
+            start = now_ns();
+            utf8_state_t state = UTF8_ACCEPT;
+            for (size_t off = 0; off < len && state != UTF8_REJECT; off += FRAGMENT_LEN) {
+                size_t n = len - off < FRAGMENT_LEN ? len - off : FRAGMENT_LEN;
+                state = utf8_validate_chunk(state, data + off, n);
+            }
+            streamed_ns += now_ns() - start;
+            s_sink += state;
+        }
+    }
+
+    printf("文本报文 %llu 字节 (非法 %u 条): 整条 %.0f MB/s, 每%d字节一个分片 %.0f MB/s\n",
+           (unsigned long long)(rounds ? bytes / rounds : 0), rejected,
+           whole_ns ? bytes * 1000.0 / whole_ns : 0.0,
+           FRAGMENT_LEN, streamed_ns ? bytes * 1000.0 / streamed_ns : 0.0);
+}
+
+// 菜品名：先解码再校验与解码时同步校验
+static void bench_dish_names(const capture_t *cap, int rounds)
+{
+    capture_t names = {0};
+    char *work = malloc(cap->max_len + 1);
+    if (!work) return;
+
+    for (size_t i = 0; i < cap->count; i++) {
+        order_msg_t msg;
+        memcpy(work, cap->msgs[i].data, cap->msgs[i].len + 1);
+        if (order_wire_is_binary(cap->msgs[i].data, cap->msgs[i].len) ||
+            !order_wire_decode_json(work, cap->msgs[i].len, &msg)) {
+            continue;
+        }
+        for (uint16_t n = 0; n < msg.item_count; n++) {
+            capture_append(&names, msg.items[n].ptr, msg.items[n].len);
+        }
+    }
+    if (names.count == 0) {
+        printf("报文中没有菜品名\n");
+        goto out;
+    }
+
+    static uint8_t out[4096];
+    uint64_t two_pass_ns = 0, fused_ns = 0, in_place_ns = 0;
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < names.count; i++) {
+            const char *hex = (const char *)names.msgs[i].data;
+            size_t len = names.msgs[i].len;
+
+            uint64_t start = now_ns();
+            int decoded = hex_decode(hex, len, out, sizeof(out));
+            s_sink += decoded > 0 && utf8_is_valid(out, decoded);
+            two_pass_ns += now_ns() - start;
+
+            start = now_ns();
+            s_sink += utf8_hex_decode(hex, len, out, sizeof(out));
+            fused_ns += now_ns() - start;
+
+            // 原地解码会改写输入，拷贝耗时不计入
+            memcpy(work, hex, len);
+            start = now_ns();
+            s_sink += utf8_hex_decode(work, len, (uint8_t *)work, len);
+            in_place_ns += now_ns() - start;
+        }
+    }
+
+    uint64_t count = (uint64_t)names.count * rounds;
+    printf("菜品名 %zu 个: 解码后校验 %.1f ns/个, 同步校验 %.1f ns/个, 原地同步校验 %.1f ns/个\n",
+           names.count, (double)two_pass_ns / count, (double)fused_ns / count, (double)in_place_ns / count);
+
+out:
+    free(work);
+    capture_free(&names);
+}
+
+int main(int argc, char **argv)
+{
+    const char *capture_path = NULL;
+    int orders = 500;
+    int rounds = 20;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:n:r:")) != -1) {
+        switch (opt) {
+        case 'c': capture_path = optarg; break;
+        case 'n': orders = atoi(optarg); break;
+        case 'r': rounds = atoi(optarg); break;
+        default:
+            fprintf(stderr, "用法: %s [-c 抓包日志] [-n 合成订单数] [-r 轮数]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    capture_t cap;
+    if (capture_path ? capture_load(capture_path, &cap) : capture_synth(&cap, orders, 8)) {
+        fprintf(stderr, "无法读取报文: %s\n", capture_path ? capture_path : "(合成)");
+        return 1;
+    }
+
+    bench_texts(rounds);
+    bench_hex_lengths(rounds);
+    printf("报文来源: %s\n", cap.synthetic ? "合成流量" : capture_path);
+    bench_messages(&cap, rounds);
+    bench_dish_names(&cap, rounds);
+
+    capture_free(&cap);
+    return 0;
+}
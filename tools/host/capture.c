@@ -0,0 +1,173 @@
+/**
+ * @file capture.c
+ * @brief 订单报文的读取和合成
+ */
+
+#include "capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hex_utils.h"
+
+#define CAPTURE_MARK    "OrderCapture: "
+#define LINE_MAX_LEN    (64 * 1024)
+
+// 常见菜名（合成流量用），重复出现的比例与现场相近
+static const char *const s_dish_names[] = {
+    "宫保鸡丁", "麻婆豆腐", "鱼香肉丝", "米饭", "酸菜鱼", "回锅肉", "香菇油菜",
+    "西红柿炒鸡蛋", "水煮牛肉", "干煸四季豆", "地三鲜", "糖醋里脊", "红烧茄子",
+    "酸辣土豆丝", "可乐", "冰柠檬茶", "扬州炒饭", "蛋花汤", "小笼包", "凉拌黄瓜",
+};
+#define DISH_NAME_COUNT (sizeof(s_dish_names) / sizeof(s_dish_names[0]))
+
+int capture_append(capture_t *cap, const void *data, size_t len)
+{
+    if (cap->count % 256 == 0) {
+        capture_msg_t *msgs = realloc(cap->msgs, (cap->count + 256) * sizeof(*msgs));
+        if (!msgs) return -1;
+        cap->msgs = msgs;
+    }
+
+    uint8_t *copy = malloc(len + 1);
+    if (!copy) return -1;
+    memcpy(copy, data, len);
+    copy[len] = '\0';
+
+    cap->msgs[cap->count].data = copy;
+    cap->msgs[cap->count].len = len;
+    cap->count++;
+    cap->bytes += len;
+    if (len > cap->max_len) {
+        cap->max_len = len;
+    }
+    return 0;
+}
+
+// 抓包行：取标记之后连续的十六进制字符
+static int capture_parse_hex(capture_t *cap, const char *hex, uint8_t *scratch)
+{
+    size_t len = 0;
+    while (hex_char_to_value(hex[len]) || hex[len] == '0') {
+        len++;
+    }
+    len &= ~(size_t)1;
+    int n = hex_decode(hex, len, scratch, len / 2);
+    if (n <= 0) {
+        return 0;
+    }
+    return capture_append(cap, scratch, (size_t)n);
+}
+
+int capture_load(const char *path, capture_t *cap)
+{
+    memset(cap, 0, sizeof(*cap));
+
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+
+    char *line = malloc(LINE_MAX_LEN);
+    uint8_t *scratch = malloc(LINE_MAX_LEN / 2);
+    int rc = line && scratch ? 0 : -1;
+
+    while (rc == 0 && fgets(line, LINE_MAX_LEN, f)) {
+        const char *mark = strstr(line, CAPTURE_MARK);
+        if (mark) {
+            rc = capture_parse_hex(cap, mark + strlen(CAPTURE_MARK), scratch);
+        } else if (line[0] == '{') {
+            size_t len = strcspn(line, "\r\n");
+            rc = capture_append(cap, line, len);
+        }
+    }
+
+    free(line);
+    free(scratch);
+    fclose(f);
+    if (rc != 0) {
+        capture_free(cap);
+    }
+    return rc;
+}
+
+static uint32_t synth_rand(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static size_t synth_hex(char *out, const char *text)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    size_t n = 0;
+    for (const uint8_t *p = (const uint8_t *)text; *p; p++) {
+        out[n++] = digits[*p >> 4];
+        out[n++] = digits[*p & 0x0F];
+    }
+    return n;
+}
+
+// 与POS相同的JSON：{"type":..,"orderId":..,"items":[{"name":"<hex>","qty":n},...]}
+static size_t synth_order(char *out, size_t size, const char *type, int order, int dishes, uint32_t *rng)
+{
+    size_t pos = snprintf(out, size, "{\"type\":\"%s\",\"orderId\":\"20250923%04d\",\"items\":[", type, order);
+    for (int i = 0; i < dishes; i++) {
+        const char *name = s_dish_names[synth_rand(rng) % DISH_NAME_COUNT];
+        pos += snprintf(out + pos, size - pos, "%s{\"name\":\"", i ? "," : "");
+        pos += synth_hex(out + pos, name);
+        pos += snprintf(out + pos, size - pos, "\",\"qty\":%u}", 1 + synth_rand(rng) % 3);
+    }
+    pos += snprintf(out + pos, size - pos, "]}");
+    return pos;
+}
+
+int capture_synth(capture_t *cap, int orders, int max_dishes)
+{
+    // 每个菜名最长8个汉字（24字节，十六进制48字符），单条报文留足余量
+    size_t size = 128 + (size_t)max_dishes * 80;
+    char *msg = malloc(size);
+    uint32_t rng = 0x2545F491u;
+    int rc = msg ? 0 : -1;
+
+    memset(cap, 0, sizeof(*cap));
+    cap->synthetic = true;
+
+    for (int n = 0; rc == 0 && n < orders; n++) {
+        int dishes = 1 + synth_rand(&rng) % max_dishes;
+        rc = capture_append(cap, msg, synth_order(msg, size, "add", n, dishes, &rng));
+    }
+    for (int n = 0; rc == 0 && n < orders; n++) {
+        int dishes = 1 + synth_rand(&rng) % max_dishes;
+        rc = capture_append(cap, msg, synth_order(msg, size, "update", n, dishes, &rng));
+        if (rc == 0 && n % 10 == 9) {
+            size_t len = snprintf(msg, size, "{\"type\":\"remove\",\"orderId\":\"20250923%04d\"}", n);
+            rc = capture_append(cap, msg, len);
+        }
+        if (rc == 0 && n % 50 == 49) {
+            size_t len = snprintf(msg, size, "{\"type\":\"info\",\"content\":\"");
+            len += synth_hex(msg + len, "请取餐");
+            len += snprintf(msg + len, size - len, "\"}");
+            rc = capture_append(cap, msg, len);
+        }
+    }
+
+    free(msg);
+    if (rc != 0) {
+        capture_free(cap);
+        cap->synthetic = false;
+    }
+    return rc;
+}
+
+void capture_free(capture_t *cap)
+{
+    for (size_t i = 0; i < cap->count; i++) {
+        free(cap->msgs[i].data);
+    }
+    free(cap->msgs);
+    cap->msgs = NULL;
+    cap->count = 0;
+    cap->bytes = 0;
+    cap->max_len = 0;
+}
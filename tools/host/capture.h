@@ -0,0 +1,60 @@
+/**
+ * @file capture.h
+ * @brief 主机基准使用的订单报文：读取设备抓包日志，或生成合成流量
+ *
+ * 设备开启CONFIG_ORDER_CAPTURE后，每条重组完成的消息以十六进制输出一行：
+ *   I (12345) OrderCapture: 7B2274797065223A22616464222C...
+ * 用 idf.py monitor | tee orders.log 保存即可回放。读取时：
+ *   - 含"OrderCapture: "的行取其后的十六进制（忽略监视器的颜色控制符）；
+ *   - 以'{'开头的行按原样作为JSON报文，便于手工补充用例；
+ *   - 其他行忽略。
+ * 没有抓包文件时用capture_synth生成与POS相同格式的流量（明确标注为合成数据）。
+ */
+
+#ifndef HOST_CAPTURE_H
+#define HOST_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct {
+    uint8_t *data;           // 报文原文（额外保留一个'\0'）
+    size_t len;
+} capture_msg_t;
+
+typedef struct {
+    capture_msg_t *msgs;
+    size_t count;
+    size_t bytes;            // 报文合计字节数
+    size_t max_len;          // 最长报文的字节数
+    bool synthetic;          // 由capture_synth生成
+} capture_t;
+
+/**
+ * @brief 读取抓包日志
+ *
+ * @return 0 成功（可能一条报文也没有），-1 文件无法读取或内存不足
+ */
+int capture_load(const char *path, capture_t *cap);
+
+/**
+ * @brief 生成合成流量：orders个订单的添加、更新、部分由POS删除，以及少量系统消息
+ *
+ * 菜品名取自常见菜名，按POS的方式以UTF-8十六进制编码。
+ *
+ * @param max_dishes 每单最多菜品数（1~ORDER_MSG_MAX_ITEMS）
+ * @return 0 成功，-1 内存不足
+ */
+int capture_synth(capture_t *cap, int orders, int max_dishes);
+
+/**
+ * @brief 追加一条报文
+ *
+ * @return 0 成功，-1 内存不足
+ */
+int capture_append(capture_t *cap, const void *data, size_t len);
+
+void capture_free(capture_t *cap);
+
+#endif // HOST_CAPTURE_H
@@ -0,0 +1,156 @@
+/**
+ * @file flash_emu.c
+ * @brief 以文件模拟的NOR flash分区实现
+ */
+
+#include "flash_emu.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "esp_partition.h"
+
+static int s_fd = -1;
+static esp_partition_t s_part;
+static long s_budget = -1;
+static bool s_power_lost;
+static flash_emu_stats_t s_stats;
+
+int flash_emu_open(const char *path, const char *label, size_t size)
+{
+    if (s_fd >= 0 || size == 0 || size % FLASH_EMU_SECTOR != 0) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return -1;
+
+    // 新文件或大小不符时按全部擦除处理
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != size) {
+        uint8_t erased[FLASH_EMU_SECTOR];
+        memset(erased, 0xFF, sizeof(erased));
+        if (ftruncate(fd, 0) != 0) {
+            close(fd);
+            return -1;
+        }
+        for (size_t off = 0; off < size; off += sizeof(erased)) {
+            if (pwrite(fd, erased, sizeof(erased), off) != (ssize_t)sizeof(erased)) {
+                close(fd);
+                return -1;
+            }
+        }
+    }
+
+    memset(&s_part, 0, sizeof(s_part));
+    s_part.type = ESP_PARTITION_TYPE_DATA;
+    s_part.subtype = ESP_PARTITION_SUBTYPE_ANY;
+    s_part.size = size;
+    s_part.erase_size = FLASH_EMU_SECTOR;
+    strncpy(s_part.label, label, sizeof(s_part.label) - 1);
+    s_fd = fd;
+    s_budget = -1;
+    s_power_lost = false;
+    return 0;
+}
+
+void flash_emu_close(void)
+{
+    if (s_fd >= 0) {
+        close(s_fd);
+        s_fd = -1;
+    }
+    s_budget = -1;
+    s_power_lost = false;
+}
+
+void flash_emu_set_budget(long bytes)
+{
+    s_budget = bytes;
+}
+
+bool flash_emu_power_lost(void)
+{
+    return s_power_lost;
+}
+
+void flash_emu_get_stats(flash_emu_stats_t *stats)
+{
+    *stats = s_stats;
+}
+
+// 消耗写入预算，返回实际允许写入的字节数
+static size_t budget_take(size_t bytes)
+{
+    if (s_budget < 0) return bytes;
+    size_t allowed = (size_t)s_budget < bytes ? (size_t)s_budget : bytes;
+    s_budget -= allowed;
+    if (allowed < bytes) {
+        s_power_lost = true;
+    }
+    return allowed;
+}
+
+static bool range_valid(const esp_partition_t *part, size_t offset, size_t size)
+{
+    return s_fd >= 0 && part == &s_part && offset <= s_part.size && size <= s_part.size - offset;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label)
+{
+    (void)subtype;
+    if (s_fd < 0 || type != ESP_PARTITION_TYPE_DATA) return NULL;
+    if (label && strcmp(label, s_part.label) != 0) return NULL;
+    return &s_part;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *part, size_t offset, void *dst, size_t size)
+{
+    if (!range_valid(part, offset, size)) return ESP_ERR_INVALID_ARG;
+    if (s_power_lost) return ESP_FAIL;
+
+    s_stats.reads++;
+    return pread(s_fd, dst, size, offset) == (ssize_t)size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *part, size_t offset, const void *src, size_t size)
+{
+    if (!range_valid(part, offset, size)) return ESP_ERR_INVALID_ARG;
+    if (s_power_lost) return ESP_FAIL;
+
+    size_t allowed = budget_take(size);
+    const uint8_t *in = src;
+    uint8_t buf[256];
+    for (size_t done = 0; done < allowed; ) {
+        size_t chunk = allowed - done < sizeof(buf) ? allowed - done : sizeof(buf);
+        if (pread(s_fd, buf, chunk, offset + done) != (ssize_t)chunk) return ESP_FAIL;
+        for (size_t i = 0; i < chunk; i++) {
+            if (in[done + i] & ~buf[i]) {
+                s_stats.overwrites++;
+            }
+            buf[i] &= in[done + i];
+        }
+        if (pwrite(s_fd, buf, chunk, offset + done) != (ssize_t)chunk) return ESP_FAIL;
+        done += chunk;
+    }
+
+    s_stats.writes++;
+    s_stats.bytes_written += allowed;
+    return allowed == size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *part, size_t offset, size_t size)
+{
+    if (!range_valid(part, offset, size) || offset % FLASH_EMU_SECTOR || size % FLASH_EMU_SECTOR) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_power_lost) return ESP_FAIL;
+
+    uint8_t erased[FLASH_EMU_SECTOR];
+    memset(erased, 0xFF, sizeof(erased));
+    for (size_t off = 0; off < size; off += FLASH_EMU_SECTOR) {
+        if (budget_take(1) != 1) return ESP_FAIL;
+        if (pwrite(s_fd, erased, sizeof(erased), offset + off) != (ssize_t)sizeof(erased)) return ESP_FAIL;
+        s_stats.erases++;
+    }
+    return ESP_OK;
+}
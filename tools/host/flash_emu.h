@@ -0,0 +1,59 @@
+/**
+ * @file flash_emu.h
+ * @brief 以文件模拟的NOR flash分区（实现esp_partition_*）
+ *
+ * 行为与SPI NOR flash一致：
+ *   - 擦除以4KB扇区为单位，擦除后全为0xFF；
+ *   - 写入只能把位从1变为0（新数据与原内容按位与），写入未擦除区域时计数；
+ *   - 可设置断电点：写入预算用完时，正在进行的写入只写了前一部分，之后的读写全部失败，
+ *     直到重新打开（模拟重启）。
+ * 内容保存在文件中，进程重启后仍然存在。
+ */
+
+#ifndef HOST_FLASH_EMU_H
+#define HOST_FLASH_EMU_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define FLASH_EMU_SECTOR    4096
+
+typedef struct {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;
+    uint64_t bytes_written;
+    uint32_t overwrites;     // 写入时要把0变为1的次数（写入前未擦除，数据会损坏）
+} flash_emu_stats_t;
+
+/**
+ * @brief 打开（不存在时创建并擦除）模拟分区，分区名为label
+ *
+ * @param path 文件路径
+ * @param label 分区名
+ * @param size 分区大小（扇区的整数倍）
+ * @return 0 成功，-1 失败
+ */
+int flash_emu_open(const char *path, const char *label, size_t size);
+
+/**
+ * @brief 关闭文件，清除断电状态
+ */
+void flash_emu_close(void);
+
+/**
+ * @brief 设置断电点
+ *
+ * @param bytes 之后还能写入的字节数（擦除一个扇区计1字节），负数表示不断电
+ */
+void flash_emu_set_budget(long bytes);
+
+/**
+ * @brief 是否已到达断电点
+ */
+bool flash_emu_power_lost(void);
+
+void flash_emu_get_stats(flash_emu_stats_t *stats);
+
+#endif // HOST_FLASH_EMU_H
@@ -0,0 +1,24 @@
+/**
+ * @file host_test.h
+ * @brief 主机测试用的断言：失败时打印位置并计数，main最后返回HOST_TEST_RESULT()
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+
+static int s_host_test_failures;
+
+#define CHECK(cond) do {                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: CHECK(%s) 失败\n", __FILE__, __LINE__, #cond); \
+            s_host_test_failures++;                                             \
+        }                                                                       \
+    } while (0)
+
+#define HOST_TEST_RESULT() (s_host_test_failures == 0 ?                        \
+                            (printf("通过\n"), 0) :                             \
+                            (printf("失败 %d 项\n", s_host_test_failures), 1))
+
+#endif // HOST_TEST_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_rom_crc.h
+ * @brief 主机构建用的CRC32（与ROM中的esp_rom_crc32_le结果相同）
+ */
+
+#ifndef HOST_ESP_ROM_CRC_H
+#define HOST_ESP_ROM_CRC_H
+
+#include <stdint.h>
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len);
+
+#endif // HOST_ESP_ROM_CRC_H
@@ -0,0 +1,13 @@
+/**
+ * @file esp_timer.h
+ * @brief 主机构建用的esp_timer_get_time（单调时钟，微秒）
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,27 @@
+/**
+ * @file ringbuf.h
+ * @brief 主机构建用的环形缓冲区（只支持RINGBUF_TYPE_NOSPLIT，按ESP-IDF的方式计算占用）
+ */
+
+#ifndef HOST_FREERTOS_RINGBUF_H
+#define HOST_FREERTOS_RINGBUF_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_ringbuf *RingbufHandle_t;
+
+typedef enum {
+    RINGBUF_TYPE_NOSPLIT = 0,
+    RINGBUF_TYPE_ALLOWSPLIT,
+    RINGBUF_TYPE_BYTEBUF,
+} RingbufferType_t;
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type);
+void vRingbufferDelete(RingbufHandle_t rb);
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *item, size_t size, TickType_t wait);
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t rb, void **item, size_t size, TickType_t wait);
+BaseType_t xRingbufferSendComplete(RingbufHandle_t rb, void *item);
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *size, TickType_t wait);
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item);
+
+#endif // HOST_FREERTOS_RINGBUF_H
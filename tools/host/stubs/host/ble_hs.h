@@ -0,0 +1,25 @@
+/**
+ * @file ble_hs.h
+ * @brief NimBLE主机接口的最小主机定义：只有重组层用到的扁平mbuf和ATT错误码
+ */
+
+#ifndef HOST_BLE_HS_H
+#define HOST_BLE_HS_H
+
+#include <stdint.h>
+
+// 主机上的mbuf只有一段连续数据
+struct os_mbuf {
+    const uint8_t *om_data;
+    uint16_t om_len;
+};
+
+#define OS_MBUF_PKTLEN(om) ((om)->om_len)
+
+int os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst);
+
+#define BLE_ATT_ERR_INVALID_ATTR_VALUE_LEN  0x0d
+#define BLE_ATT_ERR_UNLIKELY                0x0e
+#define BLE_ATT_ERR_INSUFFICIENT_RES        0x11
+
+#endif // HOST_BLE_HS_H
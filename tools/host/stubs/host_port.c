@@ -0,0 +1,184 @@
+/**
+ * @file host_port.c
+ * @brief 订单处理模块在主机上运行所需的ESP-IDF/FreeRTOS函数（单线程）
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/task.h"
+#include "host/ble_hs.h"
+
+esp_log_level_t esp_log_host_level = ESP_LOG_WARN;
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint32_t esp_log_timestamp(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    (void)ticks;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                       UBaseType_t prio, TaskHandle_t *handle)
+{
+    (void)fn;
+    (void)name;
+    (void)stack;
+    (void)arg;
+    (void)prio;
+    if (handle) {
+        *handle = NULL;
+    }
+    return pdPASS;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// 环形缓冲区：按先后顺序的链表，每条记录占用8字节头加4字节对齐的数据（与ESP-IDF相同）
+typedef struct host_rb_item {
+    struct host_rb_item *next;
+    size_t size;
+    uint8_t data[];
+} host_rb_item_t;
+
+struct host_ringbuf {
+    size_t capacity;
+    size_t used;
+    host_rb_item_t *head;
+    host_rb_item_t *tail;
+};
+
+#define RB_ITEM_COST(size)  (8 + (((size) + 3u) & ~3u))
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type)
+{
+    if (type != RINGBUF_TYPE_NOSPLIT) return NULL;
+    RingbufHandle_t rb = calloc(1, sizeof(*rb));
+    if (rb) {
+        rb->capacity = size;
+    }
+    return rb;
+}
+
+void vRingbufferDelete(RingbufHandle_t rb)
+{
+    while (rb && rb->head) {
+        host_rb_item_t *item = rb->head;
+        rb->head = item->next;
+        free(item);
+    }
+    free(rb);
+}
+
+BaseType_t xRingbufferSendAcquire(RingbufHandle_t rb, void **item, size_t size, TickType_t wait)
+{
+    (void)wait;
+    if (rb->used + RB_ITEM_COST(size) > rb->capacity) return pdFALSE;
+
+    host_rb_item_t *node = malloc(sizeof(*node) + size);
+    if (!node) return pdFALSE;
+    node->next = NULL;
+    node->size = size;
+    if (rb->tail) {
+        rb->tail->next = node;
+    } else {
+        rb->head = node;
+    }
+    rb->tail = node;
+    rb->used += RB_ITEM_COST(size);
+    *item = node->data;
+    return pdTRUE;
+}
+
+BaseType_t xRingbufferSendComplete(RingbufHandle_t rb, void *item)
+{
+    (void)rb;
+    (void)item;
+    return pdTRUE;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t rb, const void *data, size_t size, TickType_t wait)
+{
+    void *item;
+    if (xRingbufferSendAcquire(rb, &item, size, wait) != pdTRUE) return pdFALSE;
+    memcpy(item, data, size);
+    return xRingbufferSendComplete(rb, item);
+}
+
+void *xRingbufferReceive(RingbufHandle_t rb, size_t *size, TickType_t wait)
+{
+    (void)wait;
+    host_rb_item_t *node = rb->head;
+    if (!node) return NULL;
+    rb->head = node->next;
+    if (!rb->head) {
+        rb->tail = NULL;
+    }
+    *size = node->size;
+    return node->data;
+}
+
+void vRingbufferReturnItem(RingbufHandle_t rb, void *item)
+{
+    host_rb_item_t *node = (host_rb_item_t *)((uint8_t *)item - offsetof(host_rb_item_t, data));
+    rb->used -= RB_ITEM_COST(node->size);
+    free(node);
+}
+
+int os_mbuf_copydata(const struct os_mbuf *om, int off, int len, void *dst)
+{
+    if (off < 0 || len < 0 || off + len > om->om_len) {
+        return -1;
+    }
+    memcpy(dst, om->om_data + off, len);
+    return 0;
+}
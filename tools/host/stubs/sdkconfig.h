@@ -0,0 +1,24 @@
+/**
+ * @file sdkconfig.h
+ * @brief 主机构建用的配置（与main/Kconfig.projbuild的默认值一致）
+ *
+ * 延迟日志在主机上关闭，DLOGx直接输出；测试需要时单独编译order_log.c。
+ */
+
+#ifndef HOST_SDKCONFIG_H
+#define HOST_SDKCONFIG_H
+
+#define CONFIG_ORDER_FRAME_MAX_LEN          4096
+#define CONFIG_ORDER_FRAME_POOL_SIZE        16
+#define CONFIG_ORDER_LOG_DEFERRED           0
+#define CONFIG_ORDER_LOG_BUFFER_SIZE        8192
+#define CONFIG_ORDER_LOG_RATE_LIMIT         50
+#define CONFIG_ORDER_STORE_CAPACITY         512
+#define CONFIG_ORDER_DISH_INTERN_MAX        1024
+#define CONFIG_ORDER_DISH_ARENA_KB          32
+#define CONFIG_ORDER_JOURNAL                1
+#define CONFIG_ORDER_JOURNAL_SIZE_KB        1024
+#define CONFIG_ORDER_JOURNAL_FLUSH_MS       100
+#define CONFIG_ORDER_JOURNAL_BUFFER_SIZE    16384
+
+#endif // HOST_SDKCONFIG_H
@@ -0,0 +1,84 @@
+/**
+ * @file test_hex_utf8.c
+ * @brief 十六进制解码和UTF-8校验测试（Linux主机）
+ *
+ * 重点是原地解码失败时输入保持不变：main.c对菜品名原地解码，
+ * 不是十六进制的普通菜品名（如"Coke"）解码失败后按原文显示。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "hex_utils.h"
+#include "utf8_validator.h"
+
+// 原地解码，失败时返回错误码并检查输入未被改写
+static int decode_in_place(int (*decode)(const char *, size_t, uint8_t *, size_t),
+                           const char *text, char *buf, size_t size)
+{
+    size_t len = strlen(text);
+    memcpy(buf, text, len + 1);
+    int ret = decode(buf, len, (uint8_t *)buf, size);
+    if (ret < 0) {
+        CHECK(memcmp(buf, text, len + 1) == 0);
+    }
+    return ret;
+}
+
+static void test_hex_decode(void)
+{
+    uint8_t out[8];
+    char buf[256];
+
+    CHECK(hex_decode("DEADbeef", 8, out, sizeof(out)) == 4);
+    CHECK(out[0] == 0xDE && out[1] == 0xAD && out[2] == 0xBE && out[3] == 0xEF);
+    CHECK(hex_decode("abc", 3, out, sizeof(out)) == HEX_ERR_ODD_LENGTH);
+    CHECK(hex_decode("0011223344556677", 16, out, 7) == HEX_ERR_NO_SPACE);
+    CHECK(hex_decode("00112g", 6, out, sizeof(out)) == HEX_ERR_INVALID);
+
+    // 非法字符分别落在8字符主循环和尾部
+    CHECK(decode_in_place(hex_decode, "Coke", buf, sizeof(buf)) == HEX_ERR_INVALID);
+    CHECK(decode_in_place(hex_decode, "CAFEBABE0123456x", buf, sizeof(buf)) == HEX_ERR_INVALID);
+    CHECK(decode_in_place(hex_decode, "x0CAFEBABE", buf, sizeof(buf)) == HEX_ERR_INVALID);
+    CHECK(decode_in_place(hex_decode, "CAFE", buf, sizeof(buf)) == 2);
+    CHECK((uint8_t)buf[0] == 0xCA && (uint8_t)buf[1] == 0xFE);
+}
+
+static void test_utf8_hex_decode(void)
+{
+    char buf[256];
+
+    // "宫保鸡丁"
+    CHECK(decode_in_place(utf8_hex_decode, "E5AEABE4BF9DE9B8A1E4B881", buf, sizeof(buf)) == 12);
+    CHECK(memcmp(buf, "宫保鸡丁", 12) == 0);
+
+    // 是十六进制但不是UTF-8："BEEF"、"CAFE"
+    CHECK(decode_in_place(utf8_hex_decode, "BEEF", buf, sizeof(buf)) == UTF8_ERR_INVALID);
+    CHECK(decode_in_place(utf8_hex_decode, "CAFE", buf, sizeof(buf)) == UTF8_ERR_INVALID);
+    CHECK(decode_in_place(utf8_hex_decode, "Coke", buf, sizeof(buf)) == HEX_ERR_INVALID);
+
+    // 第一块（64字符）有效，之后的块才失败
+    char text[160];
+    memset(text, '4', 128);
+    memcpy(text + 128, "41FF", 5);
+    CHECK(decode_in_place(utf8_hex_decode, text, buf, sizeof(buf)) == UTF8_ERR_INVALID);
+    memcpy(text + 128, "41zz", 5);
+    CHECK(decode_in_place(utf8_hex_decode, text, buf, sizeof(buf)) == HEX_ERR_INVALID);
+    // 多字节字符跨块且在结尾处不完整
+    memcpy(text + 126, "E5AE", 5);
+    CHECK(decode_in_place(utf8_hex_decode, text, buf, sizeof(buf)) == UTF8_ERR_INVALID);
+    memcpy(text + 126, "E5AEAB", 7);
+    CHECK(decode_in_place(utf8_hex_decode, text, buf, sizeof(buf)) == 66);
+
+    // 不重叠时解码到独立的缓冲区
+    uint8_t out[4];
+    CHECK(utf8_hex_decode("41", 2, out, sizeof(out)) == 1 && out[0] == 'A');
+    CHECK(utf8_hex_decode("414243", 6, out, 2) == HEX_ERR_NO_SPACE);
+}
+
+int main(void)
+{
+    test_hex_decode();
+    test_utf8_hex_decode();
+    return HOST_TEST_RESULT();
+}
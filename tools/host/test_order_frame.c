@@ -0,0 +1,140 @@
+/**
+ * @file test_order_frame.c
+ * @brief 分片重组测试（Linux主机）
+ *
+ * 按POS的帧格式构造写入，检查交付的消息、错误码和UTF-8校验。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "host_test.h"
+#include "host/ble_hs.h"
+#include "order_frame.h"
+#include "order_wire.h"
+
+static char s_last[CONFIG_ORDER_FRAME_MAX_LEN + 1];
+static size_t s_last_len;
+static int s_delivered;
+
+static esp_err_t on_deliver(char *msg, size_t len, uint16_t conn_handle)
+{
+    memcpy(s_last, msg, len + 1);
+    s_last_len = len;
+    s_delivered++;
+    order_frame_buf_release(msg);
+    return ESP_OK;
+}
+
+// 发送一个分片
+static int send_fragment(order_frame_ctx_t *ctx, uint16_t seq, bool final, uint16_t total,
+                         const void *data, uint16_t len)
+{
+    uint8_t frame[ORDER_FRAME_HDR_LEN + 512];
+    frame[0] = ORDER_FRAME_MARKER | ((seq >> ORDER_FRAME_SEQ_HI_SHIFT) & ORDER_FRAME_SEQ_HI_MASK) |
+               (final ? ORDER_FRAME_FLAG_FINAL : 0);
+    frame[1] = seq & 0xFF;
+    frame[2] = total & 0xFF;
+    frame[3] = total >> 8;
+    memcpy(frame + ORDER_FRAME_HDR_LEN, data, len);
+    struct os_mbuf om = { frame, (uint16_t)(ORDER_FRAME_HDR_LEN + len) };
+    return order_frame_receive(ctx, &om);
+}
+
+// 按固定分片大小发送整条消息，返回最后一次写入的结果
+static int send_message(order_frame_ctx_t *ctx, const void *msg, uint16_t len, uint16_t chunk)
+{
+    const uint8_t *p = msg;
+    uint16_t off = 0;
+    uint16_t seq = 0;
+    int rc;
+    do {
+        uint16_t n = len - off < chunk ? len - off : chunk;
+        rc = send_fragment(ctx, seq++, off + n == len, len, p + off, n);
+        off += n;
+    } while (rc == 0 && off < len);
+    return rc;
+}
+
+static void test_reassembly(order_frame_ctx_t *ctx)
+{
+    const char *json = "{\"id\":\"A001\",\"dishes\":[\"宫保鸡丁\"]}";
+    int before = s_delivered;
+
+    // 多字节字符被分片切开
+    CHECK(send_message(ctx, json, strlen(json), 5) == 0);
+    CHECK(s_delivered == before + 1);
+    CHECK(s_last_len == strlen(json) && strcmp(s_last, json) == 0);
+
+    // 未分片的完整消息（旧版POS）
+    struct os_mbuf om = { (const uint8_t *)json, (uint16_t)strlen(json) };
+    CHECK(order_frame_receive(ctx, &om) == 0);
+    CHECK(s_delivered == before + 2);
+
+    // 序号跳跃
+    CHECK(send_fragment(ctx, 0, false, 10, "01234", 5) == 0);
+    CHECK(send_fragment(ctx, 2, true, 10, "56789", 5) == BLE_ATT_ERR_UNLIKELY);
+    CHECK(s_delivered == before + 2);
+}
+
+// 超过256个分片的消息：序号不能回绕到0而重新开始
+static void test_many_fragments(order_frame_ctx_t *ctx)
+{
+    static char msg[CONFIG_ORDER_FRAME_MAX_LEN];
+    size_t len = sizeof(msg);
+    memset(msg, 'a', len);
+    msg[0] = '{';
+    msg[len - 1] = '}';
+    int before = s_delivered;
+
+    CHECK(send_message(ctx, msg, len, 8) == 0);
+    CHECK(s_delivered == before + 1 && s_last_len == len && memcmp(s_last, msg, len) == 0);
+
+    // 第256个分片的序号高位丢失时按序号错误处理
+    CHECK(send_message(ctx, msg, 257 * 4, 4) == 0);
+    for (uint16_t seq = 0; seq < 256; seq++) {
+        CHECK(send_fragment(ctx, seq, false, 257 * 4 + 4, msg, 4) == 0);
+    }
+    CHECK(send_fragment(ctx, 0x100, false, 257 * 4 + 4, msg, 4) == 0);
+    CHECK(send_fragment(ctx, 0x101 & 0xFF, true, 257 * 4 + 4, msg, 4) == BLE_ATT_ERR_UNLIKELY);
+    CHECK(s_delivered == before + 2);
+}
+
+static void test_text_detection(order_frame_ctx_t *ctx)
+{
+    order_frame_stats_t stats;
+    order_frame_get_stats(&stats);
+    uint32_t utf8_errors = stats.utf8_errors;
+    int before = s_delivered;
+
+    // 首分片不带数据，之后的非法UTF-8仍要被拒绝
+    CHECK(send_fragment(ctx, 0, false, 4, "", 0) == 0);
+    CHECK(send_fragment(ctx, 1, true, 4, "{\xC0\xAF}", 4) == BLE_ATT_ERR_UNLIKELY);
+    order_frame_get_stats(&stats);
+    CHECK(stats.utf8_errors == utf8_errors + 1);
+    CHECK(s_delivered == before);
+
+    // 文本消息末尾的多字节字符不完整
+    CHECK(send_message(ctx, "{\xE5\xAE", 3, 2) == BLE_ATT_ERR_UNLIKELY);
+    CHECK(s_delivered == before);
+
+    // 二进制消息由首字节的魔数决定，不做UTF-8校验
+    const uint8_t bin[] = { ORDER_WIRE_MAGIC_V1, 0x01, 0xFF, 0xC0, 0xAF };
+    CHECK(send_fragment(ctx, 0, false, sizeof(bin), "", 0) == 0);
+    CHECK(send_fragment(ctx, 1, true, sizeof(bin), bin, sizeof(bin)) == 0);
+    CHECK(s_delivered == before + 1 && s_last_len == sizeof(bin));
+}
+
+int main(void)
+{
+    order_frame_ctx_t ctx;
+    CHECK(order_frame_pool_init() == ESP_OK);
+    order_frame_ctx_init(&ctx, on_deliver);
+
+    test_reassembly(&ctx);
+    test_many_fragments(&ctx);
+    test_text_detection(&ctx);
+
+    order_frame_ctx_reset(&ctx);
+    return HOST_TEST_RESULT();
+}
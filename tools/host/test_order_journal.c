@@ -0,0 +1,326 @@
+/**
+ * @file test_order_journal.c
+ * @brief 订单日志测试：文件模拟的NOR flash上的随机变更、重启和断电（Linux主机）
+ *
+ * 直接编译order_journal.c以驱动日志任务的处理函数：主机上不启动日志任务，
+ * 测试在需要时调用journal_drain/journal_commit，相当于日志任务处理完一个批量窗口。
+ * 每次重启都重新打开模拟flash文件、清空日志模块的静态状态，再从flash回放到新的模型。
+ *
+ *   test_order_journal [模拟flash文件] [随机种子]
+ */
+
+#include "order_journal.c"
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "flash_emu.h"
+
+#define TEST_PART_SIZE     (64 * 1024)    // 16个扇区，快照和环形复用都会频繁发生
+#define TEST_ORDERS        300
+#define TEST_CAPACITY      600
+#define TEST_ROUNDS        40
+#define TEST_OPS           200
+#define TEST_POWER_TRIALS  60
+#define TEST_TORN_OPS      40
+
+// 参考状态：每个订单ID在日志中应有的内容
+typedef struct {
+    bool live;
+    bool served;
+    int num;
+    uint16_t dishes;
+} ref_order_t;
+
+static const char *s_path;
+static ref_order_t s_ref[TEST_ORDERS];
+static uint32_t s_rng = 7;
+
+#define DISH(name) {name, sizeof(name) - 1}
+static const dish_t s_dishes[] = {
+    DISH("宫保鸡丁"),
+    DISH("米饭"),
+    DISH("酸菜鱼"),
+    DISH("西红柿炒鸡蛋加一份米饭和一瓶冰镇可乐"),
+};
+
+static uint32_t test_rand(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng;
+}
+
+static void order_id_of(int k, char *id)
+{
+    sprintf(id, "ORD%05d", k);
+}
+
+static void no_lock(void)
+{
+}
+
+// 日志任务处理完当前所有记录
+static void journal_step(void)
+{
+    journal_drain();
+    journal_commit();
+}
+
+// 模拟重启：重新打开flash，清空日志模块状态，从flash回放到新模型
+// budget不为负时启动过程中断电，此时启动失败也可以接受
+static order_model_t *reboot_with_budget(order_model_t *old, long budget)
+{
+    order_model_destroy(old);
+    if (s_rb) {
+        vRingbufferDelete(s_rb);
+    }
+    s_rb = NULL;
+    s_part = NULL;
+    s_failed = false;
+    s_resync = false;
+    s_base_seq = s_head_seq = s_head_base = 0;
+    s_write_off = s_flushed_off = 0;
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    flash_emu_close();
+    if (flash_emu_open(s_path, "storage", TEST_PART_SIZE) != 0) {
+        fprintf(stderr, "无法打开 %s\n", s_path);
+        exit(1);
+    }
+    flash_emu_set_budget(budget);
+
+    order_model_t *model = order_model_create(TEST_CAPACITY);
+    order_journal_config_t config = {
+        .partition_label = "storage",
+        .model = model,
+        .lock = no_lock,
+        .unlock = no_lock,
+    };
+    esp_err_t err = order_journal_init(&config);
+    if (err != ESP_OK && budget < 0) {
+        fprintf(stderr, "order_journal_init: %s\n", esp_err_to_name(err));
+        exit(1);
+    }
+    return model;
+}
+
+static order_model_t *reboot(order_model_t *old)
+{
+    return reboot_with_budget(old, -1);
+}
+
+// 模型内容与参考状态相同
+static bool model_matches(order_model_t *model, const ref_order_t *ref)
+{
+    uint16_t live = 0;
+    for (int k = 0; k < TEST_ORDERS; k++) {
+        char id[16];
+        order_id_of(k, id);
+        order_rec_t *rec = order_model_find(model, id);
+        if (!ref[k].live) {
+            if (rec) return false;
+            continue;
+        }
+        if (!rec || rec->order_num != ref[k].num || rec->dish_count != ref[k].dishes ||
+            (rec->status == ORDER_STATUS_COMPLETED) != ref[k].served) {
+            return false;
+        }
+        for (uint16_t i = 0; i < rec->dish_count; i++) {
+            if (strcmp(order_rec_dish(rec, i), s_dishes[i].name) != 0) return false;
+        }
+        live++;
+    }
+    return order_model_count(model) == live;
+}
+
+// 随机一次添加/更新/删除/出餐，同步更新参考状态
+static void random_op(order_model_t *model)
+{
+    int k = test_rand() % TEST_ORDERS;
+    char id[16];
+    order_id_of(k, id);
+
+    switch (test_rand() % 4) {
+    case 0:
+    case 1: {
+        order_t order = {
+            .order_id = id,
+            .order_num = test_rand() % 1000,
+            .dish_count = test_rand() % 5,
+            .dishes = s_dishes,
+        };
+        if (order_model_add(model, &order) == ESP_OK) {
+            if (!s_ref[k].live) {
+                s_ref[k].served = false;
+            }
+            s_ref[k].live = true;
+            s_ref[k].num = order.order_num;
+            s_ref[k].dishes = order.dish_count;
+        }
+        break;
+    }
+    case 2:
+        if (order_model_remove(model, id) == ESP_OK) {
+            s_ref[k].live = false;
+        }
+        break;
+    default: {
+        order_rec_t *rec = order_model_find(model, id);
+        if (rec && order_model_mark_served(model, rec) == ESP_OK) {
+            s_ref[k].served = true;
+        }
+        break;
+    }
+    }
+}
+
+// 日志区用量超过一半（下次启动时会先写快照）
+static void fill_journal(order_model_t *model)
+{
+    while (s_head_seq - s_base_seq + 1 <= s_sector_count / 2) {
+        random_op(model);
+        journal_drain();
+        journal_flush();
+    }
+}
+
+// 随机变更，每次处理后重启，所有已处理的变更都应恢复
+static order_model_t *test_clean_reboots(order_model_t *model)
+{
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        for (int op = 0; op < TEST_OPS; op++) {
+            random_op(model);
+            if (test_rand() % 16 == 0) {
+                journal_step();
+            }
+        }
+        journal_step();
+        model = reboot(model);
+        CHECK(model_matches(model, s_ref));
+    }
+
+    flash_emu_stats_t flash;
+    flash_emu_get_stats(&flash);
+    printf("随机变更 %d 轮: 擦除 %u 次, 写入 %llu 字节, 最后一次回放 %u 条记录/%u 个订单/%u us\n",
+           TEST_ROUNDS, flash.erases, (unsigned long long)flash.bytes_written,
+           s_stats.replayed, s_stats.recovered, s_stats.replay_us);
+    return model;
+}
+
+// 未处理的变更在重启时丢失（批量窗口内断电），已处理的仍在
+static order_model_t *test_unflushed_lost(order_model_t *model)
+{
+    ref_order_t durable[TEST_ORDERS];
+    memcpy(durable, s_ref, sizeof(durable));
+    for (int op = 0; op < TEST_OPS; op++) {
+        random_op(model);
+    }
+    model = reboot(model);
+    CHECK(model_matches(model, durable));
+    memcpy(s_ref, durable, sizeof(durable));
+    return model;
+}
+
+// 缓冲区溢出时丢弃记录并改写快照，处理后内容仍完整
+static order_model_t *test_buffer_overflow(order_model_t *model)
+{
+    for (int op = 0; op < 2000; op++) {
+        random_op(model);
+    }
+    CHECK(s_stats.dropped > 0 && s_resync);
+    journal_step();
+    CHECK(!s_resync);
+    model = reboot(model);
+    CHECK(model_matches(model, s_ref));
+    return model;
+}
+
+// 处理一批变更时断电：恢复的内容必须是这批变更的某个前缀
+static order_model_t *test_torn_writes(order_model_t *model)
+{
+    static ref_order_t prefixes[TEST_TORN_OPS + 1][TEST_ORDERS];
+    int torn = 0;
+
+    for (int trial = 0; trial < TEST_POWER_TRIALS; trial++) {
+        journal_step();
+        memcpy(prefixes[0], s_ref, sizeof(s_ref));
+        for (int op = 0; op < TEST_TORN_OPS; op++) {
+            random_op(model);
+            memcpy(prefixes[op + 1], s_ref, sizeof(s_ref));
+        }
+
+        // 大部分断电点落在这批记录的写入中，少数落在之后的快照中
+        flash_emu_set_budget(test_rand() % 1200);
+        journal_step();
+        torn += flash_emu_power_lost();
+        model = reboot(model);
+
+        int match = -1;
+        for (int n = TEST_TORN_OPS; n >= 0 && match < 0; n--) {
+            if (model_matches(model, prefixes[n])) match = n;
+        }
+        CHECK(match >= 0);
+        if (match < 0) {
+            fprintf(stderr, "断电测试 %d: 恢复的内容不是任何前缀\n", trial);
+            break;
+        }
+        memcpy(s_ref, prefixes[match], sizeof(s_ref));
+
+        // 断电后继续记录，再次重启仍然一致
+        for (int op = 0; op < 20; op++) {
+            random_op(model);
+        }
+        journal_step();
+        model = reboot(model);
+        CHECK(model_matches(model, s_ref));
+    }
+    printf("断电测试 %d 次, 其中 %d 次在写入中断电\n", TEST_POWER_TRIALS, torn);
+    CHECK(torn > 0);
+    return model;
+}
+
+// 启动回放后写快照时断电：再次启动的内容不变
+static order_model_t *test_power_loss_during_recovery(order_model_t *model)
+{
+    fill_journal(model);
+    model = reboot(model);
+    CHECK(model_matches(model, s_ref));
+
+    for (int trial = 0; trial < 10; trial++) {
+        fill_journal(model);
+        model = reboot_with_budget(model, test_rand() % 2000);
+        model = reboot(model);
+        CHECK(model_matches(model, s_ref));
+    }
+    return model;
+}
+
+int main(int argc, char **argv)
+{
+    s_path = argc > 1 ? argv[1] : "order_journal_flash.bin";
+    if (argc > 2) {
+        uint32_t seed = (uint32_t)strtoul(argv[2], NULL, 0);
+        s_rng = seed ? seed : 7;
+    }
+    // 断电时日志模块会报写入失败，这是预期的
+    esp_log_host_level = ESP_LOG_NONE;
+    remove(s_path);
+
+    order_model_t *model = reboot(NULL);
+    CHECK(order_model_count(model) == 0);
+
+    model = test_clean_reboots(model);
+    model = test_unflushed_lost(model);
+    model = test_buffer_overflow(model);
+    model = test_torn_writes(model);
+    model = test_power_loss_during_recovery(model);
+
+    flash_emu_stats_t flash;
+    flash_emu_get_stats(&flash);
+    CHECK(flash.overwrites == 0);
+
+    order_model_destroy(model);
+    flash_emu_close();
+    return HOST_TEST_RESULT();
+}
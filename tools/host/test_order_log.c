@@ -0,0 +1,121 @@
+/**
+ * @file test_order_log.c
+ * @brief 延迟日志的参数记录测试（Linux主机）
+ *
+ * 直接编译order_log.c，检查每种转换说明在记录中占用的参数字和格式化结果。
+ * CMake中另外按32位目标的类型大小（ORDER_LOG_SIZEOF_*）编译一次，
+ * 覆盖设备上int与long同为4字节时的情况；x86-64的可变参数每个占一个8字节槽位，
+ * 按4字节取出long参数结果不变，因此两种编译都能在主机上运行。
+ */
+
+#include "order_log.c"
+#include <stdio.h>
+#include "host_test.h"
+
+#define ILP32 (ORDER_LOG_SIZEOF_LONG == 4)
+
+// 按格式记录参数（不写入缓冲区）
+static void capture(log_rec_t *rec, const char *format, ...)
+{
+    memset(rec, 0, sizeof(*rec));
+    rec->format = format;
+    va_list ap;
+    va_start(ap, format);
+    log_capture(rec, ap);
+    va_end(ap);
+}
+
+static const char *format_rec(const log_rec_t *rec)
+{
+    static char line[LOG_LINE_MAX];
+    log_format(rec, line, sizeof(line));
+    return line;
+}
+
+static void test_length_modifiers(void)
+{
+    log_rec_t rec;
+    log_arg_t kind;
+    int stars;
+
+    spec_parse("d", &kind, &stars);
+    CHECK(kind == ARG_INT);
+    spec_parse("hhu", &kind, &stars);
+    CHECK(kind == ARG_INT);
+    spec_parse("lu", &kind, &stars);
+    CHECK(kind == (ILP32 ? ARG_INT : ARG_LL));
+    spec_parse("ld", &kind, &stars);
+    CHECK(kind == (ILP32 ? ARG_INT : ARG_LL));
+    spec_parse("llu", &kind, &stars);
+    CHECK(kind == ARG_LL);
+    spec_parse("lld", &kind, &stars);
+    CHECK(kind == ARG_LL);
+    spec_parse("zu", &kind, &stars);
+    CHECK(kind == (ORDER_LOG_SIZEOF_SIZE_T == 4 ? ARG_INT : ARG_LL));
+    spec_parse("jd", &kind, &stars);
+    CHECK(kind == ARG_LL);
+
+    // 一个'l'之后再出现long long，字的位置不能错开
+    capture(&rec, "%lu %llu %lu", 1ul, 0x100000002ull, 3ul);
+    if (ILP32) {
+        CHECK(rec.nwords == 4);
+        CHECK(rec.words[0] == 1 && rec.words[1] == 2 && rec.words[2] == 1 && rec.words[3] == 3);
+    } else {
+        CHECK(rec.nwords == 6);
+        CHECK(rec.words[0] == 1 && rec.words[2] == 2 && rec.words[3] == 1 && rec.words[4] == 3);
+    }
+    capture(&rec, "%ld/%lld/%d", -5l, -6ll, -7);
+    CHECK(rec.nwords == (ILP32 ? 4 : 5));
+    CHECK(rec.words[ILP32 ? 3 : 4] == (uint32_t)-7);
+
+    // 按32位目标编译时，主机的snprintf仍按8字节取long，只在本机类型大小下比较输出
+    if (!ILP32) {
+        capture(&rec, "%lu %llu %lu", 1ul, 0x100000002ull, 3ul);
+        CHECK(strcmp(format_rec(&rec), "1 4294967298 3") == 0);
+        capture(&rec, "%ld/%lld/%d", -5l, -6ll, -7);
+        CHECK(strcmp(format_rec(&rec), "-5/-6/-7") == 0);
+        capture(&rec, "%zu %u", (size_t)40, 41u);
+        CHECK(strcmp(format_rec(&rec), "40 41") == 0);
+    }
+}
+
+static void test_conversions(void)
+{
+    log_rec_t rec;
+
+    capture(&rec, "%s=%d%% [%*d] %.2f %c", "id", 42, 5, 7, 1.5, 'x');
+    CHECK(strcmp(format_rec(&rec), "id=42% [    7] 1.50 x") == 0);
+
+    capture(&rec, "%s|%s", (const char *)NULL, "");
+    CHECK(strcmp(format_rec(&rec), "(null)|") == 0);
+
+    // 字符串在记录时拷贝，之后修改原文不影响输出
+    char name[8] = "A001";
+    capture(&rec, "订单 %s", name);
+    name[0] = 'B';
+    CHECK(strcmp(format_rec(&rec), "订单 A001") == 0);
+
+    // 带精度的字符串不要求以'\0'结尾，记录时只拷贝精度给出的字节数
+    const char raw[] = "A002XYZ";
+    capture(&rec, "订单 %.*s", 4, raw);
+    CHECK(strcmp(rec.str, "A002") == 0);
+    CHECK(strcmp(format_rec(&rec), "订单 A002") == 0);
+    capture(&rec, "[%.3s]", raw);
+    CHECK(strcmp(rec.str, "A00") == 0);
+    capture(&rec, "[%.*s]", -1, raw);
+    CHECK(strcmp(format_rec(&rec), "[A002XYZ]") == 0);
+
+    // 参数字用完后剩余的转换原样输出
+    capture(&rec, "%llu %llu %llu %llu %llu %llu %llu", 1ull, 2ull, 3ull, 4ull, 5ull, 6ull, 7ull);
+    CHECK(rec.nwords == ORDER_LOG_MAX_WORDS);
+    CHECK(strcmp(format_rec(&rec), "1 2 3 4 5 6 %llu") == 0);
+}
+
+int main(void)
+{
+    printf("long %u 字节, size_t %u 字节\n",
+           (unsigned)ORDER_LOG_SIZEOF_LONG, (unsigned)ORDER_LOG_SIZEOF_SIZE_T);
+    test_length_modifiers();
+    test_conversions();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,223 @@
+/**
+ * @file test_order_model.c
+ * @brief 订单模型单元测试（Linux主机）
+ */
+
+#include <string.h>
+#include "host_test.h"
+#include "order_model.h"
+
+typedef struct {
+    uint32_t counts[ORDER_MODEL_REMOVED + 1];
+    order_model_event_t last_event;
+    char last_id[ORDER_STORE_ID_MAX + 1];
+    uint16_t last_dishes;
+} observer_log_t;
+
+static void observer(order_model_event_t event, order_rec_t *rec, void *arg)
+{
+    observer_log_t *log = arg;
+    log->counts[event]++;
+    log->last_event = event;
+    // 删除通知时记录仍然有效
+    strcpy(log->last_id, rec->order_id);
+    log->last_dishes = rec->dish_count;
+    if (event == ORDER_MODEL_ADDED) {
+        rec->view = log;
+    }
+}
+
+static order_t make_order(const char *id, const dish_t *dishes, uint16_t count)
+{
+    order_t order = {
+        .order_id = id,
+        .order_num = 1,
+        .dish_count = count,
+        .dishes = dishes,
+    };
+    return order;
+}
+
+static void test_lifecycle(void)
+{
+    observer_log_t log = {0};
+    order_model_t *model = order_model_create(8);
+    CHECK(model != NULL);
+    CHECK(order_model_subscribe(model, observer, &log) == ESP_OK);
+
+    const dish_t dishes[] = {{"宫保鸡丁", 12}, {"米饭", 6}};
+    order_t order = make_order("A001", dishes, 2);
+    CHECK(order_model_add(model, &order) == ESP_OK);
+    CHECK(log.counts[ORDER_MODEL_ADDED] == 1 && strcmp(log.last_id, "A001") == 0);
+
+    order_rec_t *rec = order_model_find(model, "A001");
+    CHECK(rec != NULL && rec->view == &log && rec->dish_count == 2);
+    CHECK(strcmp(order_rec_dish(rec, 0), "宫保鸡丁") == 0);
+    CHECK(strcmp(order_rec_dish(rec, 1), "米饭") == 0);
+
+    // 重复添加按更新处理
+    order.dish_count = 1;
+    CHECK(order_model_add(model, &order) == ESP_OK);
+    CHECK(log.counts[ORDER_MODEL_ADDED] == 1 && log.counts[ORDER_MODEL_UPDATED] == 1);
+    CHECK(rec->dish_count == 1 && order_model_count(model) == 1);
+
+    order_t missing = make_order("B001", dishes, 1);
+    CHECK(order_model_update(model, &missing) == ESP_ERR_NOT_FOUND);
+    CHECK(order_model_remove(model, "B001") == ESP_ERR_NOT_FOUND);
+
+    CHECK(order_model_mark_served(model, rec) == ESP_OK);
+    CHECK(rec->status == ORDER_STATUS_COMPLETED && log.counts[ORDER_MODEL_SERVED] == 1);
+    CHECK(order_model_mark_served(model, rec) == ESP_ERR_INVALID_STATE);
+    CHECK(log.counts[ORDER_MODEL_SERVED] == 1);
+
+    CHECK(order_model_remove(model, "A001") == ESP_OK);
+    CHECK(log.last_event == ORDER_MODEL_REMOVED && strcmp(log.last_id, "A001") == 0 && log.last_dishes == 1);
+    CHECK(order_model_find(model, "A001") == NULL && order_model_count(model) == 0);
+
+    order_model_stats_t stats;
+    order_model_get_stats(model, &stats, NULL);
+    CHECK(stats.added == 1 && stats.updated == 1 && stats.served == 1 && stats.removed == 1);
+    CHECK(stats.not_found == 2 && stats.failed == 0);
+
+    order_model_destroy(model);
+}
+
+static void test_limits(void)
+{
+    observer_log_t log = {0};
+    order_model_t *model = order_model_create(4);
+    order_model_subscribe(model, observer, &log);
+
+    const dish_t dish = {"可乐", 6};
+    char id[8];
+    for (int i = 0; i < 5; i++) {
+        snprintf(id, sizeof(id), "C%d", i);
+        order_t order = make_order(id, &dish, 1);
+        CHECK(order_model_add(model, &order) == (i < 4 ? ESP_OK : ESP_ERR_NO_MEM));
+    }
+    CHECK(order_model_count(model) == 4 && log.counts[ORDER_MODEL_ADDED] == 4);
+
+    order_model_stats_t stats;
+    order_model_get_stats(model, &stats, NULL);
+    CHECK(stats.failed == 1);
+
+    // 遍历到全部订单
+    int seen = 0;
+    for (order_rec_t *rec = order_model_next(model, NULL); rec; rec = order_model_next(model, rec)) {
+        seen++;
+    }
+    CHECK(seen == 4);
+
+    // 删除后腾出的记录可以复用
+    CHECK(order_model_remove(model, "C0") == ESP_OK);
+    order_t order = make_order("C4", &dish, 1);
+    CHECK(order_model_add(model, &order) == ESP_OK);
+
+    // 订单ID为空或超长
+    char long_id[ORDER_STORE_ID_MAX + 2];
+    memset(long_id, 'x', sizeof(long_id) - 1);
+    long_id[sizeof(long_id) - 1] = '\0';
+    order = make_order(long_id, &dish, 1);
+    CHECK(order_model_add(model, &order) == ESP_ERR_INVALID_ARG);
+    order = make_order("", &dish, 1);
+    CHECK(order_model_add(model, &order) == ESP_ERR_INVALID_ARG);
+
+    // 取消订阅后不再通知
+    order_model_unsubscribe(model, observer, &log);
+    CHECK(order_model_remove(model, "C1") == ESP_OK);
+    CHECK(log.counts[ORDER_MODEL_REMOVED] == 1);
+
+    order_model_destroy(model);
+}
+
+static void test_dishes(void)
+{
+    order_model_t *model = order_model_create(4);
+
+    // 同名菜品在不同订单中共用一份驻留文本
+    const dish_t a[] = {{"麻婆豆腐", 12}, {"米饭", 6}};
+    const dish_t b[] = {{"米饭", 6}};
+    order_t order_a = make_order("D1", a, 2);
+    order_t order_b = make_order("D2", b, 1);
+    CHECK(order_model_add(model, &order_a) == ESP_OK);
+    CHECK(order_model_add(model, &order_b) == ESP_OK);
+    order_rec_t *rec_a = order_model_find(model, "D1");
+    order_rec_t *rec_b = order_model_find(model, "D2");
+    CHECK(rec_a->dishes[1] == rec_b->dishes[0]);
+
+    // 菜品名不要求以'\0'结尾
+    const dish_t sliced[] = {{"酸菜鱼XYZ", 9}};
+    order_t order_c = make_order("D3", sliced, 1);
+    CHECK(order_model_add(model, &order_c) == ESP_OK);
+    CHECK(strcmp(order_rec_dish(order_model_find(model, "D3"), 0), "酸菜鱼") == 0);
+
+    // 超出上限的菜品被截断并计数
+    dish_t many[ORDER_STORE_MAX_DISHES + 4];
+    for (int i = 0; i < ORDER_STORE_MAX_DISHES + 4; i++) {
+        many[i].name = "小笼包";
+        many[i].name_len = 9;
+    }
+    order_t order_d = make_order("D4", many, ORDER_STORE_MAX_DISHES + 4);
+    CHECK(order_model_add(model, &order_d) == ESP_OK);
+    CHECK(order_model_find(model, "D4")->dish_count == ORDER_STORE_MAX_DISHES);
+
+    order_store_stats_t store;
+    order_model_get_stats(model, NULL, &store);
+    CHECK(store.count == 4 && store.dish_truncated == 1 && store.peak == 4);
+
+    order_model_destroy(model);
+
+    // 订单释放后菜品名的引用全部归还
+    dish_intern_stats_t intern;
+    dish_intern_get_stats(&intern);
+    CHECK(intern.live == 0);
+}
+
+// 删除后空出的记录被复用时，遍历仍按到达顺序
+static void test_arrival_order(void)
+{
+    order_model_t *model = order_model_create(4);
+    const dish_t dishes[] = {{"米饭", 6}};
+    static const char *ids[] = {"A1", "A2", "A3", "A4", "A5"};
+    for (int i = 0; i < 3; i++) {
+        order_t order = make_order(ids[i], dishes, 1);
+        CHECK(order_model_add(model, &order) == ESP_OK);
+    }
+    CHECK(order_model_remove(model, "A1") == ESP_OK);
+    for (int i = 3; i < 5; i++) {
+        order_t order = make_order(ids[i], dishes, 1);
+        CHECK(order_model_add(model, &order) == ESP_OK);
+    }
+    order_t update = make_order("A2", dishes, 1);
+    CHECK(order_model_update(model, &update) == ESP_OK);
+
+    const char *expect[] = {"A2", "A3", "A4", "A5"};
+    int n = 0;
+    for (order_rec_t *rec = order_model_next(model, NULL); rec; rec = order_model_next(model, rec), n++) {
+        CHECK(n < 4 && strcmp(rec->order_id, expect[n]) == 0);
+    }
+    CHECK(n == 4);
+
+    // 遍历中删除当前记录
+    n = 0;
+    for (order_rec_t *rec = order_model_next(model, NULL); rec; rec = order_model_next(model, rec), n++) {
+        if (n % 2 == 0) {
+            CHECK(order_model_remove(model, rec->order_id) == ESP_OK);
+        }
+    }
+    CHECK(n == 4 && order_model_count(model) == 2);
+    order_rec_t *first = order_model_next(model, NULL);
+    CHECK(first && strcmp(first->order_id, "A3") == 0);
+    CHECK(strcmp(order_model_next(model, first)->order_id, "A5") == 0);
+
+    order_model_destroy(model);
+}
+
+int main(void)
+{
+    test_lifecycle();
+    test_limits();
+    test_dishes();
+    test_arrival_order();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+/**
+ * @file test_order_wire.c
+ * @brief 订单报文解码测试（Linux主机）
+ *
+ * JSON报文的token数量、字符串反转义和菜品数超限，以及二进制报文的基本格式。
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "order_wire.h"
+
+// 解码一份可写的拷贝
+static bool decode_json(const char *text, char *buf, size_t size, order_msg_t *msg)
+{
+    size_t len = strlen(text);
+    if (len >= size) return false;
+    memcpy(buf, text, len + 1);
+    return order_wire_decode_json(buf, len, msg);
+}
+
+static bool str_is(order_str_t str, const char *expect)
+{
+    return str.ptr && str.len == strlen(expect) && memcmp(str.ptr, expect, str.len) == 0 &&
+           str.ptr[str.len] == '\0';
+}
+
+// 菜品带多个字段的大订单，token数超过原来栈上的256个
+static void test_large_order(void)
+{
+    static char json[CONFIG_ORDER_FRAME_MAX_LEN];
+    static char buf[CONFIG_ORDER_FRAME_MAX_LEN];
+    int len = snprintf(json, sizeof(json), "{\"type\":\"add\",\"orderId\":\"L001\",\"items\":[");
+    for (int i = 0; i < ORDER_MSG_MAX_ITEMS; i++) {
+        len += snprintf(json + len, sizeof(json) - len,
+                        "%s{\"name\":\"E7B1B3E9A5AD\",\"qty\":%d,\"price\":12.5,\"note\":\"\",\"tags\":[1,2]}",
+                        i ? "," : "", i + 1);
+    }
+    len += snprintf(json + len, sizeof(json) - len, "]}");
+    CHECK(len < (int)sizeof(json));
+
+    order_msg_t msg;
+    CHECK(decode_json(json, buf, sizeof(buf), &msg));
+    CHECK(msg.type == ORDER_MSG_ADD && str_is(msg.order_id, "L001"));
+    CHECK(msg.item_count == ORDER_MSG_MAX_ITEMS && str_is(msg.items[31], "E7B1B3E9A5AD"));
+    CHECK(msg.item_total == ORDER_MSG_MAX_ITEMS);
+
+    // 超过上限的菜品不保存，但item_total记录实际数量，由调用者拒绝整条消息
+    len -= 2;
+    len += snprintf(json + len, sizeof(json) - len, ",{\"name\":\"E7B1B3\"}]}");
+    CHECK(len < (int)sizeof(json));
+    CHECK(decode_json(json, buf, sizeof(buf), &msg));
+    CHECK(msg.item_count == ORDER_MSG_MAX_ITEMS && msg.item_total == ORDER_MSG_MAX_ITEMS + 1);
+
+    // 最坏情况：整条消息都是单字符的值
+    len = snprintf(json, sizeof(json), "{\"type\":\"info\",\"content\":\"x\",\"n\":[0");
+    while (len < (int)sizeof(json) - 4) {
+        len += snprintf(json + len, sizeof(json) - len, ",0");
+    }
+    len += snprintf(json + len, sizeof(json) - len, "]}");
+    CHECK(len < (int)sizeof(json));
+    CHECK(decode_json(json, buf, sizeof(buf), &msg));
+    CHECK(str_is(msg.content, "x"));
+}
+
+static void test_unescape(void)
+{
+    char buf[512];
+    order_msg_t msg;
+
+    CHECK(decode_json("{\"type\":\"remove\",\"orderId\":\"A\\\"1\\\\2\\/3\"}", buf, sizeof(buf), &msg));
+    CHECK(str_is(msg.order_id, "A\"1\\2/3"));
+
+    // 系统消息内容以\uXXXX转义的中文
+    CHECK(decode_json("{\"type\":\"info\",\"content\":\"\\u8BF7\\u53d6\\u9910\"}", buf, sizeof(buf), &msg));
+    CHECK(str_is(msg.content, "请取餐"));
+
+    // 代理对和不成对的代理项
+    CHECK(decode_json("{\"type\":\"add\",\"orderId\":\"B1\",\"items\":["
+                      "{\"name\":\"\\uD83C\\uDF5C\"},{\"name\":\"a\\uD800b\"},{\"name\":\"\\t\\n\"}]}",
+                      buf, sizeof(buf), &msg));
+    CHECK(msg.item_count == 3);
+    CHECK(str_is(msg.items[0], "\xF0\x9F\x8D\x9C"));
+    CHECK(str_is(msg.items[1], "a\xEF\xBF\xBD" "b"));
+    CHECK(str_is(msg.items[2], "\t\n"));
+
+    // 没有转义的字段保持原样，失败时不修改输入
+    const char *bad = "{\"type\":\"bogus\",\"orderId\":\"C\\\"1\"}";
+    CHECK(!decode_json(bad, buf, sizeof(buf), &msg));
+    CHECK(strcmp(buf, bad) == 0);
+}
+
+static void test_binary(void)
+{
+    const uint8_t bin[] = {
+        ORDER_WIRE_MAGIC_V1, ORDER_MSG_ADD,
+        ORDER_WIRE_TAG_ORDER_ID, 2, 'A', '1',
+        ORDER_WIRE_TAG_ITEM, 6, 0xE7, 0xB1, 0xB3, 0xE9, 0xA5, 0xAD,
+        0x7F, 1, 0,
+    };
+    order_msg_t msg;
+    CHECK(order_wire_is_binary(bin, sizeof(bin)));
+    CHECK(order_wire_decode(bin, sizeof(bin), &msg));
+    CHECK(msg.order_id.len == 2 && msg.item_count == 1 && msg.items[0].len == 6 && !msg.hex_encoded);
+    CHECK(!order_wire_decode(bin, sizeof(bin) - 1, &msg));
+
+    uint8_t many[2 + 4 + (ORDER_MSG_MAX_ITEMS + 1) * 3];
+    size_t pos = 0;
+    many[pos++] = ORDER_WIRE_MAGIC_V1;
+    many[pos++] = ORDER_MSG_UPDATE;
+    many[pos++] = ORDER_WIRE_TAG_ORDER_ID;
+    many[pos++] = 2;
+    many[pos++] = 'A';
+    many[pos++] = '2';
+    for (int i = 0; i <= ORDER_MSG_MAX_ITEMS; i++) {
+        many[pos++] = ORDER_WIRE_TAG_ITEM;
+        many[pos++] = 1;
+        many[pos++] = 'a' + i % 26;
+    }
+    CHECK(order_wire_decode(many, pos, &msg));
+    CHECK(msg.item_count == ORDER_MSG_MAX_ITEMS && msg.item_total == ORDER_MSG_MAX_ITEMS + 1);
+}
+
+int main(void)
+{
+    test_large_order();
+    test_unescape();
+    test_binary();
+    return HOST_TEST_RESULT();
+}
@@ -0,0 +1,31 @@
+/**
+ * @file lv_conf.h
+ * @brief 主机渲染基准的LVGL配置
+ *
+ * 与设备上的sdkconfig保持一致的部分：RGB565、内置分配器（1MB）、16ms刷新周期、压缩字体。
+ * 主机上不使用操作系统，只有一个软件绘制单元（设备上为4个），其余使用LVGL默认值。
+ */
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#define LV_COLOR_DEPTH              16
+
+#define LV_USE_STDLIB_MALLOC        LV_STDLIB_BUILTIN
+#define LV_USE_STDLIB_STRING        LV_STDLIB_CLIB
+#define LV_USE_STDLIB_SPRINTF       LV_STDLIB_CLIB
+#define LV_MEM_SIZE                 (1024 * 1024)
+
+#define LV_DEF_REFR_PERIOD          16
+#define LV_USE_OS                   LV_OS_NONE
+#define LV_DRAW_SW_DRAW_UNIT_CNT    1
+
+#define LV_USE_LOG                  0
+#define LV_USE_PERF_MONITOR         0
+#define LV_USE_MEM_MONITOR          0
+
+#define LV_USE_FONT_COMPRESSED      1
+#define LV_FONT_FMT_TXT_LARGE       1
+#define LV_FONT_MONTSERRAT_14       1
+
+#endif // LV_CONF_H
@@ -0,0 +1,15 @@
+/**
+ * @file display.h
+ * @brief 主机构建用的显示锁：基准测试单线程运行，加锁总是成功
+ */
+
+#ifndef UI_BENCH_BSP_DISPLAY_H
+#define UI_BENCH_BSP_DISPLAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool bsp_display_lock(uint32_t timeout_ms);
+void bsp_display_unlock(void);
+
+#endif // UI_BENCH_BSP_DISPLAY_H
@@ -0,0 +1,12 @@
+/**
+ * @file esp-bsp.h
+ * @brief 主机构建用的BSP头文件
+ */
+
+#ifndef UI_BENCH_ESP_BSP_H
+#define UI_BENCH_ESP_BSP_H
+
+#include "freertos/FreeRTOS.h"
+#include "bsp/display.h"
+
+#endif // UI_BENCH_ESP_BSP_H
@@ -0,0 +1,38 @@
+/**
+ * @file host_stubs.c
+ * @brief 订单界面在主机上运行所需的ESP-IDF/BSP函数
+ */
+
+#include <time.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "bsp/display.h"
+#include "glyph_cache.h"
+
+esp_log_level_t esp_log_host_level = ESP_LOG_WARN;
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+bool bsp_display_lock(uint32_t timeout_ms)
+{
+    (void)timeout_ms;
+    return true;
+}
+
+void bsp_display_unlock(void)
+{
+}
+
+// 主机上没有字形缓存（与关闭CONFIG_ORDER_GLYPH_CACHE时相同），预热直接跳过
+esp_err_t glyph_cache_warm(const char *text, size_t len)
+{
+    (void)text;
+    (void)len;
+    return ESP_ERR_INVALID_STATE;
+}
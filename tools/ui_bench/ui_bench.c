@@ -0,0 +1,423 @@
+/**
+ * @file ui_bench.c
+ * @brief 订单界面的主机渲染基准
+ *
+ * 把 main/order_ui.c 与订单模型、LVGL一起在Linux上编译，渲染到内存中的1024x600 RGB565帧缓冲，
+ * 按脚本回放订单负载（添加、更新、滚动、出餐、连续弹窗、删除），每个场景输出：
+ *   - 每帧渲染耗时（lv_refr_now，含布局和绘制）及最大值；
+ *   - 每帧刷新到帧缓冲的面积（即失效区域合并后实际重绘的像素）；
+ *   - 场景期间LVGL堆的最高占用；
+ *   - 场景期间创建的LVGL对象数。
+ * 时钟为虚拟时钟，每帧前进16ms，结果与机器负载无关的部分（面积、对象数、堆）可直接比较。
+ *
+ *     order_ui_bench [-n 订单数] [-f 菜品字体.bin] [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "lvgl.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "order_model.h"
+#include "order_ui.h"
+#include "mmap_font.h"
+#include "text_measure.h"
+
+#define BENCH_HOR_RES   1024
+#define BENCH_VER_RES   600
+#define BENCH_FRAME_MS  16
+#define BENCH_ORDERS    200
+#define BENCH_POPUPS    200
+
+#ifndef UI_BENCH_DISH_FONT
+#define UI_BENCH_DISH_FONT ""
+#endif
+
+lv_font_t *dish_font = NULL;  // 菜品字体（order_ui.c引用，设备上由main.c加载）
+
+// 菜品名只用现有菜品字体中的字符，含需要换行的长菜品名
+static const char *const s_dish_names[] = {
+    "陈醋", "黄酒", "奶茶", "花茶", "杏脯", "凉糕", "白米糕", "沙棘茶",
+    "苦荞茶", "鲜奶+黄米糕", "北魏鲜奶", "沙棘鲜奶+苦荞茶+白米糕",
+};
+#define DISH_NAME_COUNT (sizeof(s_dish_names) / sizeof(s_dish_names[0]))
+
+typedef struct {
+    const char *name;
+    uint32_t steps;          // 执行的操作数（每个操作后渲染一帧）
+    uint32_t frames;
+    uint64_t step_us;        // 操作本身（模型+界面更新）的总耗时
+    uint64_t render_us;      // 渲染总耗时
+    uint32_t render_us_max;
+    uint64_t area_px;        // 刷新到帧缓冲的总面积
+    uint32_t area_px_max;
+    uint32_t heap_peak;      // LVGL堆最高占用
+    uint32_t objs_created;
+} bench_result_t;
+
+static lv_display_t *s_disp = NULL;
+static uint8_t s_fb[BENCH_HOR_RES * BENCH_VER_RES * 2] __attribute__((aligned(64)));
+static uint32_t s_now_ms = 0;
+static uint32_t s_frame_px = 0;
+static uint32_t s_objs_created = 0;
+static uint32_t s_heap_max_used = 0;
+static bench_result_t *s_cur = NULL;
+
+// 链接时用 --wrap 截获LVGL内部的对象创建，统计所有控件的创建次数
+lv_obj_t *__real_lv_obj_class_create_obj(const lv_obj_class_t *class_p, lv_obj_t *parent);
+
+lv_obj_t *__wrap_lv_obj_class_create_obj(const lv_obj_class_t *class_p, lv_obj_t *parent)
+{
+    s_objs_created++;
+    return __real_lv_obj_class_create_obj(class_p, parent);
+}
+
+static uint32_t bench_tick(void)
+{
+    return s_now_ms;
+}
+
+// 直接渲染模式下绘制缓冲即帧缓冲，每个重绘区域调用一次
+static void bench_flush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    (void)px_map;
+    s_frame_px += lv_area_get_size(area);
+    lv_display_flush_ready(disp);
+}
+
+static void heap_sample(void)
+{
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    uint32_t used = mon.total_size - mon.free_size;
+    if (used > s_cur->heap_peak) {
+        s_cur->heap_peak = used;
+    }
+    // max_used在帧内的瞬时峰值（如绘制层）处更新，场景期间上升时计入
+    if (mon.max_used > s_heap_max_used) {
+        s_heap_max_used = mon.max_used;
+        if (mon.max_used > s_cur->heap_peak) {
+            s_cur->heap_peak = mon.max_used;
+        }
+    }
+}
+
+static void bench_begin(bench_result_t *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+    r->name = name;
+    s_cur = r;
+    s_objs_created = 0;
+    heap_sample();
+}
+
+static void bench_end(bench_result_t *r)
+{
+    r->objs_created = s_objs_created;
+    s_cur = NULL;
+}
+
+// 前进一帧：先运行LVGL定时器（弹窗计时等），再渲染并统计
+static void bench_frame(void)
+{
+    s_now_ms += BENCH_FRAME_MS;
+    lv_timer_handler();
+
+    s_frame_px = 0;
+    int64_t start = esp_timer_get_time();
+    lv_refr_now(s_disp);
+    uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+
+    bench_result_t *r = s_cur;
+    r->frames++;
+    r->render_us += us;
+    if (us > r->render_us_max) r->render_us_max = us;
+    r->area_px += s_frame_px;
+    if (s_frame_px > r->area_px_max) r->area_px_max = s_frame_px;
+    heap_sample();
+}
+
+static int64_t s_step_start;
+
+static void step_begin(void)
+{
+    s_step_start = esp_timer_get_time();
+}
+
+// 结束一个操作并渲染一帧
+static void step_end(void)
+{
+    s_cur->step_us += (uint64_t)(esp_timer_get_time() - s_step_start);
+    s_cur->steps++;
+    heap_sample();
+    bench_frame();
+}
+
+// 第n个订单：菜品数1~6，variant不同时菜品名不同（用于更新）
+static void make_order(order_t *order, dish_t *dishes, char *id, size_t id_size, int n, int variant)
+{
+    snprintf(id, id_size, "bench-%04d", n);
+    uint16_t count = (uint16_t)(1 + (n * 7 + variant) % 6);
+    for (uint16_t i = 0; i < count; i++) {
+        const char *name = s_dish_names[(n * 5 + i * 3 + variant) % DISH_NAME_COUNT];
+        dishes[i].name = name;
+        dishes[i].name_len = (uint16_t)strlen(name);
+    }
+    order->order_id = id;
+    order->order_num = n + 1;
+    order->dish_count = count;
+    order->dishes = dishes;
+}
+
+static void scenario_add(order_model_t *model, int orders, bench_result_t *r)
+{
+    static char title[32];
+    snprintf(title, sizeof(title), "add %d orders", orders);
+    bench_begin(r, title);
+    for (int n = 0; n < orders; n++) {
+        order_t order;
+        dish_t dishes[ORDER_STORE_MAX_DISHES];
+        char id[32];
+        make_order(&order, dishes, id, sizeof(id), n, 0);
+        step_begin();
+        order_model_add(model, &order);
+        step_end();
+    }
+    bench_end(r);
+}
+
+static void scenario_update(order_model_t *model, int orders, bench_result_t *r)
+{
+    bench_begin(r, "update every order");
+    for (int n = orders - 1; n >= 0; n--) {
+        order_t order;
+        dish_t dishes[ORDER_STORE_MAX_DISHES];
+        char id[32];
+        make_order(&order, dishes, id, sizeof(id), n, 1);
+        step_begin();
+        order_model_update(model, &order);
+        step_end();
+    }
+    bench_end(r);
+}
+
+// 订单容器是界面创建的第一个子对象
+static lv_obj_t *orders_list(void)
+{
+    return lv_obj_get_child(lv_screen_active(), 0);
+}
+
+static void scenario_scroll(bench_result_t *r)
+{
+    bench_begin(r, "scroll to bottom and back");
+    lv_obj_t *list = orders_list();
+    for (int pass = 0; pass < 2; pass++) {
+        int32_t dy = pass == 0 ? -BENCH_VER_RES / 4 : BENCH_VER_RES / 4;
+        for (;;) {
+            int32_t before = lv_obj_get_scroll_y(list);
+            step_begin();
+            lv_obj_scroll_by_bounded(list, 0, dy, LV_ANIM_OFF);
+            step_end();
+            if (lv_obj_get_scroll_y(list) == before) break;
+        }
+    }
+    bench_end(r);
+}
+
+static void scenario_serve(order_model_t *model, int orders, bench_result_t *r)
+{
+    bench_begin(r, "serve every order");
+    for (int n = orders - 1; n >= 0; n--) {
+        char id[32];
+        snprintf(id, sizeof(id), "bench-%04d", n);
+        order_rec_t *rec = order_model_find(model, id);
+        if (!rec) continue;
+        step_begin();
+        order_model_mark_served(model, rec);
+        step_end();
+    }
+    bench_end(r);
+}
+
+// 每帧一条弹窗消息：订单变更汇总为主，夹杂文字消息；之后等待弹窗全部显示完
+static void scenario_popups(bench_result_t *r)
+{
+    bench_begin(r, "rapid popups");
+    for (int i = 0; i < BENCH_POPUPS; i++) {
+        step_begin();
+        if (i % 8 == 7) {
+            char text[48];
+            snprintf(text, sizeof(text), "打印机 %d 缺纸", i % 3 + 1);
+            show_popup_message(text, 1500);
+        } else {
+            show_order_popup((order_popup_t)(i % 3));
+        }
+        step_end();
+    }
+    for (int i = 0; i < 10000 / BENCH_FRAME_MS; i++) {
+        bench_frame();
+    }
+    bench_end(r);
+}
+
+static void scenario_remove(order_model_t *model, int orders, bench_result_t *r)
+{
+    bench_begin(r, "remove every order");
+    for (int n = 0; n < orders; n++) {
+        char id[32];
+        snprintf(id, sizeof(id), "bench-%04d", n);
+        step_begin();
+        order_model_remove(model, id);
+        step_end();
+    }
+    bench_end(r);
+}
+
+static void print_results(const bench_result_t *results, int count)
+{
+    const uint32_t screen_px = BENCH_HOR_RES * BENCH_VER_RES;
+    printf("\n%-26s %6s %6s %10s %10s %10s %12s %12s %8s %10s %8s\n",
+           "scenario", "steps", "frames", "step us", "render us", "max us",
+           "px/frame", "max px", "screen%", "heap peak", "objects");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        uint64_t frames = r->frames ? r->frames : 1;
+        uint64_t steps = r->steps ? r->steps : 1;
+        uint64_t px = r->area_px / frames;
+        printf("%-26s %6u %6u %10llu %10llu %10u %12llu %12u %7.1f%% %10u %8u\n",
+               r->name, r->steps, r->frames,
+               (unsigned long long)(r->step_us / steps),
+               (unsigned long long)(r->render_us / frames), r->render_us_max,
+               (unsigned long long)px, r->area_px_max, 100.0 * px / screen_px,
+               r->heap_peak, r->objs_created);
+    }
+}
+
+static void print_ui_stats(void)
+{
+    order_ui_stats_t ui;
+    order_ui_get_stats(&ui);
+    text_measure_stats_t measure;
+    text_measure_get_stats(&measure);
+    printf("\norder list: rows %u (create %u us/row, pool heap %u B), binds %u, "
+           "row layouts %u (%u us/row)\n",
+           ui.rows, ui.row_create_us, ui.pool_heap, ui.binds,
+           ui.row_layouts, ui.row_layouts ? ui.row_layout_us / ui.row_layouts : 0);
+    printf("dish cards: created %u, reused %u, deleted %u; measure cache: hits %u, misses %u (%u us/miss)\n",
+           ui.cards_created, ui.cards_reused, ui.cards_deleted,
+           measure.hits, measure.misses, measure.misses ? measure.measure_us / measure.misses : 0);
+    printf("popups: shown %u, coalesced %u, dropped %u\n",
+           ui.popups_shown, ui.popups_coalesced, ui.popups_dropped);
+}
+
+// 读入binfont并在内存中解析（设备上为映射的分区数据），失败时使用内置的设备字体
+static uint8_t *load_dish_font(const char *path)
+{
+    if (!path || !*path) return NULL;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "dish font %s not found, using lv_font_device\n", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = size > 0 ? malloc(size) : NULL;
+    if (!data || fread(data, 1, size, f) != (size_t)size) {
+        fclose(f);
+        free(data);
+        return NULL;
+    }
+    fclose(f);
+
+    dish_font = mmap_font_create(data, size);
+    if (!dish_font) {
+        fprintf(stderr, "dish font %s is not a supported binfont, using lv_font_device\n", path);
+        free(data);
+        return NULL;
+    }
+    printf("dish font: %s (%ld bytes, %zu bytes resident)\n", path, size, mmap_font_resident_size(dish_font));
+    return data;
+}
+
+int main(int argc, char **argv)
+{
+    int orders = BENCH_ORDERS;
+    const char *font_path = UI_BENCH_DISH_FONT;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:f:v")) != -1) {
+        switch (opt) {
+        case 'n':
+            orders = atoi(optarg);
+            break;
+        case 'f':
+            font_path = optarg;
+            break;
+        case 'v':
+            esp_log_host_level = ESP_LOG_INFO;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-n orders] [-f dish_font.bin] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (orders < 1 || orders > 65534) {
+        fprintf(stderr, "order count must be 1..65534\n");
+        return 2;
+    }
+
+    lv_init();
+    lv_tick_set_cb(bench_tick);
+    s_disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    lv_display_set_color_format(s_disp, LV_COLOR_FORMAT_RGB565);
+    lv_display_set_buffers(s_disp, s_fb, NULL, sizeof(s_fb), LV_DISPLAY_RENDER_MODE_DIRECT);
+    lv_display_set_flush_cb(s_disp, bench_flush);
+    // 由基准逐帧调用lv_refr_now，不使用显示的刷新定时器
+    lv_display_delete_refr_timer(s_disp);
+
+    // 初始化期间的堆峰值不计入任何场景
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    s_heap_max_used = mon.max_used;
+
+    uint8_t *font_data = load_dish_font(font_path);
+
+    order_model_t *model = order_model_create((uint16_t)orders);
+    if (!model) {
+        fprintf(stderr, "order_model_create failed\n");
+        return 1;
+    }
+
+    bench_result_t results[7];
+    int count = 0;
+
+    bench_result_t *r = &results[count++];
+    bench_begin(r, "create order view");
+    step_begin();
+    order_ui_init(lv_screen_active(), model);
+    step_end();
+    bench_end(r);
+
+    scenario_add(model, orders, &results[count++]);
+    scenario_update(model, orders, &results[count++]);
+    scenario_scroll(&results[count++]);
+    scenario_serve(model, orders, &results[count++]);
+    scenario_popups(&results[count++]);
+    scenario_remove(model, orders, &results[count++]);
+
+    printf("order_ui_bench: %dx%d RGB565, %d orders, %d ms/frame\n",
+           BENCH_HOR_RES, BENCH_VER_RES, orders, BENCH_FRAME_MS);
+    print_results(results, count);
+    print_ui_stats();
+
+    order_ui_cleanup();
+    order_model_destroy(model);
+    if (dish_font) {
+        mmap_font_destroy(dish_font);
+    }
+    lv_deinit();
+    free(font_data);
+    return 0;
+}